@@ -2393,6 +2393,34 @@ function tryGetWeightedParameterReductionList( node, redutype, operand, tagmask_
 		return {},0.0
 	end
 end
+-- Derive the types of the parameters of a callable item from the types of the arguments passed with one call of typedb:derive_types
+-- The result of an argument is false if it cannot be passed and nil if its type is equal to the type of the parameter
+function deriveParameterTypes( args, parameters)
+	local rt,typepairs,indices = {},{},{}
+	for pi=1,math.min( #args, #parameters) do
+		if parameters[ pi].type ~= args[ pi].type then
+			table.insert( typepairs, {parameters[ pi].type, args[ pi].type})
+			table.insert( indices, pi)
+		end
+	end
+	if #typepairs > 0 then
+		local results = typedb:derive_types( typepairs, tagmask_matchParameter, tagmask_typeConversion)
+		for ri,pi in ipairs( indices) do rt[ pi] = results[ ri] end
+	end
+	return rt
+end
+-- Get the constructor and weight of a parameter passed from a result of deriveParameterTypes
+function getWeightedParameterReductionList( node, operand, derivation)
+	if derivation == nil then
+		return {},0.0
+	elseif derivation then
+		if derivation.conflict then
+			utils.errorMessage( node.line, "Ambiguous derivation paths for '%s': %s | %s",
+						typedb:type_string(operand.type), utils.typeListString(typedb,derivation.conflict," =>"), utils.typeListString(typedb,derivation," =>"))
+		end
+		return derivation,derivation.weight
+	end
+end
 -- Get the constructor of a type required. The deduction tagmasks are passed as an arguments
 function getRequiredTypeConstructor( node, redutype, operand, tagmask_decl, tagmask_conv)
 	if redutype ~= operand.type then
@@ -2413,11 +2441,12 @@ end
 -- For a callable item, create for each argument the lists of reductions needed to pass the arguments to it, with accumulation of the reduction weights
 function collectItemParameter( node, item, args, parameters)
 	local rt = {redulist={},llvmtypes={},weight=0.0}
+	local derivations = deriveParameterTypes( args, parameters)
 	for pi=1,#args do
 		local redutype,redulist,weight
 		if pi <= #parameters then
 			redutype = parameters[ pi].type
-			redulist,weight = tryGetWeightedParameterReductionList( node, redutype, args[ pi], tagmask_matchParameter, tagmask_typeConversion)
+			redulist,weight = getWeightedParameterReductionList( node, args[ pi], derivations[ pi])
 		else
 			redutype = getVarargArgumentType( args[ pi].type)
 			if redutype then redulist,weight = tryGetWeightedParameterReductionList( node, redutype, args[ pi], tagmask_pushVararg, tagmask_typeConversion) end
@@ -2457,8 +2486,31 @@ function selectCandidateItemsBestWeight( items, item_parameter_map, maxweight)
 	end
 	return candidates,bestweight
 end
+-- Create the call of a candidate item from the lists of reductions of the arguments, returns nil if the construction of an argument fails
+function constructCallItem( node, item, args, redulists, llvmtypes, this_constructor)
+	local item_constructor = typedb:type_constructor( item)
+	if not item_constructor and #args == 0 then
+		return this_constructor
+	else
+		local arg_constructors = {}
+		for ai=1,#args do
+			local ac,success = tryApplyReductionList( node, redulists[ ai], args[ ai].constructor)
+			if not success then return nil end
+			table.insert( arg_constructors, ac)
+		end
+		return item_constructor( this_constructor, arg_constructors, llvmtypes)
+	end
+end
+-- Evaluate if one of the items is a function with a variable number of arguments that can be called with the arguments passed
+function hasVarargCandidate( items, args)
+	for _,item in ipairs(items) do
+		if varargFuncMap[ item] and typedb:type_nof_parameters( item) < #args then return true end
+	end
+	return false
+end
 -- Get the best matching item from a list of items by weighting the matching of the arguments to the item parameter types
 function selectItemsMatchParameters( node, items, args, this_constructor)
+	if not hasVarargCandidate( items, args) then return selectItemsMatchParametersNative( node, items, args, this_constructor) end
 	local item_parameter_map = {}
 	local bestmatch = {}
 	local candidates = {}
@@ -2473,26 +2525,37 @@ function selectItemsMatchParameters( node, items, args, this_constructor)
 	while next(item_parameter_map) ~= nil do -- until no candidate groups left
 		candidates,bestweight = selectCandidateItemsBestWeight( items, item_parameter_map, bestweight)
 		for _,ii in ipairs(candidates) do -- create the items from the item constructors passing
-			local item_constructor = typedb:type_constructor( items[ ii])
-			local call_constructor
-			if not item_constructor and #args == 0 then
-				call_constructor = this_constructor
-			else
-				local ac,success = nil,true
-				local arg_constructors = {}
-				for ai=1,#args do
-					ac,success = tryApplyReductionList( node, item_parameter_map[ ii].redulist[ ai], args[ ai].constructor)
-					if not success then break end
-					table.insert( arg_constructors, ac)
-				end
-				if success then call_constructor = item_constructor( this_constructor, arg_constructors, item_parameter_map[ ii].llvmtypes) end
-			end
+			local call_constructor = constructCallItem( node, items[ ii], args, item_parameter_map[ ii].redulist, item_parameter_map[ ii].llvmtypes, this_constructor)
 			if call_constructor then table.insert( bestmatch, {type=items[ ii], constructor=call_constructor}) end
 			item_parameter_map[ ii] = nil
 		end
 		if #bestmatch ~= 0 then return bestmatch,bestweight end
 	end
 end
+-- Get the best matching item from a list of items without variable arguments, the weighting of the candidates is done by typedb:resolve_callable
+function selectItemsMatchParametersNative( node, items, args, this_constructor)
+	local minweight = nil
+	while true do -- until no candidate groups left
+		local bestweight,candidates = typedb:resolve_callable( items, args, tagmask_matchParameter, tagmask_typeConversion, 1, minweight, "max")
+		if not bestweight then return end
+		local bestmatch = {}
+		for _,candidate in ipairs(candidates) do -- create the items from the item constructors passing
+			local llvmtypes = {}
+			for pi,param in ipairs( typedb:type_parameters( candidate.type)) do
+				if candidate.conflicts and candidate.conflicts[ pi] then
+					utils.errorMessage( node.line, "Ambiguous derivation paths for '%s': %s | %s", typedb:type_string(args[ pi].type),
+								utils.typeListString(typedb,candidate.conflicts[ pi]," =>"), utils.typeListString(typedb,candidate.reductions[ pi]," =>"))
+				end
+				local descr = typeDescriptionMap[ param.type]
+				table.insert( llvmtypes, descr and descr.llvmtype or "__control")
+			end
+			local call_constructor = constructCallItem( node, candidate.type, args, candidate.reductions, llvmtypes, this_constructor)
+			if call_constructor then table.insert( bestmatch, {type=candidate.type, constructor=call_constructor}) end
+		end
+		if #bestmatch ~= 0 then return bestmatch,bestweight end
+		minweight = bestweight
+	end
+end
 -- Find a callable identified by name and its arguments (parameter matching) in the context of a type (this)
 function findCallable( node, this, callable, args)
 	local mask = (callable == ":=" or callable == "=") and tagmask_declaration or tagmask_resolveType
@@ -3820,6 +3883,7 @@ end
 function typesystem.program( node, options)
 	llvmir.init()
 	initBuiltInTypes()
+	typedb:freeze_reductions()
 	globalCallableEnvironment = createCallableEnvironment( node, "globals ", nil, false, "%ir", "IL")
 	globalAllocationFrame = createAllocationFrame( globalCallableEnvironment, typedb:scope())
 	globalAllocationFrame.catch = globalAllocationFrame -- there is not really a try/catch but we catch the exceptions of global initializations in the main (label "abort")
@@ -1,6 +1,7 @@
 --- Utility functions for the typesystem module
 -- Use Lua5.2 bit manipulation library
 local bit32 = require "bit32"
+local mewa = require "mewa"
 -- Module object with all functions exported
 local utils = {}
 
@@ -195,6 +196,11 @@ function utils.traverse( typedb, node, ...)
 		return node.value
 	end
 end
+-- Use the native implementations of the tree traversal functions with the same semantics if provided by the mewa module:
+if mewa.traverse then
+	utils.traverse = mewa.traverse
+	utils.traverseRange = mewa.traverseRange
+end
 -- Find all top subnodes with a specific function (does not seek in children of matches)
 function utils.findNodes( node, func)
 	function findSubNodes_( res, node, func)
@@ -338,6 +338,22 @@ public:
 	std::string tostring() const;
 	std::string actionString( const Action& action) const;
 
+	/// \brief Check the syntax of a source with the lexer and the parser tables only, without building an AST or calling any functions
+	/// \note Throws the first syntax error found with its line number
+	/// \param[in] scanner scanner of the source to check
+	void checkSyntax( Scanner& scanner) const;
+
+	/// \brief Get the list of terminals expected in a state as string for error messages
+	/// \param[in] state index of the state of the automaton
+	std::string expectedTerminalList( int state) const;
+	/// \brief Get the description of a state transition as string for error messages
+	/// \param[in] state index of the state of the automaton
+	/// \param[in] terminal terminal (lexem identifier) causing the transition
+	std::string stateTransitionInfo( int state, int terminal) const;
+	/// \brief Get the description of a lexem as string for error messages
+	/// \param[in] lexem lexem to describe
+	std::string tokenString( const Lexem& lexem) const;
+
 private:
 	int m_version;
 	std::string m_language;
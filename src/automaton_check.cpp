@@ -0,0 +1,129 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Syntax check of a source with the LALR(1) parser automaton without building an AST
+/// \file "automaton_check.cpp"
+#include "automaton.hpp"
+#include "lexer.hpp"
+#include "error.hpp"
+#include "strings.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+
+using namespace mewa;
+
+static std::string getLexemName( const Lexer& lexer, int terminal)
+{
+	return terminal ? lexer.lexemName( terminal) : std::string("$");
+}
+
+std::string Automaton::expectedTerminalList( int state) const
+{
+	std::string rt;
+	auto ai = m_actions.lower_bound({ state, 0 });
+	int aidx = 0;
+	for (; ai != m_actions.end() && ai->first.state() == state; ++ai,++aidx)
+	{
+		if (aidx) rt.append(", ");
+		rt.append( getLexemName( m_lexer, ai->first.terminal()));
+	}
+	return rt;
+}
+
+std::string Automaton::stateTransitionInfo( int state, int terminal) const
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "state %d, token ", state);
+	std::string rt( buf);
+	rt.append( getLexemName( m_lexer, terminal));
+	return rt;
+}
+
+std::string Automaton::tokenString( const Lexem& lexem) const
+{
+	std::string rt;
+	if (lexem.id() == 0)
+	{
+		rt.append( "$");
+	}
+	else
+	{
+		rt.append( m_lexer.lexemName( lexem.id()));
+		if (!m_lexer.isKeyword( lexem.id()))
+		{
+			rt.append( " = \"");
+			rt.append( lexem.value());
+			rt.append( "\"");
+		}
+	}
+	return rt;
+}
+
+void Automaton::checkSyntax( Scanner& scanner) const
+{
+	std::vector<int> stateStack( {1/*start state*/});
+	bool accepted = false;
+	do
+	{
+		Lexem lexem = m_lexer.next( scanner);
+		if (!lexem.empty() && lexem.id() <= 0)
+		{
+			throw Error( Error::BadCharacterInGrammarDef, lexem.value(), lexem.line());
+		}
+		bool consumed = false;
+		while (!consumed)
+		{
+			auto nexti = m_actions.find( {stateStack.back(), lexem.id()/*terminal*/});
+			if (nexti == m_actions.end())
+			{
+				throw Error( Error::UnexpectedTokenNotOneOf, tokenString( lexem) + " { " + expectedTerminalList( stateStack.back()) + " }", lexem.line());
+			}
+			switch (nexti->second.type())
+			{
+				case Action::Shift:
+					stateStack.push_back( nexti->second.state());
+					consumed = true;
+					break;
+
+				case Action::Accept:
+				case Action::Reduce:
+				{
+					int reductionSize = nexti->second.count();
+					if ((int)stateStack.size() <= reductionSize || reductionSize < 0)
+					{
+						throw Error( Error::LanguageAutomatonCorrupted, lexem.line());
+					}
+					stateStack.resize( stateStack.size() - reductionSize);
+					if (nexti->second.type() == Action::Accept)
+					{
+						if (lexem.id()/*terminal*/ != 0)
+						{
+							throw Error( Error::LanguageAutomatonUnexpectedAccept, lexem.line());
+						}
+						accepted = consumed = true;
+					}
+					else
+					{
+						auto gtoi = m_gotos.find( {stateStack.back(), nexti->second.nonterminal()});
+						if (gtoi == m_gotos.end())
+						{
+							throw Error( Error::LanguageAutomatonMissingGoto, stateTransitionInfo( stateStack.back(), lexem.id()/*terminal*/), lexem.line());
+						}
+						stateStack.push_back( gtoi->second.state());
+					}
+					break;
+				}
+			}
+		}
+	}
+	while (!accepted);
+}
+
@@ -230,6 +230,7 @@ const char* Error::code2String( int code_) noexcept
 		case TooFewArguments: return "Too few arguments";
 		case TooManyArguments: return "Too many arguments";
 		case CompileError: return "Compile error";
+		case InvalidCompilerConfiguration: return "Invalid compiler configuration (unknown option or bad option value)";
 
 		case IllegalFirstCharacterInLexer: return "Bad character in a regular expression passed to the lexer";
 		case SyntaxErrorInLexer: return "Syntax error in the lexer definition";
@@ -255,6 +256,7 @@ const char* Error::code2String( int code_) noexcept
 		case AmbiguousReductionDefinitions: return "Ambiguous definitions of reductions";
 		case ScopeHierarchyError: return "Error in scope hierarchy: Defined overlapping scopes without one including the other";
 		case InvalidReductionDefinition: return "Invalid reduction definition";
+		case ModificationOfFrozenTypeDatabase: return "Modification of a type database after it has been frozen";
 
 		case BadCharacterInGrammarDef: return "Bad character in the grammar definition";
 		case ValueOutOfRangeInGrammarDef: return "Value out of range in the grammar definition";
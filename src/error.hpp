@@ -54,6 +54,7 @@ public:
 		TooFewArguments=421,
 		TooManyArguments=422,
 		CompileError=423,
+		InvalidCompilerConfiguration=424,
 
 		IllegalFirstCharacterInLexer=431,
 		SyntaxErrorInLexer=432,
@@ -78,6 +79,7 @@ public:
 		AmbiguousReductionDefinitions=462,
 		ScopeHierarchyError=463,
 		InvalidReductionDefinition=464,
+		ModificationOfFrozenTypeDatabase=465,
 
 		BadCharacterInGrammarDef=501,
 		ValueOutOfRangeInGrammarDef=502,
@@ -16,6 +16,7 @@
 #include <cstring>
 #include <string>
 #include <libgen.h>
+#include <sys/stat.h>
 
 using namespace mewa;
 
@@ -99,6 +100,20 @@ void mewa::removeFile( const std::string& filename)
 	}
 }
 
+bool mewa::isRegularFile( const char* filename)
+{
+	struct stat st;
+	if (0 != ::stat( filename, &st)) return true; //... errors are reported when the file is read
+	return S_ISREG( st.st_mode);
+}
+
+bool mewa::isDirectory( const char* path)
+{
+	struct stat st;
+	if (0 != ::stat( path, &st)) return false;
+	return S_ISDIR( st.st_mode);
+}
+
 std::string mewa::fileBaseName( const std::string_view& fnam)
 {
 	char buf[ 1024];
@@ -24,6 +24,10 @@ std::string readFile( const std::string& filename);
 std::string readFile( const char* filename);
 std::vector<std::string> readFileLines( const std::string& filename);
 void removeFile( const std::string& filename);
+/// \brief Evaluate if a path addresses a regular file and not a pipe or a device, true if the file does not exist
+bool isRegularFile( const char* filename);
+/// \brief Evaluate if a path addresses an existing directory
+bool isDirectory( const char* path);
 std::string fileBaseName( const std::string_view& fnam);
 
 }//namespace
@@ -13,6 +13,9 @@
 #include "error.hpp"
 #include "strings.hpp"
 #include "utf8.hpp"
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
 
 using namespace mewa;
 
@@ -308,6 +311,79 @@ Scanner::IndentToken Scanner::getEofIndentToken()
 	}
 }
 
+bool Scanner::fetch()
+{
+	if (!m_reader || m_eof) return false;
+	std::size_t ofs = m_srcitr - m_src.data();
+	// Discard the data consumed except the current line needed for the calculation of the indentation:
+	std::size_t keep = ofs;
+	for (; keep > 0 && m_buffer[ keep-1] != '\n'; --keep){}
+	if (keep > 0)
+	{
+		m_buffer.erase( 0, keep);
+		m_bufferpos += keep;
+		ofs -= keep;
+	}
+	std::size_t prevsize = m_buffer.size();
+	if (!m_reader->read( m_buffer))
+	{
+		m_eof = true;
+	}
+	rebase( ofs);
+	return m_buffer.size() > prevsize;
+}
+
+bool Scanner::prefetch()
+{
+	bool rt = false;
+	while (!m_eof && restsize() < m_lookahead)
+	{
+		rt |= fetch();
+	}
+	return rt;
+}
+
+bool Scanner::fetchFrom( const Position& pos)
+{
+	if (!m_reader || m_eof) return false;
+	if (pos.offset < m_bufferpos || pos.offset - m_bufferpos > m_buffer.size())
+	{
+		throw Error( Error::LogicError, string_format( "%s line %d", __FILE__, (int)__LINE__));
+	}
+	m_srcitr = m_src.data() + (pos.offset - m_bufferpos);
+	m_line = pos.line;
+	fetch();
+	return true;
+}
+
+ScannerFileReader::ScannerFileReader( const std::string& filename_)
+	:m_fd(::open( filename_.c_str(), O_RDONLY)),m_ownership(true),m_filename(filename_)
+{
+	if (m_fd < 0) throw Error( (Error::Code)errno, m_filename);
+}
+
+ScannerFileReader::~ScannerFileReader()
+{
+	if (m_ownership && m_fd >= 0) ::close( m_fd);
+}
+
+bool ScannerFileReader::read( std::string& buf)
+{
+	enum {RBufsize = 1<<16};
+	char rbuf[ RBufsize];
+	for (;;)
+	{
+		ssize_t nn = ::read( m_fd, rbuf, RBufsize);
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			throw Error( (Error::Code)errno, m_filename);
+		}
+		buf.append( rbuf, nn);
+		return nn > 0;
+	}
+}
+
 bool Scanner::match( const char* str)
 {
 	int ii = 0;
@@ -459,14 +535,13 @@ void Lexer::defineIndentLexems( int line, const std::string_view& open, const st
 static std::string stringToRegex( const std::string_view& opr)
 {
 	std::string rt;
-	char const* si = opr.data();
-	for (; *si; ++si)
+	for (char ch : opr)
 	{
-		if (0!=std::strchr( REGEX_ESCAPE_CHARS, *si))
+		if (0!=std::strchr( REGEX_ESCAPE_CHARS, ch))
 		{
 			rt.push_back( '\\');
 		}
-		rt.push_back( *si);
+		rt.push_back( ch);
 	}
 	return rt;
 }
@@ -547,8 +622,14 @@ Lexem Lexer::next( Scanner& scanner) const
 	for (;;)
 	{
 		char const* start = scanner.next();
+		if (scanner.prefetch())
+		{
+			start = scanner.next();
+		}
+		Scanner::Position startpos = scanner.position();
 		if (*start == '\0')
 		{
+			if (scanner.fetchFrom( startpos)) continue; //... more data read
 			if (m_indentLexems.defined() && scanner.getEofIndentToken() == Scanner::IndentClose)
 			{
 				return Lexem( m_namelist[ m_indentLexems.close-1], m_indentLexems.close, ""/*value*/, scanner.line());
@@ -570,6 +651,7 @@ Lexem Lexer::next( Scanner& scanner) const
 				{
 					if (!scanner.scan( "\n"))
 					{
+						if (scanner.fetchFrom( startpos)) break; //... more data read, match again
 						return Lexem( scanner.line()); //... no EOLN then return EOF
 					}
 					break; //... comment skipped, fetch next lexem
@@ -582,6 +664,7 @@ Lexem Lexer::next( Scanner& scanner) const
 				{
 					if (!scanner.scan( m_bracketComments[ cidx].close.c_str()))
 					{
+						if (scanner.fetchFrom( startpos)) break; //... more data read, match again
 						return Lexem( m_errorLexem.value, -1/*id*/, m_bracketComments[ cidx].open, scanner.line());
 						//... no matching end bracket of comment found, then return ERROR
 					}
@@ -592,7 +675,7 @@ Lexem Lexer::next( Scanner& scanner) const
 			{
 				if (idx >= (int)m_defar.size()) throw Error( Error::ArrayBoundReadInLexer);
 				auto mm = m_defar[ idx].match( start, scanner.restsize());
-				if (maxlen <= mm.second && (maxlen < mm.second || m_defar[ idx].keyword())) //... keywords preferred if length is the same
+				if (mm.second > 0 && maxlen <= mm.second && (maxlen < mm.second || m_defar[ idx].keyword())) //... keywords preferred if length is the same
 				{
 					maxlen = mm.second;
 					matchstart = mm.first.data();
@@ -603,6 +686,10 @@ Lexem Lexer::next( Scanner& scanner) const
 		}
 		if (ri == range.second)
 		{
+			if ((matchidx < 0 || maxlen >= (int)scanner.restsize()) && scanner.fetchFrom( startpos))
+			{
+				continue; //... match reached the end of the data read, match again with more data
+			}
 			int line = scanner.line();
 			if (matchidx < 0)
 			{
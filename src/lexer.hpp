@@ -91,17 +91,72 @@ private:
 };
 
 
+/// \brief Interface for reading the source of a scanner incrementally
+class ScannerReader
+{
+public:
+	virtual ~ScannerReader(){}
+	/// \brief Append the next chunk of the source to a buffer
+	/// \param[in,out] buf buffer to append the chunk read to
+	/// \return false if the end of the source has been reached and nothing was read, true else
+	virtual bool read( std::string& buf) = 0;
+};
+
+/// \brief Reader of a scanner source from a file descriptor (file, pipe, socket)
+class ScannerFileReader
+	:public ScannerReader
+{
+public:
+	/// \brief Constructor
+	/// \param[in] fd_ file descriptor to read from
+	/// \param[in] ownership_ true if the file descriptor is closed by the reader
+	explicit ScannerFileReader( int fd_, bool ownership_=false) noexcept
+		:m_fd(fd_),m_ownership(ownership_),m_filename(){}
+	/// \brief Constructor opening a file for reading
+	/// \param[in] filename_ path of the file to read from
+	explicit ScannerFileReader( const std::string& filename_);
+	ScannerFileReader( const ScannerFileReader&) = delete;
+	virtual ~ScannerFileReader();
+
+	virtual bool read( std::string& buf);
+
+private:
+	int m_fd;
+	bool m_ownership;
+	std::string m_filename;
+};
+
 class Scanner
 {
 public:
+	enum {DefaultLookAhead = 1<<12};
+
 	explicit Scanner( const std::string_view& src_)
-		:m_src(src_),m_srcitr(src_.data()),m_line(1),m_indentstk(),m_indentConsumed(false){void checkNullTerminated();}
+		:m_src(src_),m_srcitr(src_.data()),m_line(1),m_indentstk(),m_indentConsumed(false)
+		,m_reader(nullptr),m_lookahead(0),m_buffer(),m_bufferpos(0),m_eof(true){void checkNullTerminated();}
 	explicit Scanner( const std::string& src_)
-		:m_src(src_),m_srcitr(src_.c_str()),m_line(1),m_indentstk(),m_indentConsumed(false){}
+		:m_src(src_),m_srcitr(src_.c_str()),m_line(1),m_indentstk(),m_indentConsumed(false)
+		,m_reader(nullptr),m_lookahead(0),m_buffer(),m_bufferpos(0),m_eof(true){}
+	/// \brief Constructor of a scanner reading its source incrementally
+	/// \param[in] reader_ reader of the source, owned by the caller
+	/// \param[in] lookahead_ minimum number of bytes available after the current position before the next lexem is matched (except at the end of the source)
+	/// \note Matches of lexems that reach the end of the data read are repeated after more data has been read.
+	///	Lexem values returned by the lexer stay valid until the next lexem is fetched.
+	explicit Scanner( ScannerReader* reader_, std::size_t lookahead_ = DefaultLookAhead)
+		:m_src(),m_srcitr(nullptr),m_line(1),m_indentstk(),m_indentConsumed(false)
+		,m_reader(reader_),m_lookahead(lookahead_),m_buffer(),m_bufferpos(0),m_eof(false)
+		{rebase( 0);}
 	Scanner( const Scanner& o)
-		:m_src(o.m_src),m_srcitr(o.m_srcitr),m_line(o.m_line),m_indentstk(o.m_indentstk),m_indentConsumed(o.m_indentConsumed){}
+		:m_src(o.m_src),m_srcitr(o.m_srcitr),m_line(o.m_line),m_indentstk(o.m_indentstk),m_indentConsumed(o.m_indentConsumed)
+		,m_reader(o.m_reader),m_lookahead(o.m_lookahead),m_buffer(o.m_buffer),m_bufferpos(o.m_bufferpos),m_eof(o.m_eof)
+		{if (m_reader) rebase( o.m_srcitr - o.m_src.data());}
 	Scanner& operator=( const Scanner& o)
-		{m_src=o.m_src; m_srcitr=o.m_srcitr; m_line=o.m_line; m_indentstk=o.m_indentstk; m_indentConsumed=o.m_indentConsumed; return *this;}
+	{
+		m_src=o.m_src; m_srcitr=o.m_srcitr; m_line=o.m_line; m_indentstk=o.m_indentstk; m_indentConsumed=o.m_indentConsumed;
+		m_reader=o.m_reader; m_lookahead=o.m_lookahead; m_buffer=o.m_buffer; m_bufferpos=o.m_bufferpos; m_eof=o.m_eof;
+		if (m_reader) rebase( o.m_srcitr - o.m_src.data());
+		return *this;
+	}
 
 	int line() const noexcept			{return m_line;}
 
@@ -117,14 +172,42 @@ public:
 	IndentToken getIndentToken( int tabSize);
 	IndentToken getEofIndentToken();
 
+	/// \brief Position in the source, used to restart the matching of a lexem
+	struct Position
+	{
+		std::size_t offset;	///< offset of the position from the start of the source
+		int line;		///< line number of the position
+	};
+	Position position() const noexcept		{return {m_bufferpos + (m_srcitr - m_src.data()), m_line};}
+
+	/// \brief Read more data if the scanner reads its source incrementally and the lookahead is not available
+	/// \return true if data has been read, false else
+	bool prefetch();
+	/// \brief Go back to a position and read more data, if the scanner reads its source incrementally and the end of the source has not been reached yet
+	/// \note Used to repeat the matching of a lexem that reached the end of the data read
+	/// \return true if the position has been restored and the matching has to be repeated, false else
+	bool fetchFrom( const Position& pos);
+
 private:
 	void checkNullTerminated();
+	bool fetch();
+	void rebase( std::size_t ofs) noexcept
+	{
+		m_src = std::string_view( m_buffer.c_str(), m_buffer.size());
+		m_srcitr = m_src.data() + ofs;
+	}
+
 private:
 	std::string_view m_src;
 	char const* m_srcitr;
 	int m_line;
 	std::vector<int> m_indentstk;
 	bool m_indentConsumed;
+	ScannerReader* m_reader;
+	std::size_t m_lookahead;
+	std::string m_buffer;
+	std::size_t m_bufferpos;
+	bool m_eof;
 };
 
 
@@ -0,0 +1,325 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Profiler of the Lua AST node functions called by the compiler
+/// \file "lua_call_profiler.cpp"
+
+#include "lua_call_profiler.hpp"
+#include "strings.hpp"
+#include "error.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#if __cplusplus < 201703L
+#error Building mewa requires C++17
+#endif
+
+#define MEWA_PROFILER_METATABLE_NAME	"mewa.profiler"
+
+// Upvalues of the wrapper of a function profiled:
+#define PROFILER_UPVALUE_PROFILER	1	///< Profiler userdata
+#define PROFILER_UPVALUE_FUNCTION	2	///< Original function called
+#define PROFILER_UPVALUE_NAME		3	///< Index of the name of the call in the profiler
+
+static int luaProfiledCall( lua_State* ls)
+{
+	mewa::LuaCallProfiler* profiler = (mewa::LuaCallProfiler*)lua_touserdata( ls, lua_upvalueindex( PROFILER_UPVALUE_PROFILER));
+	int nameidx = lua_tointeger( ls, lua_upvalueindex( PROFILER_UPVALUE_NAME));
+	int nargs = lua_gettop( ls);
+	luaL_checkstack( ls, 4, "profiled call");
+	lua_pushvalue( ls, lua_upvalueindex( PROFILER_UPVALUE_FUNCTION));
+	lua_insert( ls, 1);							// STK: [FUNC] [ARG]..
+
+	bool memoryError = false;
+	try
+	{
+		profiler->enter( nameidx);
+	}
+	catch (...)
+	{
+		memoryError = true;
+	}
+	if (memoryError)
+	{
+		return luaL_error( ls, "%s", mewa::Error( mewa::Error::MemoryAllocationError).what());
+	}
+	// ... no message handler, the error is passed on to the message handler of the outermost call
+	int rc = lua_pcall( ls, nargs, LUA_MULTRET, 0);			// STK: [RESULT]..
+	try
+	{
+		profiler->leave();
+	}
+	catch (...)
+	{
+		memoryError = true;
+	}
+	if (rc)
+	{
+		return lua_error( ls);
+	}
+	if (memoryError)
+	{
+		return luaL_error( ls, "%s", mewa::Error( mewa::Error::MemoryAllocationError).what());
+	}
+	return lua_gettop( ls);
+}
+
+static int luaDestroyCallProfiler( lua_State* ls)
+{
+	mewa::LuaCallProfiler* profiler = (mewa::LuaCallProfiler*)lua_touserdata( ls, 1);
+	profiler->~LuaCallProfiler();
+	return 0;
+}
+
+mewa::LuaCallProfiler* mewa::luaPushCallProfiler( lua_State* ls)
+{
+	LuaCallProfiler* rt = (LuaCallProfiler*)lua_newuserdata( ls, sizeof(LuaCallProfiler));	// STK: [PROFILER]
+	new (rt) LuaCallProfiler();
+	if (luaL_newmetatable( ls, MEWA_PROFILER_METATABLE_NAME))				// STK: [PROFILER] [MT]
+	{
+		lua_pushliteral( ls, "__gc");							// STK: [PROFILER] [MT] "__gc"
+		lua_pushcfunction( ls, &luaDestroyCallProfiler);				// STK: [PROFILER] [MT] "__gc" [FUNC]
+		lua_rawset( ls, -3);								// STK: [PROFILER] [MT]
+	}
+	lua_setmetatable( ls, -2);								// STK: [PROFILER]
+	return rt;
+}
+
+int mewa::LuaCallProfiler::nameIndex( const std::string& name)
+{
+	auto ins = m_nameidmap.insert( std::pair<std::string,int>( name, m_names.size()));
+	if (ins.second)
+	{
+		m_names.push_back( name);
+		m_stats.push_back( Statistics());
+	}
+	return ins.first->second;
+}
+
+void mewa::LuaCallProfiler::pushWrapper( lua_State* ls, int profileridx, int nameidx)
+{
+	// STK: [FUNC]
+	lua_pushvalue( ls, profileridx);			// STK: [FUNC] [PROFILER]
+	lua_insert( ls, -2);					// STK: [PROFILER] [FUNC]
+	lua_pushinteger( ls, nameidx);				// STK: [PROFILER] [FUNC] [NAMEIDX]
+	lua_pushcclosure( ls, &luaProfiledCall, 3);		// STK: [WRAPPER]
+}
+
+/// \brief Replace the wrappers of profiled functions on top of the stack by the original function
+static void unwrapProfiledFunction( lua_State* ls)
+{
+	while (lua_tocfunction( ls, -1) == &luaProfiledCall)
+	{
+		lua_getupvalue( ls, -1, PROFILER_UPVALUE_FUNCTION);
+		lua_replace( ls, -2);
+	}
+}
+
+void mewa::LuaCallProfiler::instrumentCallTable( lua_State* ls, int profileridx, int calltableidx)
+{
+	luaL_checkstack( ls, 8, "profiler");
+	for (int ci = 1;; ++ci)
+	{
+		lua_rawgeti( ls, calltableidx, ci);			// STK: [CALL]
+		if (lua_isnil( ls, -1))
+		{
+			lua_pop( ls, 1);
+			break;
+		}
+		if (lua_istable( ls, -1))
+		{
+			lua_pushliteral( ls, "name");
+			lua_rawget( ls, -2);				// STK: [CALL] [NAME]
+			lua_pushliteral( ls, "proc");
+			lua_rawget( ls, -3);				// STK: [CALL] [NAME] [PROC]
+			if (lua_type( ls, -2) == LUA_TSTRING && lua_isfunction( ls, -1))
+			{
+				unwrapProfiledFunction( ls);
+				int nameidx = nameIndex( lua_tostring( ls, -2));
+				pushWrapper( ls, profileridx, nameidx);	// STK: [CALL] [NAME] [WRAPPER]
+				lua_pushliteral( ls, "proc");
+				lua_insert( ls, -2);			// STK: [CALL] [NAME] "proc" [WRAPPER]
+				lua_rawset( ls, -4);			// STK: [CALL] [NAME]
+				lua_pop( ls, 1);
+			}
+			else
+			{
+				lua_pop( ls, 2);
+			}
+		}
+		lua_pop( ls, 1);
+	}
+}
+
+void mewa::LuaCallProfiler::instrumentMethods( lua_State* ls, int profileridx, const char* metatableName, const char* prefix)
+{
+	luaL_checkstack( ls, 8, "profiler");
+	luaL_getmetatable( ls, metatableName);				// STK: [MT]
+	lua_pushnil( ls);						// STK: [MT] [KEY]
+	while (lua_next( ls, -2))					// STK: [MT] [KEY] [VAL]
+	{
+		if (lua_type( ls, -2) == LUA_TSTRING && lua_isfunction( ls, -1))
+		{
+			const char* key = lua_tostring( ls, -2);
+			if (key[0] != '_' || key[1] != '_')
+			{
+				unwrapProfiledFunction( ls);
+				int nameidx = nameIndex( std::string( prefix) + key);
+				pushWrapper( ls, profileridx, nameidx);	// STK: [MT] [KEY] [WRAPPER]
+				lua_pushvalue( ls, -2);			// STK: [MT] [KEY] [WRAPPER] [KEY]
+				lua_insert( ls, -2);			// STK: [MT] [KEY] [KEY] [WRAPPER]
+				lua_rawset( ls, -4);			// STK: [MT] [KEY]
+				continue;
+			}
+		}
+		lua_pop( ls, 1);					// STK: [MT] [KEY]
+	}
+	lua_pop( ls, 1);
+}
+
+void mewa::LuaCallProfiler::restoreCallTable( lua_State* ls, int calltableidx)
+{
+	luaL_checkstack( ls, 8, "profiler");
+	for (int ci = 1;; ++ci)
+	{
+		lua_rawgeti( ls, calltableidx, ci);			// STK: [CALL]
+		if (lua_isnil( ls, -1))
+		{
+			lua_pop( ls, 1);
+			break;
+		}
+		if (lua_istable( ls, -1))
+		{
+			lua_pushliteral( ls, "proc");
+			lua_rawget( ls, -2);				// STK: [CALL] [PROC]
+			if (lua_tocfunction( ls, -1) == &luaProfiledCall)
+			{
+				unwrapProfiledFunction( ls);
+				lua_pushliteral( ls, "proc");
+				lua_insert( ls, -2);			// STK: [CALL] "proc" [PROC]
+				lua_rawset( ls, -3);			// STK: [CALL]
+			}
+			else
+			{
+				lua_pop( ls, 1);
+			}
+		}
+		lua_pop( ls, 1);
+	}
+}
+
+void mewa::LuaCallProfiler::restoreMethods( lua_State* ls, const char* metatableName)
+{
+	luaL_checkstack( ls, 8, "profiler");
+	luaL_getmetatable( ls, metatableName);				// STK: [MT]
+	lua_pushnil( ls);						// STK: [MT] [KEY]
+	while (lua_next( ls, -2))					// STK: [MT] [KEY] [VAL]
+	{
+		if (lua_tocfunction( ls, -1) == &luaProfiledCall)
+		{
+			unwrapProfiledFunction( ls);
+			lua_pushvalue( ls, -2);				// STK: [MT] [KEY] [FUNC] [KEY]
+			lua_insert( ls, -2);				// STK: [MT] [KEY] [KEY] [FUNC]
+			lua_rawset( ls, -4);				// STK: [MT] [KEY]
+		}
+		else
+		{
+			lua_pop( ls, 1);				// STK: [MT] [KEY]
+		}
+	}
+	lua_pop( ls, 1);
+}
+
+void mewa::LuaCallProfiler::enter( int nameidx)
+{
+	m_stack.emplace_back( nameidx, Clock::now());
+	m_stats[ nameidx].active += 1;
+}
+
+void mewa::LuaCallProfiler::leave()
+{
+	Clock::time_point now = Clock::now();
+	if (m_stack.empty()) return;
+	const Frame& frame = m_stack.back();
+	double inclusive = std::chrono::duration<double>( now - frame.start).count();
+	double exclusive = inclusive - frame.nested;
+
+	Statistics& st = m_stats[ frame.nameidx];
+	st.count += 1;
+	st.exclusive += exclusive;
+	if (--st.active == 0)
+	{
+		st.inclusive += inclusive;
+	}
+	std::vector<int> path;
+	path.reserve( m_stack.size());
+	for (auto const& fr : m_stack)
+	{
+		path.push_back( fr.nameidx);
+	}
+	m_stacks[ path] += exclusive;
+	m_stack.pop_back();
+	if (!m_stack.empty())
+	{
+		m_stack.back().nested += inclusive;
+	}
+}
+
+std::string mewa::LuaCallProfiler::report() const
+{
+	std::vector<int> order;
+	double total = 0.0;
+	for (std::size_t ni = 0; ni < m_stats.size(); ++ni)
+	{
+		if (m_stats[ ni].count)
+		{
+			order.push_back( ni);
+			total += m_stats[ ni].exclusive;
+		}
+	}
+	std::stable_sort( order.begin(), order.end(), [this]( int aa, int bb) {return m_stats[ aa].exclusive > m_stats[ bb].exclusive;});
+
+	std::string rt = mewa::string_format( "%-40s %10s %14s %14s %8s\n", "Function", "Calls", "Inclusive ms", "Exclusive ms", "Excl %");
+	for (int ni : order)
+	{
+		const Statistics& st = m_stats[ ni];
+		rt.append( mewa::string_format( "%-40s %10ld %14.3f %14.3f %8.2f\n",
+				m_names[ ni].c_str(), st.count, st.inclusive * 1000.0, st.exclusive * 1000.0,
+				total > 0.0 ? st.exclusive * 100.0 / total : 0.0));
+	}
+	return rt;
+}
+
+std::string mewa::LuaCallProfiler::collapsedStacks() const
+{
+	std::string rt;
+	for (auto const& stk : m_stacks)
+	{
+		long microseconds = std::lround( stk.second * 1000000.0);
+		if (microseconds <= 0) continue;
+
+		int pi = 0;
+		for (int nameidx : stk.first)
+		{
+			if (pi++) rt.push_back( ';');
+			rt.append( m_names[ nameidx]);
+		}
+		rt.append( mewa::string_format( " %ld\n", microseconds));
+	}
+	return rt;
+}
+
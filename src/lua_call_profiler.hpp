@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Profiler of the Lua AST node functions called by the compiler
+/// \file "lua_call_profiler.hpp"
+#ifndef _MEWA_LUA_CALL_PROFILER_HPP_INCLUDED
+#define _MEWA_LUA_CALL_PROFILER_HPP_INCLUDED
+#if __cplusplus >= 201703L
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+extern "C" {
+#include <lua.h>
+}
+
+namespace mewa {
+
+/// \brief Profiler measuring the time spent in functions called by name, inclusive and exclusive the time of nested calls measured
+/// \note The functions are measured by replacing them with C closures that call the original function
+class LuaCallProfiler
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	LuaCallProfiler()
+		:m_names(),m_nameidmap(),m_stats(),m_stack(),m_stacks(){}
+
+	/// \brief Replace the field 'proc' of the elements of a call table with a wrapper measuring the calls by the field 'name'
+	/// \param[in] ls Lua state
+	/// \param[in] profileridx Lua stack index of the profiler userdata
+	/// \param[in] calltableidx Lua stack index of the call table
+	void instrumentCallTable( lua_State* ls, int profileridx, int calltableidx);
+	/// \brief Replace the methods of a metatable with a wrapper measuring the calls by the name of the method
+	/// \param[in] ls Lua state
+	/// \param[in] profileridx Lua stack index of the profiler userdata
+	/// \param[in] metatableName name of the metatable in the Lua registry
+	/// \param[in] prefix prefix of the method names in the profile
+	void instrumentMethods( lua_State* ls, int profileridx, const char* metatableName, const char* prefix);
+
+	/// \brief Get a report with the statistics per function sorted by exclusive time
+	std::string report() const;
+	/// \brief Get the exclusive time spent per call stack in microseconds in the collapsed stack format used by flame graph tools
+	std::string collapsedStacks() const;
+
+	void enter( int nameidx);
+	void leave();
+
+	/// \brief Restore the original functions replaced by a profiler in a call table
+	/// \param[in] ls Lua state
+	/// \param[in] calltableidx Lua stack index of the call table
+	static void restoreCallTable( lua_State* ls, int calltableidx);
+	/// \brief Restore the original methods replaced by a profiler in a metatable
+	/// \param[in] ls Lua state
+	/// \param[in] metatableName name of the metatable in the Lua registry
+	static void restoreMethods( lua_State* ls, const char* metatableName);
+
+private:
+	int nameIndex( const std::string& name);
+	void pushWrapper( lua_State* ls, int profileridx, int nameidx);
+
+private:
+	struct Statistics
+	{
+		long count;			///< number of calls
+		int active;			///< number of calls on the stack, for not counting recursive calls twice in the inclusive time
+		double inclusive;		///< time in seconds including nested calls measured
+		double exclusive;		///< time in seconds excluding nested calls measured
+
+		Statistics()
+			:count(0),active(0),inclusive(0.0),exclusive(0.0){}
+	};
+	struct Frame
+	{
+		int nameidx;			///< name of the call
+		Clock::time_point start;	///< time of the call
+		double nested;			///< time of nested calls measured
+
+		Frame( int nameidx_, const Clock::time_point& start_)
+			:nameidx(nameidx_),start(start_),nested(0.0){}
+	};
+
+	std::vector<std::string> m_names;
+	std::map<std::string,int> m_nameidmap;
+	std::vector<Statistics> m_stats;
+	std::vector<Frame> m_stack;
+	std::map<std::vector<int>,double> m_stacks;
+};
+
+/// \brief Create a profiler as userdata on the Lua stack
+/// \param[in] ls Lua state
+/// \return pointer to the profiler created
+LuaCallProfiler* luaPushCallProfiler( lua_State* ls);
+
+} //namespace
+#else
+#error Building mewa requires C++17
+#endif
+#endif
+
@@ -43,6 +43,20 @@ private:
 	OBJECT m_obj;
 };
 
+template <class OBJECT>
+class ObjectOwnership :public MemoryBlock
+{
+public:
+	explicit ObjectOwnership( OBJECT* obj_)
+		:m_obj(obj_){}
+	virtual ~ObjectOwnership(){delete m_obj;}
+
+	OBJECT* obj() noexcept				{return m_obj;}
+
+private:
+	OBJECT* m_obj;
+};
+
 } //namespace
 
 
@@ -0,0 +1,467 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Function to run a compiler on a batch of sources with a pool of worker threads, each owning its own Lua state
+/// \file "lua_run_batch.cpp"
+
+#include "lua_run_batch.hpp"
+#include "lua_run_compiler.hpp"
+#include "lua_5_2.hpp"
+#include "error.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <system_error>
+#include <algorithm>
+#include <limits>
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+#if __cplusplus < 201703L
+#error Building mewa requires C++17
+#endif
+
+#define MEWA_BATCH_MODULES_KEY	"mewa.batch.modules"
+#define MEWA_BATCH_COMPILER_KEY	"mewa.batch.compiler"
+
+void mewa::LuaDataCopy::assign( lua_State* ls, int li)
+{
+	type = lua_type( ls, li);
+	switch (type)
+	{
+		case LUA_TNIL:
+			break;
+		case LUA_TBOOLEAN:
+			number = lua_toboolean( ls, li) ? 1 : 0;
+			break;
+		case LUA_TNUMBER:
+			isInteger = lua_isinteger( ls, li);
+			number = lua_tonumber( ls, li);
+			break;
+		case LUA_TSTRING:
+		{
+			std::size_t len;
+			const char* str = lua_tolstring( ls, li, &len);
+			string.assign( str, len);
+			break;
+		}
+		case LUA_TTABLE:
+		{
+			if (!lua_checkstack( ls, 4)) throw mewa::Error( mewa::Error::MemoryAllocationError);
+			lua_pushvalue( ls, li);
+			lua_pushnil( ls);
+			while (lua_next( ls, -2))
+			{
+				elements.emplace_back();
+				elements.back().assign( ls, -2);
+				elements.emplace_back();
+				elements.back().assign( ls, -1);
+				lua_pop( ls, 1);
+			}
+			lua_pop( ls, 1);
+			break;
+		}
+		default:
+			throw mewa::Error( mewa::Error::SerializationError, lua_typename( ls, type));
+	}
+}
+
+void mewa::LuaDataCopy::push( lua_State* ls) const
+{
+	switch (type)
+	{
+		case LUA_TNIL:
+			lua_pushnil( ls);
+			break;
+		case LUA_TBOOLEAN:
+			lua_pushboolean( ls, number != 0);
+			break;
+		case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+			if (isInteger)
+			{
+				lua_pushinteger( ls, (lua_Integer)number);
+				break;
+			}
+#endif
+			lua_pushnumber( ls, number);
+			break;
+		case LUA_TSTRING:
+			lua_pushlstring( ls, string.c_str(), string.size());
+			break;
+		case LUA_TTABLE:
+		{
+			luaL_checkstack( ls, 4, "copy of table");
+			lua_createtable( ls, 0, elements.size() / 2);
+			auto ei = elements.begin(), ee = elements.end();
+			for (; ei != ee; ei += 2)
+			{
+				ei[0].push( ls);
+				ei[1].push( ls);
+				lua_rawset( ls, -3);
+			}
+			break;
+		}
+	}
+}
+
+namespace {
+struct BatchContext
+{
+	const mewa_compiler_userdata_t* compiler;
+	const mewa::LuaBatchEnvironment* env;
+	const std::string* target;
+	const mewa::LuaDataCopy* options;
+	const std::vector<mewa::LuaBatchUnit>* units;
+	std::vector<mewa::LuaBatchResult>* results;
+	std::atomic<std::size_t> nextUnit;		//< index of the next unit not yet processed, shared by all workers
+};
+
+struct WorkerContext
+{
+	BatchContext* batch;
+	mewa_compiler_userdata_t* cp;
+	std::size_t unitidx;
+	std::string error;
+
+	explicit WorkerContext( BatchContext* batch_)
+		:batch(batch_),cp(nullptr),unitidx(0),error(){}
+};
+}//anonymous namespace
+
+static bool isConstantArgument( const std::string& val)
+{
+	if (val.empty()) return false;
+	char ch = val[0];
+	if (ch >= '0' && ch <= '9') return true;
+	if (ch == '{' || ch == '-') return true;
+	return false;
+}
+
+static std::string popErrorMessage( lua_State* ls)
+{
+	const char* msg = lua_tostring( ls, -1);
+	std::string rt = msg ? msg : mewa::Error( mewa::Error::UnexpectedException).what();
+	lua_pop( ls, 1);
+	return rt;
+}
+
+// \brief Initialization of the Lua state of a worker, called in protected mode with the worker context as light userdata argument
+static int luaInitWorker( lua_State* ls)
+{
+	WorkerContext* ctx = (WorkerContext*)lua_touserdata( ls, 1);
+	const mewa::LuaBatchEnvironment* env = ctx->batch->env;
+	luaL_openlibs( ls);
+
+	lua_getglobal( ls, "package");						// STK: [PACKAGE]
+	lua_pushlstring( ls, env->packagePath.c_str(), env->packagePath.size());
+	lua_setfield( ls, -2, "path");
+	lua_pushlstring( ls, env->packageCPath.c_str(), env->packageCPath.size());
+	lua_setfield( ls, -2, "cpath");
+	lua_getfield( ls, -1, "loaded");					// STK: [PACKAGE] [LOADED]
+	lua_pushcfunction( ls, env->openlib);
+	lua_call( ls, 0, 1);							// STK: [PACKAGE] [LOADED] [MEWA]
+	lua_setfield( ls, -2, "mewa");						// STK: [PACKAGE] [LOADED]
+
+	// Remember the modules loaded before compiling any unit, all other modules are unloaded after each unit:
+	lua_newtable( ls);							// STK: [PACKAGE] [LOADED] [MODULES]
+	lua_pushnil( ls);
+	while (lua_next( ls, -3))
+	{
+		lua_pop( ls, 1);
+		lua_pushvalue( ls, -1);
+		lua_pushboolean( ls, 1);
+		lua_rawset( ls, -4);
+	}
+	lua_setfield( ls, LUA_REGISTRYINDEX, MEWA_BATCH_MODULES_KEY);		// STK: [PACKAGE] [LOADED]
+	lua_pop( ls, 2);
+
+	// Create the compiler of the worker as copy of the compiler of the caller:
+	mewa_compiler_userdata_t* cp = (mewa_compiler_userdata_t*)lua_newuserdata( ls, sizeof(mewa_compiler_userdata_t));
+	bool success = true;
+	try
+	{
+		cp->init();
+		const mewa_compiler_userdata_t* src = ctx->batch->compiler;
+		cp->automaton = src->automaton;
+		cp->arenaAst = src->arenaAst;
+		cp->statistics = src->statistics;
+		std::strcpy( cp->astCacheDir, src->astCacheDir);
+		cp->automatonHash = src->automatonHash;
+		cp->gcPolicy = src->gcPolicy;
+	}
+	catch (const std::exception& err)
+	{
+		ctx->error = err.what();
+		success = false;
+	}
+	luaL_getmetatable( ls, mewa_compiler_userdata_t::metatableName());
+	lua_setmetatable( ls, -2);
+	if (success && ctx->batch->compiler->lexemMetatableRef != LUA_NOREF)
+	{
+		try
+		{
+			mewa::luaPushCompactLexemMetatable( ls, cp->automaton);
+		}
+		catch (const std::exception& err)
+		{
+			ctx->error = err.what();
+			success = false;
+		}
+		if (success) cp->lexemMetatableRef = luaL_ref( ls, LUA_REGISTRYINDEX);
+	}
+	if (!success)
+	{
+		lua_pushstring( ls, ctx->error.c_str());
+		return lua_error( ls);
+	}
+	lua_setfield( ls, LUA_REGISTRYINDEX, MEWA_BATCH_COMPILER_KEY);
+	ctx->cp = cp;
+	return 0;
+}
+
+// \brief Unload all modules loaded since the initialization of the Lua state of a worker
+static void unloadModules( lua_State* ls)
+{
+	lua_getglobal( ls, "package");
+	lua_getfield( ls, -1, "loaded");					// STK: [PACKAGE] [LOADED]
+	lua_getfield( ls, LUA_REGISTRYINDEX, MEWA_BATCH_MODULES_KEY);		// STK: [PACKAGE] [LOADED] [MODULES]
+	lua_pushnil( ls);
+	while (lua_next( ls, -3))						// STK: [PACKAGE] [LOADED] [MODULES] [KEY] [VAL]
+	{
+		lua_pop( ls, 1);
+		lua_pushvalue( ls, -1);
+		lua_rawget( ls, -3);						// STK: [PACKAGE] [LOADED] [MODULES] [KEY] [ISBASE]
+		bool isBaseModule = !lua_isnil( ls, -1);
+		lua_pop( ls, 1);
+		if (!isBaseModule)
+		{
+			lua_pushvalue( ls, -1);
+			lua_pushnil( ls);
+			lua_rawset( ls, -5);
+		}
+	}
+	lua_pop( ls, 3);
+}
+
+// \brief Push the object of a call defined as reference to a member of the typesystem module (at stack index 'tsidx') or as constant expression
+static void pushCallObject( lua_State* ls, int tsidx, const std::string& arg)
+{
+	if (isConstantArgument( arg))
+	{
+		std::string expr = "return " + arg;
+		if (luaL_loadstring( ls, expr.c_str()))
+		{
+			lua_error( ls);
+		}
+		lua_call( ls, 0, 1);
+	}
+	else
+	{
+		lua_pushvalue( ls, tsidx);
+		char const* si = arg.c_str();
+		char const* sn = std::strchr( si, '.');
+		for (; sn; si = sn+1, sn = std::strchr( si, '.'))
+		{
+			lua_pushlstring( ls, si, sn - si);
+			lua_gettable( ls, -2);
+			lua_replace( ls, -2);
+		}
+		lua_getfield( ls, -1, si);
+		lua_replace( ls, -2);
+	}
+}
+
+// \brief Build the call table of the worker compiler from the calls of the automaton and the members of the typesystem module on top of the stack
+static void buildCallTable( lua_State* ls, const mewa_compiler_userdata_t* cp)
+{
+	int tsidx = lua_gettop( ls);
+	const auto& calls = cp->automaton.calls();
+	lua_createtable( ls, calls.size(), 0);					// STK: [TYPESYSTEM] [CALLTABLE]
+	int cidx = 0;
+	for (auto const& call : calls)
+	{
+		luaL_checkstack( ls, 8, "building the call table");
+		lua_createtable( ls, 0, 3);					// STK: [TYPESYSTEM] [CALLTABLE] [CALL]
+		if (call.argtype() == mewa::Automaton::Call::NoArg)
+		{
+			lua_pushlstring( ls, call.function().c_str(), call.function().size());
+		}
+		else
+		{
+			lua_pushstring( ls, call.function().c_str());
+			lua_pushliteral( ls, " ");
+			lua_pushstring( ls, call.arg().c_str());
+			lua_concat( ls, 3);
+		}
+		lua_setfield( ls, -2, "name");
+		lua_getfield( ls, tsidx, call.function().c_str());
+		lua_setfield( ls, -2, "proc");
+		switch (call.argtype())
+		{
+			case mewa::Automaton::Call::NoArg:
+				break;
+			case mewa::Automaton::Call::StringArg:
+				lua_pushlstring( ls, call.arg().c_str(), call.arg().size());
+				lua_setfield( ls, -2, "obj");
+				break;
+			case mewa::Automaton::Call::ReferenceArg:
+				pushCallObject( ls, tsidx, call.arg());
+				lua_setfield( ls, -2, "obj");
+				break;
+		}
+		lua_rawseti( ls, -2, ++cidx);
+	}
+	lua_setglobal( ls, cp->callTableName.buf);				// STK: [TYPESYSTEM]
+}
+
+// \brief Compile one unit in the Lua state of a worker, called in protected mode with the worker context as light userdata argument
+static int luaRunUnit( lua_State* ls)
+{
+	WorkerContext* ctx = (WorkerContext*)lua_touserdata( ls, 1);
+	mewa_compiler_userdata_t* cp = ctx->cp;
+	const mewa::LuaBatchUnit& unit = (*ctx->batch->units)[ ctx->unitidx];
+	mewa::LuaBatchResult& result = (*ctx->batch->results)[ ctx->unitidx];
+
+	unloadModules( ls);
+	lua_getglobal( ls, "require");
+	lua_pushstring( ls, cp->automaton.typesystem().c_str());
+	lua_call( ls, 1, 1);							// STK: [TYPESYSTEM]
+	buildCallTable( ls, cp);
+	lua_pop( ls, 1);
+
+	cp->outputBuffer.clear();
+	cp->outputSectionMap.clear();
+	cp->outputCapture = unit.output.empty() ? &result.output : nullptr;
+	cp->statisticsCapture = cp->statistics ? &result.statistics : nullptr;
+
+	luaL_getmetatable( ls, mewa_compiler_userdata_t::metatableName());
+	lua_getfield( ls, -1, "run");
+	lua_replace( ls, -2);							// STK: [RUN]
+	lua_getfield( ls, LUA_REGISTRYINDEX, MEWA_BATCH_COMPILER_KEY);		// STK: [RUN] [COMPILER]
+	if (ctx->batch->target->empty())
+	{
+		lua_pushnil( ls);
+	}
+	else
+	{
+		lua_pushstring( ls, ctx->batch->target->c_str());
+	}
+	ctx->batch->options->push( ls);
+	lua_pushstring( ls, unit.input.c_str());
+	if (unit.output.empty()) lua_pushnil( ls); else lua_pushstring( ls, unit.output.c_str());
+	if (unit.dbgout.empty()) lua_pushnil( ls); else lua_pushstring( ls, unit.dbgout.c_str());
+	lua_call( ls, 6, 0);
+	return 0;
+}
+
+static void runWorker( BatchContext* batch)
+{
+	WorkerContext ctx( batch);
+	std::string initError;
+	lua_State* ls = luaL_newstate();
+	if (!ls)
+	{
+		initError = mewa::Error( mewa::Error::MemoryAllocationError).what();
+	}
+	else
+	{
+		lua_pushcfunction( ls, luaInitWorker);
+		lua_pushlightuserdata( ls, &ctx);
+		if (lua_pcall( ls, 1, 0, 0)) initError = popErrorMessage( ls);
+	}
+	std::size_t nofUnits = batch->units->size();
+	for (std::size_t unitidx = batch->nextUnit++; unitidx < nofUnits; unitidx = batch->nextUnit++)
+	{
+		mewa::LuaBatchResult& result = (*batch->results)[ unitidx];
+		try
+		{
+			if (!initError.empty())
+			{
+				result.error = initError;
+				continue;
+			}
+			ctx.unitidx = unitidx;
+			lua_pushcfunction( ls, luaRunUnit);
+			lua_pushlightuserdata( ls, &ctx);
+			if (lua_pcall( ls, 1, 0, 0))
+			{
+				result.error = popErrorMessage( ls);
+				result.output.clear();
+			}
+			else
+			{
+				result.ok = true;
+			}
+			ctx.cp->outputCapture = nullptr;
+			ctx.cp->statisticsCapture = nullptr;
+			ctx.cp->closeOutput();
+			lua_gc( ls, LUA_GCCOLLECT, 0);
+		}
+		catch (const std::exception& err)
+		{
+			result.ok = false;
+			result.error = err.what();
+		}
+	}
+	if (ls) lua_close( ls);
+}
+
+std::vector<mewa::LuaBatchResult> mewa::luaRunBatch(
+		const mewa_compiler_userdata_t& compiler, const LuaBatchEnvironment& env,
+		const std::string& target, const LuaDataCopy& options, const std::vector<LuaBatchUnit>& units, int nofThreads)
+{
+	std::vector<LuaBatchResult> rt( units.size(), LuaBatchResult{false,std::string(),std::string(),LuaCompilerStatistics()});
+	if (units.empty()) return rt;
+	if (compiler.automaton.typesystem().empty())
+	{
+		throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, "typesystem");
+	}
+	if (nofThreads <= 0)
+	{
+		nofThreads = std::max( 1U, std::thread::hardware_concurrency());
+	}
+	nofThreads = std::min( (std::size_t)nofThreads, units.size());
+
+	BatchContext batch;
+	batch.compiler = &compiler;
+	batch.env = &env;
+	batch.target = &target;
+	batch.options = &options;
+	batch.units = &units;
+	batch.results = &rt;
+	batch.nextUnit = 0;
+
+	std::vector<std::thread> workers;
+	workers.reserve( nofThreads);
+	try
+	{
+		for (int ti = 0; ti < nofThreads; ++ti)
+		{
+			workers.emplace_back( runWorker, &batch);
+		}
+	}
+	catch (const std::system_error&)
+	{
+		// ... not all threads could be created, the ones created take over the units of the ones missing
+		if (workers.empty()) throw;
+	}
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	return rt;
+}
+
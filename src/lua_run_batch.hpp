@@ -0,0 +1,90 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Function to run a compiler on a batch of sources with a pool of worker threads, each owning its own Lua state
+/// \file "lua_run_batch.hpp"
+#ifndef _MEWA_LUA_RUN_BATCH_HPP_INCLUDED
+#define _MEWA_LUA_RUN_BATCH_HPP_INCLUDED
+#if __cplusplus >= 201703L
+#include "lua_userdata.hpp"
+#include <string>
+#include <vector>
+extern "C" {
+#include <lua.h>
+}
+
+namespace mewa {
+
+/// \brief Copy of a Lua value that does not depend on a Lua state, used to pass data from one Lua state to another
+/// \note Only nil, booleans, numbers, strings and tables built of these are supported
+struct LuaDataCopy
+{
+	int type;				///< Lua type of the value (LUA_TNIL, LUA_TBOOLEAN, LUA_TNUMBER, LUA_TSTRING or LUA_TTABLE)
+	bool isInteger;				///< true if the value is a number with an integer representation (Lua >= 5.3)
+	lua_Number number;			///< value of a number or boolean
+	std::string string;			///< value of a string
+	std::vector<LuaDataCopy> elements;	///< key/value pairs of a table stored as sequence [key1,value1,key2,value2,...]
+
+	LuaDataCopy()
+		:type(LUA_TNIL),isInteger(false),number(0),string(),elements(){}
+
+	/// \brief Fill the structure with a copy of the value at a Lua stack index
+	/// \param[in] ls Lua state
+	/// \param[in] li Lua stack index of the value to copy
+	void assign( lua_State* ls, int li);
+	/// \brief Push the copy on the stack of a Lua state
+	/// \param[in] ls Lua state
+	void push( lua_State* ls) const;
+};
+
+/// \brief Description of one compilation unit of a batch
+struct LuaBatchUnit
+{
+	std::string input;		///< path of the source file to compile
+	std::string output;		///< path of the output file, empty if the output is returned in the result
+	std::string dbgout;		///< path of the debug output file (or "stdout"/"stderr"), empty if not defined
+};
+
+/// \brief Result of one compilation unit of a batch
+struct LuaBatchResult
+{
+	bool ok;			///< true on success
+	std::string error;		///< error message if the compilation of the unit failed
+	std::string output;		///< output of the compilation if no output file has been specified for the unit
+	LuaCompilerStatistics statistics;///< statistics of the compilation if the compiler is configured with statistics
+};
+
+/// \brief Environment of the Lua states created for the workers of a batch
+struct LuaBatchEnvironment
+{
+	lua_CFunction openlib;		///< function to open the mewa library in a new Lua state (luaopen_mewa)
+	std::string packagePath;	///< value of package.path of the calling Lua state
+	std::string packageCPath;	///< value of package.cpath of the calling Lua state
+};
+
+/// \brief Run a compiler on a batch of sources in parallel
+/// \note Every worker owns a Lua state with its own copy of the automaton and the options of the compiler (except profiling) and loads the typesystem module referenced by the automaton.
+///	The typesystem modules and all other modules loaded during compilation are reloaded for each unit, as typesystem modules keep the state of the compilation in module variables.
+/// \param[in] compiler the compiler of the calling Lua state, the configuration of the workers is copied from it
+/// \param[in] env environment of the Lua states created for the workers
+/// \param[in] target path of the target template file, empty if not defined
+/// \param[in] options options passed to the compiler
+/// \param[in] units list of compilation units
+/// \param[in] nofThreads number of worker threads, 0 if the number of threads is chosen by the system
+/// \return the list of results in the order of the units passed
+std::vector<LuaBatchResult> luaRunBatch(
+		const mewa_compiler_userdata_t& compiler, const LuaBatchEnvironment& env,
+		const std::string& target, const LuaDataCopy& options, const std::vector<LuaBatchUnit>& units, int nofThreads);
+
+} //namespace
+#else
+#error Building mewa requires C++17
+#endif
+#endif
+
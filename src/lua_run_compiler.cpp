@@ -16,6 +16,8 @@
 #include "error.hpp"
 #include "strings.hpp"
 #include "memory_resource.hpp"
+#include "fileio.hpp"
+#include "version.hpp"
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -27,6 +29,10 @@
 #include <limits>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <atomic>
+#include <unistd.h>
 extern "C" {
 #include <lua.h>
 #include <lauxlib.h>
@@ -41,48 +47,6 @@ static std::string getLexemName( const mewa::Lexer& lexer, int terminal)
         return terminal ? lexer.lexemName( terminal) : std::string("$");
 }
 
-static std::string expectedTerminalList( const std::map<mewa::Automaton::ActionKey,mewa::Automaton::Action>& actions, int state, const mewa::Lexer& lexer)
-{
-	std::string rt;
-	auto ai = actions.lower_bound({ state, 0 });
-	int aidx = 0;
-	for (; ai != actions.end() && ai->first.state() == state; ++ai,++aidx)
-	{
-		if (aidx) rt.append(", ");
-		rt.append( getLexemName( lexer, ai->first.terminal()));
-	}
-	return rt;
-}
-
-static std::string stateTransitionInfo( int state, int terminal, const mewa::Lexer& lexer)
-{
-	char buf[ 64];
-	std::snprintf( buf, sizeof(buf), "state %d, token ", state);
-	std::string rt( buf);
-	rt.append( getLexemName( lexer, terminal));
-	return rt;
-}
-
-static std::string tokenString( const mewa::Lexem& lexem, const mewa::Lexer& lexer)
-{
-	std::string rt;
-	if (lexem.id() == 0)
-	{
-		rt.append( "$");
-	}
-	else
-	{
-		rt.append( lexer.lexemName( lexem.id()));
-		if (!lexer.isKeyword( lexem.id()))
-		{
-			rt.append( " = \"");
-			rt.append( lexem.value());
-			rt.append( "\"");
-		}
-	}
-	return rt;
-}
-
 struct State
 {
 	int index;			//< Compiler automaton state index
@@ -160,6 +124,628 @@ static void luaPushLexem( lua_State* ls, const mewa::Lexem& lexem)
 	lua_rawset( ls, -3);									// STK [TABLE]
 }
 
+/// \brief Compact lexem node, userdata with the lexem value stored inline and the lexem name referenced by id
+struct CompactLexem
+{
+	int id;				//< Lexem identifier, index into the table of lexem names of the metatable
+	int line;			//< Line number of the lexem in the source
+	std::size_t valuesize;		//< Size of the lexem value in bytes
+	char value[1];			//< Lexem value (allocated with the size of the value plus one for the terminating 0)
+
+	static std::size_t allocsize( std::size_t valuesize_) noexcept
+	{
+		return sizeof(CompactLexem) + valuesize_;
+	}
+};
+
+static int luaCompactLexemIndex( lua_State* ls)
+{
+	// STK: [LEXEM] [KEY]
+	const CompactLexem* lx = (const CompactLexem*)lua_touserdata( ls, 1);
+	if (lx && lua_type( ls, 2) == LUA_TSTRING)
+	{
+		std::size_t keylen;
+		const char* key = lua_tolstring( ls, 2, &keylen);
+		if (keylen == 4 && 0==std::memcmp( key, "name", 4))
+		{
+			lua_rawgeti( ls, lua_upvalueindex( 1), lx->id);
+			return 1;
+		}
+		else if (keylen == 5 && 0==std::memcmp( key, "value", 5))
+		{
+			lua_pushlstring( ls, lx->value, lx->valuesize);
+			return 1;
+		}
+		else if (keylen == 4 && 0==std::memcmp( key, "line", 4))
+		{
+			lua_pushinteger( ls, lx->line);
+			return 1;
+		}
+	}
+	lua_pushnil( ls);
+	return 1;
+}
+
+static int luaCompactLexemSerialize( lua_State* ls)
+{
+	const CompactLexem* lx = (const CompactLexem*)lua_touserdata( ls, 1);
+	if (!lx) return 0;
+	lua_createtable( ls, 0/*size array*/, 3/*size struct*/);
+	lua_pushliteral( ls, "name");
+	lua_rawgeti( ls, lua_upvalueindex( 1), lx->id);
+	lua_rawset( ls, -3);
+	lua_pushliteral( ls, "value");
+	lua_pushlstring( ls, lx->value, lx->valuesize);
+	lua_rawset( ls, -3);
+	lua_pushliteral( ls, "line");
+	lua_pushinteger( ls, lx->line);
+	lua_rawset( ls, -3);
+	return 1;
+}
+
+static int luaCompactLexemNewIndex( lua_State* ls)
+{
+	return luaL_error( ls, "fields of a compact lexem node are read-only");
+}
+
+static int luaCompactLexemToString( lua_State* ls)
+{
+	const CompactLexem* lx = (const CompactLexem*)lua_touserdata( ls, 1);
+	if (!lx) return 0;
+	lua_pushfstring( ls, "{line = %d, name = \"", lx->line);
+	lua_rawgeti( ls, lua_upvalueindex( 1), lx->id);
+	lua_pushliteral( ls, "\", value = \"");
+	lua_pushlstring( ls, lx->value, lx->valuesize);
+	lua_pushliteral( ls, "\"}");
+	lua_concat( ls, 5);
+	return 1;
+}
+
+void mewa::luaPushCompactLexemMetatable( lua_State* ls, const mewa::Automaton& automaton)
+{
+	int nofTerminals = automaton.lexer().nofTerminals();
+	lua_createtable( ls, 0/*size array*/, 4/*size struct*/);			// STK: [MT]
+	lua_createtable( ls, nofTerminals/*size array*/, 0/*size struct*/);		// STK: [MT] [NAMES]
+	for (int id=1; id <= nofTerminals; ++id)
+	{
+		const std::string& name = automaton.lexer().lexemName( id);
+		lua_pushlstring( ls, name.data(), name.size());				// STK: [MT] [NAMES] [NAME]
+		lua_rawseti( ls, -2, id);						// STK: [MT] [NAMES]
+	}
+	lua_pushliteral( ls, "__index");						// STK: [MT] [NAMES] "__index"
+	lua_pushvalue( ls, -2);								// STK: [MT] [NAMES] "__index" [NAMES]
+	lua_pushcclosure( ls, &luaCompactLexemIndex, 1);				// STK: [MT] [NAMES] "__index" [FUNC]
+	lua_rawset( ls, -4);								// STK: [MT] [NAMES]
+	lua_pushliteral( ls, "__tostring");						// STK: [MT] [NAMES] "__tostring"
+	lua_pushvalue( ls, -2);								// STK: [MT] [NAMES] "__tostring" [NAMES]
+	lua_pushcclosure( ls, &luaCompactLexemToString, 1);				// STK: [MT] [NAMES] "__tostring" [FUNC]
+	lua_rawset( ls, -4);								// STK: [MT] [NAMES]
+	lua_pushliteral( ls, "__serialize");						// STK: [MT] [NAMES] "__serialize"
+	lua_pushvalue( ls, -2);								// STK: [MT] [NAMES] "__serialize" [NAMES]
+	lua_pushcclosure( ls, &luaCompactLexemSerialize, 1);				// STK: [MT] [NAMES] "__serialize" [FUNC]
+	lua_rawset( ls, -4);								// STK: [MT] [NAMES]
+	lua_pop( ls, 1);								// STK: [MT]
+	lua_pushliteral( ls, "__newindex");						// STK: [MT] "__newindex"
+	lua_pushcfunction( ls, &luaCompactLexemNewIndex);				// STK: [MT] "__newindex" [FUNC]
+	lua_rawset( ls, -3);								// STK: [MT]
+}
+
+static void luaPushCompactLexem( lua_State* ls, const mewa::Lexem& lexem, int metatable)
+{
+	std::size_t valuesize = lexem.value().size();
+	CompactLexem* lx = (CompactLexem*)lua_newuserdata( ls, CompactLexem::allocsize( valuesize));	// STK [LEXEM]
+	lx->id = lexem.id();
+	lx->line = lexem.line();
+	lx->valuesize = valuesize;
+	std::memcpy( lx->value, lexem.value().data(), valuesize);
+	lx->value[ valuesize] = 0;
+	lua_pushvalue( ls, metatable);							// STK [LEXEM] [MT]
+	lua_setmetatable( ls, -2);							// STK [LEXEM]
+}
+
+/// \brief Node of an AST built in a C++ arena
+struct ArenaAstNode
+{
+	int call;			//< Index of the call in the call table, 0 for a lexem node
+	int id;				//< Lexem identifier for a lexem node
+	int line;			//< Line number of the node
+	int scopeflag;			//< Scope flag (mewa::Automaton::Action::ScopeFlag) of a call node
+	int start;			//< Scope start for a node with a scope, step for a node without scope
+	int end;			//< Scope end for a node with a scope
+	int idx;			//< Index of the first child in ArenaAst::args or index of the value in ArenaAst::values for a lexem node
+	int size;			//< Number of children or size of the value in bytes for a lexem node
+
+	ArenaAstNode( int call_, int id_, int line_, int scopeflag_, int start_, int end_, int idx_, int size_)
+		:call(call_),id(id_),line(line_),scopeflag(scopeflag_),start(start_),end(end_),idx(idx_),size(size_){}
+};
+
+/// \brief AST built in a C++ arena, owned by a Lua userdata object referenced by the metatable of the views on its nodes
+struct ArenaAst
+{
+	std::vector<ArenaAstNode> nodes;	//< All nodes of the AST
+	std::vector<int> args;			//< Child lists of the nodes, references to nodes
+	std::string values;			//< Values of the lexem nodes
+
+	int pushLexem( const mewa::Lexem& lexem)
+	{
+		int rt = nodes.size();
+		nodes.emplace_back( 0/*call*/, lexem.id(), lexem.line(), 0/*scopeflag*/, 0/*start*/, 0/*end*/, values.size(), lexem.value().size());
+		values.append( lexem.value().data(), lexem.value().size());
+		return rt;
+	}
+	int pushCall( int call, int line, int scopeflag, int start, int end, const int* argar, int argsize)
+	{
+		int rt = nodes.size();
+		nodes.emplace_back( call, 0/*id*/, line, scopeflag, start, end, args.size(), argsize);
+		args.insert( args.end(), argar, argar + argsize);
+		return rt;
+	}
+
+	static const char* metatableName() noexcept {return "mewa.ast";}
+};
+
+/// \brief Header of the binary representation of an AST built in an arena stored in a cache file
+struct ArenaAstCacheHeader
+{
+	char magic[ 8];			//< File type identifier "MEWAAST" with terminating 0
+	std::uint32_t version;		//< Version of mewa that wrote the file
+	std::uint32_t nodesize;		//< Size of an ArenaAstNode in bytes
+	std::uint64_t key;		//< Hash of the source and the automaton
+	std::uint32_t nofNodes;		//< Number of elements in ArenaAst::nodes
+	std::uint32_t nofArgs;		//< Number of elements in ArenaAst::args
+	std::uint32_t nofTopNodes;	//< Number of top level nodes
+	std::uint32_t valuesSize;	//< Size of ArenaAst::values in bytes
+
+	static const char* magicString() noexcept {return "MEWAAST";}
+	static std::uint32_t currentVersion() noexcept {return MEWA_VERSION_NUMBER * 100 + MEWA_PATCH_VERSION;}
+};
+
+/// \brief Write the AST built in an arena to a cache file, followed by the list of its top level nodes
+/// \note The file is written to a temporary file and then renamed, failures are ignored as the cache is an optimization only
+static void writeArenaAstCache( const char* filename, std::uint64_t key, const ArenaAst& ast, const std::vector<int>& topNodes)
+{
+	ArenaAstCacheHeader hdr;
+	std::memset( &hdr, 0, sizeof(hdr));
+	std::memcpy( hdr.magic, ArenaAstCacheHeader::magicString(), std::strlen( ArenaAstCacheHeader::magicString())+1);
+	hdr.version = ArenaAstCacheHeader::currentVersion();
+	hdr.nodesize = sizeof(ArenaAstNode);
+	hdr.key = key;
+	hdr.nofNodes = ast.nodes.size();
+	hdr.nofArgs = ast.args.size();
+	hdr.nofTopNodes = topNodes.size();
+	hdr.valuesSize = ast.values.size();
+
+	std::string content;
+	content.reserve( sizeof(hdr) + ast.nodes.size() * sizeof(ArenaAstNode) + (ast.args.size() + topNodes.size()) * sizeof(int) + ast.values.size());
+	content.append( (const char*)&hdr, sizeof(hdr));
+	content.append( (const char*)ast.nodes.data(), ast.nodes.size() * sizeof(ArenaAstNode));
+	content.append( (const char*)ast.args.data(), ast.args.size() * sizeof(int));
+	content.append( (const char*)topNodes.data(), topNodes.size() * sizeof(int));
+	content.append( ast.values);
+
+	// ... the name of the temporary file is unique for concurrent writers of the same cache file in other processes and in batch workers of this process
+	static std::atomic<unsigned long> tmpfileCounter( 0);
+	std::string tmpfilename = mewa::string_format( "%s.%ld.%lu.tmp", filename, (long)::getpid(), tmpfileCounter++);
+	try
+	{
+		mewa::writeFile( tmpfilename, content);
+		if (0 != std::rename( tmpfilename.c_str(), filename))
+		{
+			std::remove( tmpfilename.c_str());
+		}
+	}
+	catch (...)
+	{
+		std::remove( tmpfilename.c_str());
+	}
+}
+
+/// \brief Read the AST built in an arena from a cache file
+/// \return true on success, false if the file does not exist or is not a valid cache file for the key, the automaton and the call table
+static bool readArenaAstCache( const char* filename, std::uint64_t key, const mewa::Automaton& automaton, int calltablesize, ArenaAst& ast, std::vector<int>& topNodes)
+{
+	std::string content;
+	try
+	{
+		content = mewa::readFile( filename);
+	}
+	catch (...)
+	{
+		return false;
+	}
+	ArenaAstCacheHeader hdr;
+	if (content.size() < sizeof(hdr)) return false;
+	std::memcpy( &hdr, content.data(), sizeof(hdr));
+	if (0!=std::memcmp( hdr.magic, ArenaAstCacheHeader::magicString(), std::strlen( ArenaAstCacheHeader::magicString())+1)
+		|| hdr.version != ArenaAstCacheHeader::currentVersion() || hdr.nodesize != sizeof(ArenaAstNode) || hdr.key != key)
+	{
+		return false;
+	}
+	std::size_t expectedSize = sizeof(hdr) + (std::size_t)hdr.nofNodes * sizeof(ArenaAstNode)
+					+ ((std::size_t)hdr.nofArgs + hdr.nofTopNodes) * sizeof(int) + hdr.valuesSize;
+	if (content.size() != expectedSize) return false;
+
+	// ... decoded into local containers first, the AST and the stack of top level nodes are only filled if the cache file is valid
+	const char* ptr = content.data() + sizeof(hdr);
+	std::vector<ArenaAstNode> nodes( hdr.nofNodes, ArenaAstNode( 0, 0, 0, 0, 0, 0, 0, 0));
+	std::memcpy( (void*)nodes.data(), ptr, hdr.nofNodes * sizeof(ArenaAstNode));
+	ptr += hdr.nofNodes * sizeof(ArenaAstNode);
+	std::vector<int> args( hdr.nofArgs);
+	std::memcpy( args.data(), ptr, hdr.nofArgs * sizeof(int));
+	ptr += hdr.nofArgs * sizeof(int);
+	std::vector<int> tops( hdr.nofTopNodes);
+	std::memcpy( tops.data(), ptr, hdr.nofTopNodes * sizeof(int));
+	ptr += hdr.nofTopNodes * sizeof(int);
+	std::string values( ptr, hdr.valuesSize);
+
+	// Verify the references, children are always defined before their parents:
+	int nofTerminals = automaton.lexer().nofTerminals();
+	for (std::size_t ni = 0; ni < nodes.size(); ++ni)
+	{
+		const ArenaAstNode& nd = nodes[ ni];
+		if (nd.idx < 0 || nd.size < 0) return false;
+		if (nd.call)
+		{
+			if (nd.call < 0 || nd.call > calltablesize || (std::size_t)nd.idx + nd.size > args.size()) return false;
+			for (int ai = 0; ai < nd.size; ++ai)
+			{
+				int child = args[ nd.idx + ai];
+				if (child < 0 || (std::size_t)child >= ni) return false;
+			}
+		}
+		else if (nd.id <= 0 || nd.id > nofTerminals || (std::size_t)nd.idx + nd.size > values.size())
+		{
+			return false;
+		}
+	}
+	for (int node : tops)
+	{
+		if (node < 0 || (std::size_t)node >= nodes.size()) return false;
+	}
+	ast.nodes = std::move( nodes);
+	ast.args = std::move( args);
+	ast.values = std::move( values);
+	topNodes = std::move( tops);
+	return true;
+}
+
+static int luaDestroyArenaAst( lua_State* ls)
+{
+	ArenaAst* ast = (ArenaAst*)lua_touserdata( ls, 1);
+	if (ast) ast->~ArenaAst();
+	return 0;
+}
+
+static ArenaAst* luaPushArenaAst( lua_State* ls)
+{
+	ArenaAst* rt = (ArenaAst*)lua_newuserdata( ls, sizeof(ArenaAst));		// STK: [AST]
+	new (rt) ArenaAst();
+	if (luaL_newmetatable( ls, ArenaAst::metatableName()))				// STK: [AST] [MT]
+	{
+		lua_pushliteral( ls, "__gc");						// STK: [AST] [MT] "__gc"
+		lua_pushcfunction( ls, &luaDestroyArenaAst);				// STK: [AST] [MT] "__gc" [FUNC]
+		lua_rawset( ls, -3);							// STK: [AST] [MT]
+	}
+	lua_setmetatable( ls, -2);							// STK: [AST]
+	return rt;
+}
+
+/// \brief View on a node of an AST built in an arena, the fields are materialized on access and stored in the user value of the view
+struct ArenaAstView
+{
+	int node;			//< Index of the node in ArenaAst::nodes
+};
+
+// Upvalues of the metamethods of AST views:
+#define ARENA_AST_UPVALUE_AST 		1	//< Arena with the AST
+#define ARENA_AST_UPVALUE_CALLTABLE 	2	//< Table with the call descriptions
+#define ARENA_AST_UPVALUE_NAMES 	3	//< Table with the lexem names
+#define ARENA_AST_UPVALUE_NOSTORAGE	4	//< Empty table marking a view without storage of materialized fields (Lua 5.1 only)
+
+static void luaPushArenaAstView( lua_State* ls, int node, int metatable, [[maybe_unused]] int nostorage)
+{
+#if LUA_VERSION_NUM >= 504
+	ArenaAstView* view = (ArenaAstView*)lua_newuserdatauv( ls, sizeof(ArenaAstView), 1);	// STK: [VIEW]
+#else
+	ArenaAstView* view = (ArenaAstView*)lua_newuserdata( ls, sizeof(ArenaAstView));	// STK: [VIEW]
+#endif
+	view->node = node;
+	lua_pushvalue( ls, metatable);							// STK: [VIEW] [MT]
+	lua_setmetatable( ls, -2);							// STK: [VIEW]
+#if !defined LUA_VERSION_NUM || LUA_VERSION_NUM==501
+	lua_pushvalue( ls, nostorage);							// STK: [VIEW] [NOSTORAGE]
+	lua_setfenv( ls, -2);								// STK: [VIEW]
+#endif
+}
+
+/// \brief Push the table with the materialized fields of a view if it exists
+/// \return true if the table has been pushed, false if nothing has been pushed
+static bool luaPushArenaAstViewStorage( lua_State* ls, int li)
+{
+#if LUA_VERSION_NUM >= 504
+	if (lua_getiuservalue( ls, li, 1) == LUA_TTABLE) return true;
+#elif LUA_VERSION_NUM >= 502
+	lua_getuservalue( ls, li);
+	if (lua_istable( ls, -1)) return true;
+#else
+	lua_getfenv( ls, li);
+	if (lua_istable( ls, -1) && !lua_rawequal( ls, -1, lua_upvalueindex( ARENA_AST_UPVALUE_NOSTORAGE))) return true;
+#endif
+	lua_pop( ls, 1);
+	return false;
+}
+
+/// \brief Push the table with the materialized fields of a view, create it if it does not exist yet
+static void luaPushArenaAstViewStorageCreate( lua_State* ls, int li)
+{
+	if (!luaPushArenaAstViewStorage( ls, li))
+	{
+		lua_createtable( ls, 0/*size array*/, 2/*size struct*/);			// STK: [STORAGE]
+		lua_pushvalue( ls, -1);							// STK: [STORAGE] [STORAGE]
+#if LUA_VERSION_NUM >= 504
+		lua_setiuservalue( ls, li, 1);						// STK: [STORAGE]
+#elif LUA_VERSION_NUM >= 502
+		lua_setuservalue( ls, li);						// STK: [STORAGE]
+#else
+		lua_setfenv( ls, li);							// STK: [STORAGE]
+#endif
+	}
+}
+
+/// \brief Push the value of a field of a node view, materialize it if not done yet
+/// \return true if a value has been pushed, false if the node has no such field and nothing has been pushed
+static bool luaPushArenaAstViewField( lua_State* ls, int li, const char* key, std::size_t keylen)
+{
+	const ArenaAstView* view = (const ArenaAstView*)lua_touserdata( ls, li);
+	const ArenaAst* ast = (const ArenaAst*)lua_touserdata( ls, lua_upvalueindex( ARENA_AST_UPVALUE_AST));
+	if (!view || !ast) return false;
+	const ArenaAstNode& nd = ast->nodes[ view->node];
+
+	if (nd.call)
+	{
+		if (keylen == 4 && 0==std::memcmp( key, "call", 4))
+		{
+			lua_rawgeti( ls, lua_upvalueindex( ARENA_AST_UPVALUE_CALLTABLE), nd.call);
+			return true;
+		}
+		else if (keylen == 4 && 0==std::memcmp( key, "line", 4))
+		{
+			lua_pushinteger( ls, nd.line);
+			return true;
+		}
+		else if (keylen == 4 && 0==std::memcmp( key, "step", 4))
+		{
+			if (nd.scopeflag == mewa::Automaton::Action::Scope) return false;
+			lua_pushinteger( ls, nd.start);
+			return true;
+		}
+		else if (keylen == 5 && 0==std::memcmp( key, "scope", 5))
+		{
+			if (nd.scopeflag != mewa::Automaton::Action::Scope) return false;
+			luaPushArenaAstViewStorageCreate( ls, li);				// STK: [STORAGE]
+			lua_pushliteral( ls, "scope");						// STK: [STORAGE] "scope"
+			lua_createtable( ls, 2/*size array*/, 0/*size struct*/);		// STK: [STORAGE] "scope" [SCOPE]
+			lua_pushinteger( ls, nd.start);						// STK: [STORAGE] "scope" [SCOPE] [START]
+			lua_rawseti( ls, -2, 1);						// STK: [STORAGE] "scope" [SCOPE]
+			lua_pushinteger( ls, nd.end);						// STK: [STORAGE] "scope" [SCOPE] [END]
+			lua_rawseti( ls, -2, 2);						// STK: [STORAGE] "scope" [SCOPE]
+			lua_pushvalue( ls, -1);							// STK: [STORAGE] "scope" [SCOPE] [SCOPE]
+			lua_insert( ls, -4);							// STK: [SCOPE] [STORAGE] "scope" [SCOPE]
+			lua_rawset( ls, -3);							// STK: [SCOPE] [STORAGE]
+			lua_pop( ls, 1);							// STK: [SCOPE]
+			return true;
+		}
+		else if (keylen == 3 && 0==std::memcmp( key, "arg", 3))
+		{
+			luaPushArenaAstViewStorageCreate( ls, li);				// STK: [STORAGE]
+			lua_pushliteral( ls, "arg");						// STK: [STORAGE] "arg"
+			lua_createtable( ls, nd.size/*size array*/, 0/*size struct*/);		// STK: [STORAGE] "arg" [ARG]
+			lua_getmetatable( ls, li);						// STK: [STORAGE] "arg" [ARG] [MT]
+			int metatable = lua_gettop( ls);
+			for (int ai=0; ai < nd.size; ++ai)
+			{
+				luaPushArenaAstView( ls, ast->args[ nd.idx + ai], metatable, lua_upvalueindex( ARENA_AST_UPVALUE_NOSTORAGE));
+												// STK: [STORAGE] "arg" [ARG] [MT] [VIEW]
+				lua_rawseti( ls, -3, ai+1);					// STK: [STORAGE] "arg" [ARG] [MT]
+			}
+			lua_pop( ls, 1);							// STK: [STORAGE] "arg" [ARG]
+			lua_pushvalue( ls, -1);							// STK: [STORAGE] "arg" [ARG] [ARG]
+			lua_insert( ls, -4);							// STK: [ARG] [STORAGE] "arg" [ARG]
+			lua_rawset( ls, -3);							// STK: [ARG] [STORAGE]
+			lua_pop( ls, 1);							// STK: [ARG]
+			return true;
+		}
+	}
+	else
+	{
+		if (keylen == 4 && 0==std::memcmp( key, "name", 4))
+		{
+			lua_rawgeti( ls, lua_upvalueindex( ARENA_AST_UPVALUE_NAMES), nd.id);
+			return true;
+		}
+		else if (keylen == 5 && 0==std::memcmp( key, "value", 5))
+		{
+			lua_pushlstring( ls, ast->values.data() + nd.idx, nd.size);
+			return true;
+		}
+		else if (keylen == 4 && 0==std::memcmp( key, "line", 4))
+		{
+			lua_pushinteger( ls, nd.line);
+			return true;
+		}
+	}
+	return false;
+}
+
+static int luaArenaAstViewIndex( lua_State* ls)
+{
+	// STK: [VIEW] [KEY]
+	if (luaPushArenaAstViewStorage( ls, 1))						// STK: [VIEW] [KEY] [STORAGE]
+	{
+		lua_pushvalue( ls, 2);							// STK: [VIEW] [KEY] [STORAGE] [KEY]
+		lua_rawget( ls, -2);							// STK: [VIEW] [KEY] [STORAGE] [VALUE]
+		if (!lua_isnil( ls, -1)) return 1;
+		lua_pop( ls, 2);							// STK: [VIEW] [KEY]
+	}
+	if (lua_type( ls, 2) == LUA_TSTRING)
+	{
+		std::size_t keylen;
+		const char* key = lua_tolstring( ls, 2, &keylen);
+		if (luaPushArenaAstViewField( ls, 1, key, keylen)) return 1;
+	}
+	lua_pushnil( ls);
+	return 1;
+}
+
+static int luaArenaAstViewNewIndex( lua_State* ls)
+{
+	// STK: [VIEW] [KEY] [VALUE]
+	luaPushArenaAstViewStorageCreate( ls, 1);					// STK: [VIEW] [KEY] [VALUE] [STORAGE]
+	lua_insert( ls, 2);								// STK: [VIEW] [STORAGE] [KEY] [VALUE]
+	lua_rawset( ls, 2);								// STK: [VIEW] [STORAGE]
+	return 0;
+}
+
+static int luaArenaAstViewSerialize( lua_State* ls)
+{
+	// STK: [VIEW]
+	static const char* fieldnames[] = {"call","line","step","scope","arg","name","value",nullptr};
+	lua_createtable( ls, 0/*size array*/, 4/*size struct*/);			// STK: [VIEW] [TABLE]
+	if (luaPushArenaAstViewStorage( ls, 1))						// STK: [VIEW] [TABLE] [STORAGE]
+	{
+		lua_pushnil( ls);							// STK: [VIEW] [TABLE] [STORAGE] [NIL]
+		while (lua_next( ls, -2))						// STK: [VIEW] [TABLE] [STORAGE] [KEY] [VALUE]
+		{
+			lua_pushvalue( ls, -2);						// STK: [VIEW] [TABLE] [STORAGE] [KEY] [VALUE] [KEY]
+			lua_insert( ls, -2);						// STK: [VIEW] [TABLE] [STORAGE] [KEY] [KEY] [VALUE]
+			lua_rawset( ls, -5);						// STK: [VIEW] [TABLE] [STORAGE] [KEY]
+		}
+		lua_pop( ls, 1);							// STK: [VIEW] [TABLE]
+	}
+	for (int fi=0; fieldnames[fi]; ++fi)
+	{
+		lua_getfield( ls, -1, fieldnames[fi]);					// STK: [VIEW] [TABLE] [VALUE]
+		bool materialized = !lua_isnil( ls, -1);
+		lua_pop( ls, 1);							// STK: [VIEW] [TABLE]
+		if (!materialized && luaPushArenaAstViewField( ls, 1, fieldnames[fi], std::strlen( fieldnames[fi])))
+		{										// STK: [VIEW] [TABLE] [VALUE]
+			lua_setfield( ls, -2, fieldnames[fi]);				// STK: [VIEW] [TABLE]
+		}
+	}
+	return 1;
+}
+
+/// \brief Push the metatable of the views on the nodes of an AST built in an arena
+/// \param[in] ls Lua state
+/// \param[in] automaton automaton with the lexer defining the names of the lexems
+/// \param[in] ast Lua stack index of the arena with the AST
+/// \param[in] calltable Lua stack index of the call table
+static void luaPushArenaAstViewMetatable( lua_State* ls, const mewa::Automaton& automaton, int ast, int calltable)
+{
+	static const char* methodnames[] = {"__index","__newindex","__serialize",nullptr};
+	static const lua_CFunction methods[] = {&luaArenaAstViewIndex, &luaArenaAstViewNewIndex, &luaArenaAstViewSerialize, nullptr};
+
+	int nofTerminals = automaton.lexer().nofTerminals();
+	lua_createtable( ls, 0/*size array*/, 3/*size struct*/);			// STK: [MT]
+	for (int mi=0; methodnames[mi]; ++mi)
+	{
+		lua_pushvalue( ls, ast);						// STK: [MT] [AST]
+		lua_pushvalue( ls, calltable);						// STK: [MT] [AST] [CALLTABLE]
+		if (mi == 0)
+		{
+			lua_createtable( ls, nofTerminals/*size array*/, 0/*size struct*/);	// STK: [MT] [AST] [CALLTABLE] [NAMES]
+			for (int id=1; id <= nofTerminals; ++id)
+			{
+				const std::string& name = automaton.lexer().lexemName( id);
+				lua_pushlstring( ls, name.data(), name.size());		// STK: [MT] [AST] [CALLTABLE] [NAMES] [NAME]
+				lua_rawseti( ls, -2, id);					// STK: [MT] [AST] [CALLTABLE] [NAMES]
+			}
+			lua_createtable( ls, 0/*size array*/, 0/*size struct*/);		// STK: [MT] [AST] [CALLTABLE] [NAMES] [NOSTORAGE]
+		}
+		else
+		{
+			lua_getfield( ls, -3, methodnames[0]);				// STK: [MT] [AST] [CALLTABLE] [INDEX]
+			lua_getupvalue( ls, -1, ARENA_AST_UPVALUE_NAMES);		// STK: [MT] [AST] [CALLTABLE] [INDEX] [NAMES]
+			lua_getupvalue( ls, -2, ARENA_AST_UPVALUE_NOSTORAGE);		// STK: [MT] [AST] [CALLTABLE] [INDEX] [NAMES] [NOSTORAGE]
+			lua_remove( ls, -3);						// STK: [MT] [AST] [CALLTABLE] [NAMES] [NOSTORAGE]
+		}
+		lua_pushcclosure( ls, methods[mi], 4);					// STK: [MT] [FUNC]
+		lua_setfield( ls, -2, methodnames[mi]);					// STK: [MT]
+	}
+}
+
+/// \brief Push the nodes of an AST built in an arena as tables, structured as the nodes created by the compiler for an AST built on the Lua stack
+/// \note The nodes are created in the order of the arena, the children of a node are always created before the node
+/// \param[in] ls Lua state
+/// \param[in] ast AST built in an arena
+/// \param[in] topNodes top level nodes of the AST to push on the stack
+/// \param[in] automaton automaton with the lexer defining the names of the lexems
+/// \param[in] calltable Lua stack index of the call table
+/// \param[in] lexemMetatable Lua stack index of the metatable for compact lexem nodes, 0 if lexem nodes are represented as tables
+static void luaPushArenaAstTables( lua_State* ls, const ArenaAst& ast, const std::vector<int>& topNodes, const mewa::Automaton& automaton, int calltable, int lexemMetatable)
+{
+	if (!lua_checkstack( ls, topNodes.size() + 8)) throw mewa::Error( mewa::Error::LuaStackOutOfMemory);
+	lua_createtable( ls, ast.nodes.size()/*size array*/, 0/*size struct*/);			// STK: [NODES]
+	int nodetable = lua_gettop( ls);
+	for (std::size_t ni = 0; ni < ast.nodes.size(); ++ni)
+	{
+		const ArenaAstNode& nd = ast.nodes[ ni];
+		if (nd.call)
+		{
+			int structsize = nd.scopeflag == mewa::Automaton::Action::NoScope ? 3:4;
+			lua_createtable( ls, 0/*size array*/, structsize+1/*one reserved for free use*/);	// STK: [NODES] [TABLE]
+			lua_pushliteral( ls, "call");							// STK: [NODES] [TABLE] "call"
+			lua_rawgeti( ls, calltable, nd.call);						// STK: [NODES] [TABLE] "call" [CALLSTRUCT]
+			lua_rawset( ls, -3);								// STK: [NODES] [TABLE]
+			lua_pushliteral( ls, "line");							// STK: [NODES] [TABLE] "line"
+			lua_pushinteger( ls, nd.line);							// STK: [NODES] [TABLE] "line" [LINE]
+			lua_rawset( ls, -3);								// STK: [NODES] [TABLE]
+			if (nd.scopeflag == mewa::Automaton::Action::Scope)
+			{
+				lua_pushliteral( ls, "scope");						// STK: [NODES] [TABLE] "scope"
+				lua_createtable( ls, 0/*size array*/, structsize);			// STK: [NODES] [TABLE] "scope" [SCOPE]
+				lua_pushinteger( ls, nd.start);						// STK: [NODES] [TABLE] "scope" [SCOPE] [START]
+				lua_rawseti( ls, -2, 1);						// STK: [NODES] [TABLE] "scope" [SCOPE]
+				lua_pushinteger( ls, nd.end);						// STK: [NODES] [TABLE] "scope" [SCOPE] [END]
+				lua_rawseti( ls, -2, 2);						// STK: [NODES] [TABLE] "scope" [SCOPE]
+				lua_rawset( ls, -3);							// STK: [NODES] [TABLE]
+			}
+			else
+			{
+				lua_pushliteral( ls, "step");						// STK: [NODES] [TABLE] "step"
+				lua_pushinteger( ls, nd.start);						// STK: [NODES] [TABLE] "step" [STEP]
+				lua_rawset( ls, -3);							// STK: [NODES] [TABLE]
+			}
+			lua_pushliteral( ls, "arg");							// STK: [NODES] [TABLE] "arg"
+			lua_createtable( ls, nd.size/*size array*/, 0/*size struct*/);			// STK: [NODES] [TABLE] "arg" [ARGTAB]
+			for (int ai = 0; ai < nd.size; ++ai)
+			{
+				lua_rawgeti( ls, nodetable, ast.args[ nd.idx + ai] + 1);		// STK: [NODES] [TABLE] "arg" [ARGTAB] [ARGi]
+				lua_rawseti( ls, -2, ai+1);						// STK: [NODES] [TABLE] "arg" [ARGTAB]
+			}
+			lua_rawset( ls, -3);								// STK: [NODES] [TABLE]
+		}
+		else
+		{
+			mewa::Lexem lexem( automaton.lexer().lexemName( nd.id), nd.id, std::string_view( ast.values.data() + nd.idx, nd.size), nd.line);
+			if (lexemMetatable)
+			{
+				luaPushCompactLexem( ls, lexem, lexemMetatable);			// STK: [NODES] [LEXEM]
+			}
+			else
+			{
+				luaPushLexem( ls, lexem);						// STK: [NODES] [LEXEM]
+			}
+		}
+		lua_rawseti( ls, nodetable, ni+1);							// STK: [NODES]
+	}
+	for (int node : topNodes)
+	{
+		lua_rawgeti( ls, nodetable, node+1);							// STK: [NODES] [NODE]..
+	}
+	lua_remove( ls, nodetable);									// STK: [NODE]..
+}
+
 struct CompilerContext
 {
 	std::pmr::vector<State> stateStack;		//< Compiler automaton state stack
@@ -168,9 +754,13 @@ struct CompilerContext
 	int scopestep;					//< Counter for step and scope structure
 	int line;					//< Line number of last lexem pushed
 	FILE* dbgout;					//< Debug output or NULL if undefined
+	int lexemMetatable;				//< Lua stack address of the metatable for compact lexem nodes or 0 if lexems are pushed as tables
+	ArenaAst* ast;					//< AST built in an arena or NULL if the AST is built on the Lua stack
+	std::vector<int> astStack;			//< Stack of AST nodes in the arena replacing the Lua stack if the AST is built in an arena
+	long nofReductions;				//< Number of reductions
 
-	CompilerContext( std::pmr::memory_resource* memrsc, std::size_t buffersize, int calltable_, int calltablesize_, FILE* dbgout_)
-		:stateStack(memrsc),calltable(calltable_),calltablesize(calltablesize_),scopestep(0),line(0),dbgout(dbgout_)
+	CompilerContext( std::pmr::memory_resource* memrsc, std::size_t buffersize, int calltable_, int calltablesize_, FILE* dbgout_, int lexemMetatable_, ArenaAst* ast_)
+		:stateStack(memrsc),calltable(calltable_),calltablesize(calltablesize_),scopestep(0),line(0),dbgout(dbgout_),lexemMetatable(lexemMetatable_),ast(ast_),astStack(),nofReductions(0)
 	{
 		stateStack.reserve( (buffersize - sizeof stateStack) / sizeof(State));
 		stateStack.push_back( State( 1/*index*/, 0/*luastki*/, 0/*luastkn*/, 0/*scopecnt*/) );
@@ -273,6 +863,33 @@ static void luaReduceStruct(
 	}
 }
 
+static void arenaReduceStruct( 
+		CompilerContext& ctx, int reductionSize,
+		int callidx, const mewa::Automaton::Action::ScopeFlag scopeflag, int scopeStart)
+{
+	int nofStackElements = getLuaStackReductionSize( ctx.stateStack, reductionSize);
+	int start = 0;
+	int end = 0;
+	switch (scopeflag)
+	{
+		case mewa::Automaton::Action::Step:
+			ctx.scopestep += 1;
+			/*no break here!*/
+		case mewa::Automaton::Action::NoScope:
+			start = ctx.scopestep;
+			break;
+		case mewa::Automaton::Action::Scope:
+			ctx.scopestep += 1;
+			start = scopeStart;
+			end = ctx.scopestep;
+			break;
+	}
+	const int* argar = ctx.astStack.data() + ctx.astStack.size() - nofStackElements;
+	int node = ctx.ast->pushCall( callidx, ctx.line, scopeflag, start, end, argar, nofStackElements);
+	ctx.astStack.resize( ctx.astStack.size() - nofStackElements);
+	ctx.astStack.push_back( node);
+}
+
 static mewa::Error::Code luaErrorCode2ErrorCode( int rc)
 {
 	switch (rc)
@@ -331,7 +948,7 @@ static int lua_pcall_errorhandler( lua_State* ls)
 
 static void luaCallNodeFunction( lua_State* ls, int li, int calltable, FILE* dbgout, int options_index)
 {
-	if (!lua_istable( ls, li)) throw mewa::Error( mewa::Error::BadElementOnCompilerStack, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
+	if (!lua_istable( ls, li) && !lua_isuserdata( ls, li)) throw mewa::Error( mewa::Error::BadElementOnCompilerStack, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
 	lua_pushcfunction( ls, &lua_pcall_errorhandler);		// STK: [EHND] 
 	lua_pushvalue( ls, li);						// STK: [EHND] [NODE]
 	lua_pushliteral( ls, "call");					// STK: [EHND] [NODE] "call"
@@ -341,7 +958,7 @@ static void luaCallNodeFunction( lua_State* ls, int li, int calltable, FILE* dbg
 	{
 		lua_pop( ls, 1);					// STK: [EHND] [NODE]
 		lua_pushliteral( ls, "name");				// STK: [EHND] [NODE] "name"
-		lua_rawget( ls, -2);					// STK: [EHND] [NODE] [NAME]
+		lua_gettable( ls, -2);					// STK: [EHND] [NODE] [NAME]
 		if (lua_type( ls, -1) != LUA_TSTRING)
 		{
 			throw mewa::Error( mewa::Error::BadElementOnCompilerStack, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
@@ -349,7 +966,7 @@ static void luaCallNodeFunction( lua_State* ls, int li, int calltable, FILE* dbg
 		std::string namestr( lua_tostring( ls, -1));
 		lua_pop( ls, 1);					// STK: [EHND] [NODE]
 		lua_pushliteral( ls, "value");				// STK: [EHND] [NODE] "value"
-		lua_rawget( ls, -2);					// STK: [EHND] [NODE] [VALUE]
+		lua_gettable( ls, -2);					// STK: [EHND] [NODE] [VALUE]
 		if (lua_type( ls, -1) != LUA_TSTRING)
 		{
 			throw mewa::Error( mewa::Error::BadElementOnCompilerStack, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
@@ -419,8 +1036,8 @@ static bool feedLexem( lua_State* ls, CompilerContext& ctx, const mewa::Automato
 	auto nexti = automaton.actions().find( {ctx.stateStack.back().index, lexem.id()/*terminal*/});
 	if (nexti == automaton.actions().end())
 	{
-		throw mewa::Error( mewa::Error::UnexpectedTokenNotOneOf, tokenString( lexem, automaton.lexer()) + " { "
-				   + expectedTerminalList( automaton.actions(), ctx.stateStack.back().index, automaton.lexer()) + " }", lexem.line());
+		throw mewa::Error( mewa::Error::UnexpectedTokenNotOneOf, automaton.tokenString( lexem) + " { "
+				   + automaton.expectedTerminalList( ctx.stateStack.back().index) + " }", lexem.line());
 	}
 	switch (nexti->second.type())
 	{
@@ -429,7 +1046,18 @@ static bool feedLexem( lua_State* ls, CompilerContext& ctx, const mewa::Automato
 			{
 				int next_luastki = getNextLuaStackIndex( ctx.stateStack);
 				ctx.stateStack.push_back( State( nexti->second.state(), next_luastki, 1, ctx.scopestep));
-				luaPushLexem( ls, lexem);
+				if (ctx.ast)
+				{
+					ctx.astStack.push_back( ctx.ast->pushLexem( lexem));
+				}
+				else if (ctx.lexemMetatable)
+				{
+					luaPushCompactLexem( ls, lexem, ctx.lexemMetatable);
+				}
+				else
+				{
+					luaPushLexem( ls, lexem);
+				}
 				ctx.line = lexem.line();
 			}
 			else
@@ -447,12 +1075,20 @@ static bool feedLexem( lua_State* ls, CompilerContext& ctx, const mewa::Automato
 				throw mewa::Error( mewa::Error::LanguageAutomatonCorrupted, lexem.line());
 			}
 			int luaStackNofElements;
+			++ctx.nofReductions;
 			int scopeStart = reductionSize == 0 ? ctx.scopestep : ctx.stateStack[ ctx.stateStack.size() - reductionSize].scopecnt;
 
 			if (nexti->second.call())
 			{
 				int callidx = nexti->second.call();
-				luaReduceStruct( ls, ctx, reductionSize, callidx, nexti->second.scopeflag(), scopeStart);
+				if (ctx.ast)
+				{
+					arenaReduceStruct( ctx, reductionSize, callidx, nexti->second.scopeflag(), scopeStart);
+				}
+				else
+				{
+					luaReduceStruct( ls, ctx, reductionSize, callidx, nexti->second.scopeflag(), scopeStart);
+				}
 				luaStackNofElements = 1;
 			}
 			else
@@ -480,7 +1116,7 @@ static bool feedLexem( lua_State* ls, CompilerContext& ctx, const mewa::Automato
 				auto gtoi = automaton.gotos().find( {ctx.stateStack.back().index, nexti->second.nonterminal()});
 				if (gtoi == automaton.gotos().end())
 				{
-					auto info = stateTransitionInfo( ctx.stateStack.back().index, lexem.id()/*terminal*/, automaton.lexer());
+					auto info = automaton.stateTransitionInfo( ctx.stateStack.back().index, lexem.id()/*terminal*/);
 					throw mewa::Error( mewa::Error::LanguageAutomatonMissingGoto, info, lexem.line());
 				}
 				else if (luaStackNofElements)
@@ -578,11 +1214,124 @@ static void printDebugAction( FILE* dbgout, CompilerContext& ctx, const mewa::Au
 	}
 }
 
-void mewa::luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, const std::string_view& source, const char* calltable, FILE* dbgout)
+/// \brief Applies the modes of a garbage collector policy and restores the state of the garbage collector saved when destroyed
+class LuaGcPolicyScope
+{
+public:
+	LuaGcPolicyScope( lua_State* ls_, const mewa::LuaGcPolicy& policy_)
+		:m_ls(ls_),m_policy(policy_),m_running(true),m_generational(false),m_pause(-1),m_stepmul(-1)
+	{
+		if (m_policy.defined())
+		{
+#if LUA_VERSION_NUM >= 502
+			m_running = lua_gc( m_ls, LUA_GCISRUNNING, 0);
+#endif
+#if LUA_VERSION_NUM >= 504
+			m_generational = (LUA_GCGEN == lua_gc( m_ls, LUA_GCINC, 0, 0, 0));
+			if (m_generational) lua_gc( m_ls, LUA_GCGEN, 0, 0);
+#endif
+		}
+	}
+	~LuaGcPolicyScope()
+	{
+		restore();
+	}
+
+	void apply( mewa::LuaGcPolicy::Mode mode) noexcept
+	{
+		switch (mode)
+		{
+			case mewa::LuaGcPolicy::GcDefault:
+				restore();
+				break;
+			case mewa::LuaGcPolicy::GcStop:
+				lua_gc( m_ls, LUA_GCSTOP, 0);
+				break;
+			case mewa::LuaGcPolicy::GcIncremental:
+#if LUA_VERSION_NUM >= 504
+				lua_gc( m_ls, LUA_GCINC, 0, 0, 0);
+#endif
+				if (m_policy.pause)
+				{
+					int prev = lua_gc( m_ls, LUA_GCSETPAUSE, m_policy.pause);
+					if (m_pause < 0) m_pause = prev;
+				}
+				if (m_policy.stepmul)
+				{
+					int prev = lua_gc( m_ls, LUA_GCSETSTEPMUL, m_policy.stepmul);
+					if (m_stepmul < 0) m_stepmul = prev;
+				}
+				lua_gc( m_ls, LUA_GCRESTART, 0);
+				break;
+			case mewa::LuaGcPolicy::GcGenerational:
+#if LUA_VERSION_NUM >= 504
+				lua_gc( m_ls, LUA_GCGEN, 0, 0);
+#endif
+				lua_gc( m_ls, LUA_GCRESTART, 0);
+				break;
+		}
+	}
+
+	void restore() noexcept
+	{
+		if (!m_policy.defined()) return;
+		if (m_pause >= 0)
+		{
+			lua_gc( m_ls, LUA_GCSETPAUSE, m_pause);
+			m_pause = -1;
+		}
+		if (m_stepmul >= 0)
+		{
+			lua_gc( m_ls, LUA_GCSETSTEPMUL, m_stepmul);
+			m_stepmul = -1;
+		}
+#if LUA_VERSION_NUM >= 504
+		if (m_generational)
+		{
+			lua_gc( m_ls, LUA_GCGEN, 0, 0);
+		}
+		else
+		{
+			lua_gc( m_ls, LUA_GCINC, 0, 0, 0);
+		}
+#endif
+		lua_gc( m_ls, m_running ? LUA_GCRESTART : LUA_GCSTOP, 0);
+	}
+
+private:
+	lua_State* m_ls;
+	const mewa::LuaGcPolicy& m_policy;
+	bool m_running;			//< true if the garbage collector was running before the policy was applied
+	bool m_generational;		//< true if the garbage collector was in generational mode before the policy was applied
+	int m_pause;			//< pause of the garbage collector before it was changed, -1 if not changed
+	int m_stepmul;			//< step multiplier of the garbage collector before it was changed, -1 if not changed
+};
+
+static void runCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, mewa::Scanner& scanner, const char* calltable, FILE* dbgout,
+				const mewa::LuaCompilerConfig& config)
 {
 	int buffer[ 2048];
 	mewa::monotonic_buffer_resource memrsc( buffer, sizeof buffer);
 
+	ArenaAst* ast = nullptr;
+	int astref = 0;
+	int astViewMetatable = 0;
+	if (config.arenaAst || config.astCacheFile)
+	{
+		// The AST is built in an arena if passed as views or if it is read from or written to a cache file:
+		ast = luaPushArenaAst( ls);					// STK: [AST]
+		astref = lua_gettop( ls);
+		lua_getglobal( ls, calltable);					// STK: [AST] [CALLTABLE]
+		if (config.arenaAst)
+		{
+			luaPushArenaAstViewMetatable( ls, automaton, astref, astref+1);	// STK: [AST] [CALLTABLE] [MT]
+			astViewMetatable = lua_gettop( ls);
+		}
+		else
+		{
+			lua_pushnil( ls);					// STK: [AST] [CALLTABLE] [NIL]
+		}
+	}
 	lua_getglobal( ls, calltable);					// STK: [CALLTABLE]
 
 	int calltableref = lua_gettop( ls);
@@ -591,48 +1340,100 @@ void mewa::luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int
 #else
 	int calltablesize = lua_rawlen( ls, calltableref);;
 #endif
-	if (!lua_istable( ls, calltableref)) throw mewa::Error( mewa::Error::LogicError, string_format( "%s line %d", __FILE__, (int)__LINE__));
+	if (!lua_istable( ls, calltableref)) throw mewa::Error( mewa::Error::LogicError, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
 
 	int nofLuaStackElements = lua_gettop( ls);
 
-	CompilerContext ctx( &memrsc, sizeof buffer, calltableref, calltablesize, dbgout);
-	Scanner scanner( source);
+	CompilerContext ctx( &memrsc, sizeof buffer, calltableref, calltablesize, dbgout, config.lexemMetatable, ast);
+	LuaGcPolicyScope gcPolicyScope( ls, config.gcPolicy);
+	gcPolicyScope.apply( config.gcPolicy.parsing);
 
 	// Feed source lexems:
-	Lexem lexem = automaton.lexer().next( scanner);
-	for (; !lexem.empty(); lexem = automaton.lexer().next( scanner))
+	mewa::LuaCompilerStatistics* statistics = config.statistics;
+	mewa::LuaCompilerStatistics::Time startTime;
+	auto nextLexem = [&]() -> mewa::Lexem
 	{
-		if (lexem.id() <= 0)
-		{
-			throw Error( Error::BadCharacterInGrammarDef, lexem.value(), lexem.line());
-		}
-		do
-		{
-			if (dbgout) printDebugAction( dbgout, ctx, automaton, lexem);
-		}
-		while (!feedLexem( ls, ctx, automaton, lexem));
+		if (!statistics) return automaton.lexer().next( scanner);
 
-		// Runtime check of stack indices:
-		int top = lua_gettop( ls);
-		if (!ctx.stateStack.empty() && ctx.stateStack.back().luastkn
-			&& (top - nofLuaStackElements) != (ctx.stateStack.back().luastki + ctx.stateStack.back().luastkn - 1))
+		mewa::LuaCompilerStatistics::Time lexerStartTime = mewa::LuaCompilerStatistics::Time::now();
+		mewa::Lexem rt = automaton.lexer().next( scanner);
+		statistics->lexing += mewa::LuaCompilerStatistics::Time::now() - lexerStartTime;
+		if (!rt.empty()) ++statistics->nofTokens;
+		return rt;
+	};
+	if (statistics) startTime = mewa::LuaCompilerStatistics::Time::now();
+
+	// The AST is not read from the cache if a debug output is defined, as the debug output logs the actions of the parser:
+	bool cached = config.astCacheFile && !dbgout && readArenaAstCache( config.astCacheFile, config.astCacheKey, automaton, calltablesize, *ast, ctx.astStack);
+	if (!cached)
+	{
+		mewa::Lexem lexem = nextLexem();
+		for (; !lexem.empty(); lexem = nextLexem())
 		{
-			if (dbgout)
+			if (lexem.id() <= 0)
+			{
+				throw mewa::Error( mewa::Error::BadCharacterInGrammarDef, lexem.value(), lexem.line());
+			}
+			do
+			{
+				if (dbgout) printDebugAction( dbgout, ctx, automaton, lexem);
+			}
+			while (!feedLexem( ls, ctx, automaton, lexem));
+
+			// Runtime check of stack indices:
+			int top = ast ? (nofLuaStackElements + ctx.astStack.size()) : lua_gettop( ls);
+			if (!ctx.stateStack.empty() && ctx.stateStack.back().luastkn
+				&& (top - nofLuaStackElements) != (ctx.stateStack.back().luastki + ctx.stateStack.back().luastkn - 1))
 			{
-				fprintf( dbgout, "Stack top=%d, nof elements=%d\n", top, nofLuaStackElements);
-				for (auto stke : ctx.stateStack)
+				if (dbgout)
 				{
-					fprintf( dbgout, "Stack element: i=%d, n=%d\n", stke.luastki, stke.luastkn);
+					fprintf( dbgout, "Stack top=%d, nof elements=%d\n", top, nofLuaStackElements);
+					for (auto stke : ctx.stateStack)
+					{
+						fprintf( dbgout, "Stack element: i=%d, n=%d\n", stke.luastki, stke.luastkn);
+					}
 				}
+				throw mewa::Error( mewa::Error::LogicError, mewa::string_format( "%s line %d", __FILE__, (int)__LINE__));
 			}
-			throw Error( Error::LogicError, string_format( "%s line %d", __FILE__, (int)__LINE__));
+		}
+		// Feed EOF:
+		while (!feedLexem( ls, ctx, automaton, lexem/* empty ~ end of input*/))
+		{
+			if (dbgout) printDebugAction( dbgout, ctx, automaton, lexem);
+		}
+		if (config.astCacheFile)
+		{
+			writeArenaAstCache( config.astCacheFile, config.astCacheKey, *ast, ctx.astStack);
 		}
 	}
-	// Feed EOF:
-	while (!feedLexem( ls, ctx, automaton, lexem/* empty ~ end of input*/))
+	if (ast && !astViewMetatable)
 	{
-		if (dbgout) printDebugAction( dbgout, ctx, automaton, lexem);
+		// Push the top level nodes of the AST built in the arena as tables:
+		luaPushArenaAstTables( ls, *ast, ctx.astStack, automaton, calltableref, config.lexemMetatable);
 	}
+	else if (ast)
+	{
+		// Push the views on the top level nodes of the AST built in the arena:
+		lua_getfield( ls, astViewMetatable, "__index");			// STK: [INDEX]
+		lua_getupvalue( ls, -1, ARENA_AST_UPVALUE_NOSTORAGE);		// STK: [INDEX] [NOSTORAGE]
+		lua_replace( ls, -2);						// STK: [NOSTORAGE]
+		int nostorage = lua_gettop( ls);
+		if (!lua_checkstack( ls, ctx.astStack.size() + 4)) throw mewa::Error( mewa::Error::LuaStackOutOfMemory);
+		for (int node : ctx.astStack)
+		{
+			luaPushArenaAstView( ls, node, astViewMetatable, nostorage);	// STK: [NOSTORAGE] [VIEW]..
+		}
+		lua_remove( ls, nostorage);					// STK: [VIEW]..
+	}
+	if (statistics)
+	{
+		mewa::LuaCompilerStatistics::Time parserEndTime = mewa::LuaCompilerStatistics::Time::now();
+		statistics->parsing += (parserEndTime - startTime) - statistics->lexing;
+		statistics->nofReductions += ctx.nofReductions;
+		startTime = parserEndTime;
+	}
+	gcPolicyScope.apply( config.gcPolicy.callbacks);
+
 	// Call Lua top level AST node functions with their associated nodes as parameter:
 	if (ctx.calltablesize)
 	{
@@ -642,7 +1443,119 @@ void mewa::luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int
 			luaCallNodeFunction( ls, li, ctx.calltable, ctx.dbgout, options_index);
 		}
 	}
+	if (statistics)
+	{
+		statistics->callbacks += mewa::LuaCompilerStatistics::Time::now() - startTime;
+	}
 	lua_pop( ls, 1 + lua_gettop( ls) - nofLuaStackElements);
+	if (ast)
+	{
+		lua_pop( ls, 3);						// ... pop [AST] [CALLTABLE] [MT]
+	}
+	gcPolicyScope.restore();
+	if (config.gcPolicy.collect)
+	{
+		if (statistics) startTime = mewa::LuaCompilerStatistics::Time::now();
+		lua_gc( ls, LUA_GCCOLLECT, 0);
+		if (statistics) statistics->gc += mewa::LuaCompilerStatistics::Time::now() - startTime;
+	}
+}
+
+mewa::LuaCompilerStatistics::Time mewa::LuaCompilerStatistics::Time::now() noexcept
+{
+	double wall = std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch()).count();
+	struct timespec ts;
+	double cpu = (0 == ::clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts)) ? (double)ts.tv_sec + (double)ts.tv_nsec / 1e9 : 0.0;
+	return Time( wall, cpu);
+}
+
+static void* luaCountingAlloc( void* ud, void* ptr, size_t osize, size_t nsize)
+{
+	mewa::LuaMemoryCounter* counter = (mewa::LuaMemoryCounter*)ud;
+	std::size_t oldsize = ptr ? osize : 0; // ... osize encodes the type of the object if ptr is NULL (Lua >= 5.2)
+	void* rt = counter->allocf( counter->ud, ptr, osize, nsize);
+	if (nsize == 0)
+	{
+		counter->used -= oldsize;
+	}
+	else if (rt)
+	{
+		counter->used += nsize;
+		counter->used -= oldsize;
+		if (counter->used > counter->peak) counter->peak = counter->used;
+	}
+	return rt;
 }
 
+void mewa::LuaMemoryCounter::install( lua_State* ls) noexcept
+{
+	uninstall( ls);
+	allocf = lua_getallocf( ls, &ud);
+	used = (std::size_t)lua_gc( ls, LUA_GCCOUNT, 0) * 1024 + lua_gc( ls, LUA_GCCOUNTB, 0);
+	peak = used;
+	lua_setallocf( ls, &luaCountingAlloc, this);
+}
 
+void mewa::LuaMemoryCounter::uninstall( lua_State* ls) noexcept
+{
+	if (allocf)
+	{
+		lua_setallocf( ls, allocf, ud);
+		allocf = nullptr;
+		ud = nullptr;
+	}
+}
+
+void mewa::luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, const std::string_view& source, const char* calltable, FILE* dbgout,
+				const LuaCompilerConfig& config)
+{
+	Scanner scanner( source);
+	runCompiler( ls, automaton, options_index, scanner, calltable, dbgout, config);
+}
+
+void mewa::luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, ScannerReader& reader, const char* calltable, FILE* dbgout,
+				const LuaCompilerConfig& config)
+{
+	Scanner scanner( &reader);
+	runCompiler( ls, automaton, options_index, scanner, calltable, dbgout, config);
+}
+
+mewa::LuaChunkReader::LuaChunkReader( lua_State* ls_, int li_)
+	:m_ls(ls_),m_li(li_ < 0 ? lua_gettop( ls_) + li_ + 1 : li_){}
+
+bool mewa::LuaChunkReader::read( std::string& buf)
+{
+	if (!lua_checkstack( m_ls, 3)) throw mewa::Error( mewa::Error::LuaStackOutOfMemory);
+	lua_pushcfunction( m_ls, &lua_pcall_errorhandler);	// STK: [EHND]
+	lua_pushvalue( m_ls, m_li);				// STK: [EHND] [FUNC]
+	int rc = lua_pcall( m_ls, 0, 1, -2);			// STK: [EHND] [CHUNK]
+	lua_remove( m_ls, -2);					// STK: [CHUNK]
+	if (rc)
+	{
+		// ... the error is thrown as exception, a Lua error would skip the destructors of the compiler calling the reader
+		const char* msg = lua_tostring( m_ls, -1);
+		std::string msgstr( msg ? msg : "");
+		lua_pop( m_ls, 1);
+		mewa::Error err = mewa::Error::parseError( msgstr.c_str());
+		if (err.code() == mewa::Error::RuntimeException)
+		{
+			throw mewa::Error( luaErrorCode2ErrorCode( rc), msgstr);
+		}
+		throw err;
+	}
+	bool rt = false;
+	if (lua_type( m_ls, -1) == LUA_TSTRING)
+	{
+		std::size_t len;
+		const char* chunk = lua_tolstring( m_ls, -1, &len);
+		buf.append( chunk, len);
+		rt = len > 0;
+	}
+	else if (!lua_isnil( m_ls, -1))
+	{
+		lua_pop( m_ls, 1);
+		throw mewa::Error( mewa::Error::ExpectedStringArgument, "chunk reader");
+	}
+	lua_pop( m_ls, 1);
+	return rt;
+}
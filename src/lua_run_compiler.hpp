@@ -13,21 +13,177 @@
 #define _MEWA_LUA_RUN_COMPILER_HPP_INCLUDED
 #if __cplusplus >= 201703L
 #include "automaton.hpp"
+#include "lexer.hpp"
 #include <string>
 #include <iostream>
+#include <cstdint>
 extern "C" {
 #include <lua.h>
 }
 
 namespace mewa {
 
+/// \brief Statistics of a compiler run with the time spent in each phase
+struct LuaCompilerStatistics
+{
+	/// \brief Time spent in a phase
+	struct Time
+	{
+		double wall;			///< elapsed wall clock time in seconds
+		double cpu;			///< CPU time of the calling thread in seconds
+
+		Time()
+			:wall(0.0),cpu(0.0){}
+		Time( double wall_, double cpu_)
+			:wall(wall_),cpu(cpu_){}
+
+		/// \brief Get the current time of the clocks measured
+		static Time now() noexcept;
+
+		Time operator - ( const Time& o) const noexcept	{return Time( wall - o.wall, cpu - o.cpu);}
+		Time& operator += ( const Time& o) noexcept	{wall += o.wall; cpu += o.cpu; return *this;}
+		Time& operator -= ( const Time& o) noexcept	{wall -= o.wall; cpu -= o.cpu; return *this;}
+	};
+
+	Time input;			///< reading the source and the target template (with incremental reading, the reading of the source is part of the lexing)
+	Time lexing;			///< lexer
+	Time parsing;			///< parser automaton and the building of the AST
+	Time callbacks;			///< Lua AST node functions called for the top level nodes of the AST
+	Time templating;		///< substitution of the output sections in the target template
+	Time output;			///< writing of the output
+	Time gc;			///< full collection of the Lua garbage collector at the end of the run, if configured in the garbage collector policy
+	long nofTokens;			///< number of lexems fed to the parser
+	long nofReductions;		///< number of reductions of the parser
+	std::size_t peakLuaMemory;	///< peak of the memory used by the Lua state during the run in bytes (high-water mark of the heap)
+	std::size_t luaMemory;		///< memory used by the Lua state at the end of the run in bytes
+
+	LuaCompilerStatistics()
+		:input(),lexing(),parsing(),callbacks(),templating(),output(),gc(),nofTokens(0),nofReductions(0),peakLuaMemory(0),luaMemory(0){}
+};
+
+/// \brief Counter of the memory used by a Lua state, hooked in as allocator of the state
+struct LuaMemoryCounter
+{
+	lua_Alloc allocf;		///< allocator of the Lua state replaced, NULL if not installed
+	void* ud;			///< user data of the allocator replaced
+	std::size_t used;		///< bytes currently used
+	std::size_t peak;		///< peak of bytes used since installed
+
+	void init() noexcept
+	{
+		allocf = nullptr;
+		ud = nullptr;
+		used = 0;
+		peak = 0;
+	}
+	/// \brief Replace the allocator of a Lua state with one counting the memory used
+	void install( lua_State* ls) noexcept;
+	/// \brief Restore the allocator of the Lua state replaced, if installed
+	void uninstall( lua_State* ls) noexcept;
+	bool installed() const noexcept	{return allocf != nullptr;}
+};
+
+/// \brief Policy of the Lua garbage collector selected per phase of a compiler run
+/// \note The state of the garbage collector is restored at the end of the run
+struct LuaGcPolicy
+{
+	enum Mode
+	{
+		GcDefault,			///< garbage collector left as it is
+		GcStop,				///< garbage collector stopped
+		GcIncremental,			///< garbage collector running in incremental mode, with the pause and step multiplier of the policy if defined
+		GcGenerational			///< garbage collector running in generational mode (Lua >= 5.4)
+	};
+	Mode parsing;			///< mode of the garbage collector during lexing and parsing
+	Mode callbacks;			///< mode of the garbage collector during the calls of the Lua AST node functions
+	int pause;			///< pause of the incremental garbage collector in percent, 0 if not changed
+	int stepmul;			///< step multiplier of the incremental garbage collector in percent, 0 if not changed
+	bool collect;			///< true if a full collection is done at the end of the run
+
+	void init() noexcept
+	{
+		parsing = GcDefault;
+		callbacks = GcDefault;
+		pause = 0;
+		stepmul = 0;
+		collect = false;
+	}
+	/// \brief Evaluate if the policy changes anything
+	bool defined() const noexcept
+	{
+		return parsing != GcDefault || callbacks != GcDefault || collect;
+	}
+	/// \brief Evaluate if the generational mode is supported by the Lua version mewa is built with
+	static bool generationalModeSupported() noexcept
+	{
+#if LUA_VERSION_NUM >= 504
+		return true;
+#else
+		return false;
+#endif
+	}
+};
+
+/// \brief Configuration of the representation of the AST built by the compiler
+struct LuaCompilerConfig
+{
+	int lexemMetatable;		///< Lua stack index of the metatable for compact lexem nodes, 0 if lexem nodes are represented as tables
+	bool arenaAst;			///< true if the AST is built in a C++ arena and passed to Lua as userdata views with fields materialized on access
+	LuaCompilerStatistics* statistics;	///< statistics to fill with the time of the phases lexing, parsing and callbacks and the counts of tokens and reductions, NULL if not measured
+	const char* astCacheFile;	///< path of the file the AST is read from if it exists and written to otherwise, NULL if the AST is not cached
+	std::uint64_t astCacheKey;	///< key identifying the source and the automaton, stored in the cache file and verified when read
+	LuaGcPolicy gcPolicy;		///< policy of the Lua garbage collector per phase
+
+	LuaCompilerConfig()
+		:lexemMetatable(0),arenaAst(false),statistics(nullptr),astCacheFile(nullptr),astCacheKey(0)
+	{
+		gcPolicy.init();
+	}
+};
+
+/// \brief Push the metatable for compact lexem nodes of an automaton on the Lua stack
+/// \note A compact lexem node is a userdata object that provides the fields 'name', 'value' and 'line' as read-only attributes
+/// \param[in] ls Lua state
+/// \param[in] automaton LALR(1) parser automaton with the lexer defining the names of the lexems
+void luaPushCompactLexemMetatable( lua_State* ls, const mewa::Automaton& automaton);
+
 // \param[in] ls Lua state
 // \param[in] automaton LALR(1) parser automaton
 // \param[in] options_index Lua stack index of options passed to top level Lua AST node functions called by the compiler
 // \param[in] source source to compile
 // \param[in] calltable Name of Lua global variable addressing the call table of the compiler
 // \param[in] dbgout optional debug output, null if not defined
-void luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, const std::string_view& source, const char* calltable, FILE* dbgout);
+// \param[in] config configuration of the AST representation
+void luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, const std::string_view& source, const char* calltable, FILE* dbgout,
+			const LuaCompilerConfig& config = LuaCompilerConfig());
+
+// \brief Run the compiler on a source read incrementally, the lexer is fed with the data as it is read
+// \param[in] ls Lua state
+// \param[in] automaton LALR(1) parser automaton
+// \param[in] options_index Lua stack index of options passed to top level Lua AST node functions called by the compiler
+// \param[in] reader reader of the source to compile
+// \param[in] calltable Name of Lua global variable addressing the call table of the compiler
+// \param[in] dbgout optional debug output, null if not defined
+// \param[in] config configuration of the AST representation
+void luaRunCompiler( lua_State* ls, const mewa::Automaton& automaton, int options_index, ScannerReader& reader, const char* calltable, FILE* dbgout,
+			const LuaCompilerConfig& config = LuaCompilerConfig());
+
+/// \brief Reader of a source from a Lua function returning the chunks of the source, nil or an empty string marks the end of the source
+class LuaChunkReader
+	:public ScannerReader
+{
+public:
+	/// \brief Constructor
+	/// \param[in] ls_ Lua state
+	/// \param[in] li_ Lua stack index of the function returning the chunks
+	LuaChunkReader( lua_State* ls_, int li_);
+
+	virtual bool read( std::string& buf);
+
+private:
+	lua_State* m_ls;
+	int m_li;
+};
 
 } //namespace
 #else
@@ -282,8 +282,18 @@ static void serializeLuaValue( std::ostream& out, lua_State* ls, int li, const s
 				serializeLuaTable( out, ls, li, indent.empty() ? std::string() : (indent + "  "), depth);
 			}
 			break;
-		case LUA_TFUNCTION:
 		case LUA_TUSERDATA:
+			if (luaL_getmetafield( ls, li, "__serialize"))
+			{
+				// ... userdata with a method "__serialize" returning a table representing its contents
+				lua_pushvalue( ls, li < 0 ? li-1 : li);
+				lua_call( ls, 1, 1);
+				serializeLuaValue( out, ls, -1, indent, depth);
+				lua_pop( ls, 1);
+				break;
+			}
+			/*no break here!*/
+		case LUA_TFUNCTION:
 		case LUA_TTHREAD:
 		case LUA_TLIGHTUSERDATA:
 			out << "<" << lua_typename( ls, tp) << ">";
@@ -13,13 +13,17 @@
 #define _MEWA_LUA_USERDATA_HPP_INCLUDED
 #if __cplusplus >= 201703L
 #include "typedb.hpp"
+#include "typedb_record.hpp"
 #include "automaton.hpp"
 #include "scope.hpp"
+#include "lua_run_compiler.hpp"
 #include "error.hpp"
 #include "strings.hpp"
 #include <string>
 #include <string_view>
 #include <cstdio>
+#include <cstring>
+#include <atomic>
 extern "C" {
 #include <lua.h>
 #include <lauxlib.h>
@@ -56,7 +60,7 @@ struct CallTableName :public TableName
 {
 	void init()
 	{
-		static int tableIdx = 0;
+		static std::atomic<int> tableIdx( 0);
 		TableName::init( MEWA_COMPILER_METATABLE_NAME, MEWA_CALLTABLE_FMT, ++tableIdx);
 	}
 };
@@ -72,13 +76,38 @@ struct mewa_compiler_userdata_t
 	std::string outputBuffer;
 	typedef std::map<std::string,std::string> OutputSectionMap;
 	OutputSectionMap outputSectionMap;
+	int lexemMetatableRef;
+	bool arenaAst;
+	std::string* outputCapture;
+	mewa::LuaCompilerStatistics* statisticsCapture;
+	enum ProfileMode {ProfileNone, ProfileReport, ProfileCollapsed};
+	ProfileMode profileMode;
+	bool profileTypeDb;
+	char profileOutput[ 256];
+	bool statistics;
+	mewa::LuaMemoryCounter memoryCounter;
+	char astCacheDir[ 256];
+	std::uint64_t automatonHash;
+	mewa::LuaGcPolicy gcPolicy;
 
 	void init()
 	{
 		debugFileHandle = nullptr;
+		outputCapture = nullptr;
+		statisticsCapture = nullptr;
+		lexemMetatableRef = LUA_NOREF;
+		arenaAst = false;
+		profileMode = ProfileNone;
+		profileTypeDb = false;
 		new (&automaton) mewa::Automaton();
 		new (&outputBuffer) OutputBuffer();
 		new (&outputSectionMap) OutputSectionMap();
+		std::strcpy( profileOutput, "stderr");
+		statistics = false;
+		memoryCounter.init();
+		astCacheDir[ 0] = 0;
+		automatonHash = 0;
+		gcPolicy.init();
 		callTableName.init();
 	}
 	void closeOutput() noexcept
@@ -89,6 +118,9 @@ struct mewa_compiler_userdata_t
 	{
 		lua_pushnil( ls);
 		lua_setglobal( ls, callTableName.buf);
+		luaL_unref( ls, LUA_REGISTRYINDEX, lexemMetatableRef);
+		memoryCounter.uninstall( ls);
+		lexemMetatableRef = LUA_NOREF;
 
 		closeOutput();
 		automaton.~Automaton();
@@ -125,6 +157,7 @@ struct mewa_typedb_userdata_t
 {
 public:
 	mewa::TypeDatabase* impl;
+	mewa::TypeDatabaseRecorder* recorder;
 	mewa::Scope curScope;
 	mewa::Scope::Step curStep;
 
@@ -135,19 +168,25 @@ public:
 	void init() noexcept
 	{
 		impl = nullptr;
+		recorder = nullptr;
 		objCount = 0;
 		curScope = mewa::Scope( 0, std::numeric_limits<mewa::Scope::Step>::max());
 		curStep = 0;
 	}
-	void create()
+	void create( const char* recordFilename)
 	{
 		if (impl) delete impl;
 		impl = new mewa::TypeDatabase();
+		if (recorder) delete recorder;
+		recorder = nullptr;
+		if (recordFilename) recorder = new mewa::TypeDatabaseRecorder( recordFilename);
 	}
 	void destroy( lua_State* ls) noexcept
 	{
 		if (impl) delete impl;
 		impl = nullptr;
+		if (recorder) delete recorder;
+		recorder = nullptr;
 	}
 	static const char* metatableName() noexcept {return MEWA_TYPEDB_METATABLE_NAME;}
 };
@@ -10,6 +10,8 @@
 #include "export.hpp"
 #include "lua_load_automaton.hpp"
 #include "lua_run_compiler.hpp"
+#include "lua_run_batch.hpp"
+#include "lua_call_profiler.hpp"
 #include "lua_object_reference.hpp"
 #include "lua_serialize.hpp"
 #include "lua_userdata.hpp"
@@ -116,6 +118,14 @@ static std::string_view move_string_on_lua_stack( lua_State* ls, std::string&& s
 	return obj->obj();
 }
 
+static mewa::ScannerReader* move_reader_on_lua_stack( lua_State* ls, mewa::ScannerReader* reader)
+{
+	memblock_userdata_t* mb = memblock_userdata_t::create( ls);
+	mewa::ObjectOwnership<mewa::ScannerReader>* obj = new mewa::ObjectOwnership<mewa::ScannerReader>( reader);
+	mb->memoryBlock = obj;
+	return obj->obj();
+}
+
 static int lua_print_redirected_impl( lua_State* ls, FILE* fh)
 {
 	[[maybe_unused]] static const char* functionName = "mewa print redirected";
@@ -330,14 +340,237 @@ static int mewa_stacktrace( lua_State* ls)
 	return 1;
 }
 
+static void copyFileNameToBuffer( char* buf, std::size_t bufsize, std::string_view str)
+{
+	if (str.size() >= bufsize) throw mewa::Error( mewa::Error::InternalBufferOverflow, str);
+	std::memcpy( buf, str.data(), str.size());
+	buf[ str.size()] = 0;
+}
+
+/// \brief Configuration of a compiler object passed as optional argument to mewa.compiler
+struct CompilerConfiguration
+{
+	bool compactLexems;		//< true if lexem nodes of the AST are created as compact read-only userdata objects
+	bool arenaAst;			//< true if the AST is built in a C++ arena and passed to Lua as views on its nodes
+	mewa_compiler_userdata_t::ProfileMode profileMode;	//< profile of the Lua functions called by the compiler written after each run
+	bool profileTypeDb;		//< true if the calls of typedb methods are also profiled
+	char profileOutput[ 256];	//< file to write the profile to
+	bool statistics;		//< true if compiler:run returns a table with the statistics of the run
+	char astCacheDir[ 256];		//< directory of the files with the ASTs of the sources compiled, empty if ASTs are not cached
+	mewa::LuaGcPolicy gcPolicy;	//< policy of the Lua garbage collector per phase of a run
+
+	CompilerConfiguration()
+		:compactLexems(false),arenaAst(false),profileMode(mewa_compiler_userdata_t::ProfileNone),profileTypeDb(false),statistics(false)
+	{
+		std::strcpy( profileOutput, "stderr");
+		astCacheDir[ 0] = 0;
+		gcPolicy.init();
+	}
+};
+
+static mewa::LuaGcPolicy::Mode getGcPolicyMode( const char* functionName, lua_State* ls, int li, const char* key)
+{
+	std::string_view value = lua_type( ls, -1) == LUA_TSTRING ? lua_tostring( ls, -1) : "";
+	if (value == "default")
+	{
+		return mewa::LuaGcPolicy::GcDefault;
+	}
+	else if (value == "stop")
+	{
+		return mewa::LuaGcPolicy::GcStop;
+	}
+	else if (value == "incremental")
+	{
+		return mewa::LuaGcPolicy::GcIncremental;
+	}
+	else if (value == "generational" && mewa::LuaGcPolicy::generationalModeSupported())
+	{
+		return mewa::LuaGcPolicy::GcGenerational;
+	}
+	throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc.%s", functionName, li, key));
+}
+
+static int getGcPolicyParameter( const char* functionName, lua_State* ls, int li, const char* key)
+{
+	if (lua_type( ls, -1) != LUA_TNUMBER || lua_tonumber( ls, -1) < 1 || lua_tonumber( ls, -1) > 10000)
+	{
+		throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc.%s", functionName, li, key));
+	}
+	return (int)lua_tonumber( ls, -1);
+}
+
+static mewa::LuaGcPolicy getGcPolicy( const char* functionName, lua_State* ls, int li)
+{
+	mewa::LuaGcPolicy rt;
+	rt.init();
+	if (!lua_istable( ls, -1))
+	{
+		throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc", functionName, li));
+	}
+	lua_pushnil( ls);
+	while (lua_next( ls, -2))
+	{
+		if (lua_type( ls, -2) != LUA_TSTRING)
+		{
+			throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc", functionName, li));
+		}
+		std::string_view key = lua_tostring( ls, -2);
+		if (key == "parsing")
+		{
+			rt.parsing = getGcPolicyMode( functionName, ls, li, key.data());
+		}
+		else if (key == "callbacks")
+		{
+			rt.callbacks = getGcPolicyMode( functionName, ls, li, key.data());
+		}
+		else if (key == "pause")
+		{
+			rt.pause = getGcPolicyParameter( functionName, ls, li, key.data());
+		}
+		else if (key == "stepmul")
+		{
+			rt.stepmul = getGcPolicyParameter( functionName, ls, li, key.data());
+		}
+		else if (key == "collect")
+		{
+			if (lua_type( ls, -1) != LUA_TBOOLEAN)
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc.%s", functionName, li, key.data()));
+			}
+			rt.collect = lua_toboolean( ls, -1);
+		}
+		else
+		{
+			throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] gc.%s", functionName, li, key.data()));
+		}
+		lua_pop( ls, 1);
+	}
+	return rt;
+}
+
+static CompilerConfiguration getCompilerConfiguration( const char* functionName, lua_State* ls, int li)
+{
+	CompilerConfiguration rt;
+	mewa::lua::checkArgumentAsTable( functionName, ls, li);
+	lua_pushvalue( ls, li);
+	lua_pushnil( ls);
+	while (lua_next( ls, -2))
+	{
+		if (lua_type( ls, -2) != LUA_TSTRING)
+		{
+			throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d]", functionName, li));
+		}
+		std::string_view key = lua_tostring( ls, -2);
+		std::string_view value = lua_type( ls, -1) == LUA_TSTRING ? lua_tostring( ls, -1) : "";
+		if (key == "lexem")
+		{
+			if (value == "compact")
+			{
+				rt.compactLexems = true;
+			}
+			else if (value == "table")
+			{
+				rt.compactLexems = false;
+			}
+			else
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+		}
+		else if (key == "ast")
+		{
+			if (value == "arena")
+			{
+				rt.arenaAst = true;
+			}
+			else if (value == "table")
+			{
+				rt.arenaAst = false;
+			}
+			else
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+		}
+		else if (key == "profile")
+		{
+			if (value == "report")
+			{
+				rt.profileMode = mewa_compiler_userdata_t::ProfileReport;
+			}
+			else if (value == "collapsed")
+			{
+				rt.profileMode = mewa_compiler_userdata_t::ProfileCollapsed;
+			}
+			else if (value == "none")
+			{
+				rt.profileMode = mewa_compiler_userdata_t::ProfileNone;
+			}
+			else
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+		}
+		else if (key == "profile_typedb")
+		{
+			if (lua_type( ls, -1) != LUA_TBOOLEAN)
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+			rt.profileTypeDb = lua_toboolean( ls, -1);
+		}
+		else if (key == "profile_output")
+		{
+			if (value.empty())
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+			copyFileNameToBuffer( rt.profileOutput, sizeof(rt.profileOutput), value);
+		}
+		else if (key == "statistics")
+		{
+			if (lua_type( ls, -1) != LUA_TBOOLEAN)
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+			rt.statistics = lua_toboolean( ls, -1);
+		}
+		else if (key == "cache")
+		{
+			if (value.empty() || !mewa::isDirectory( std::string( value).c_str()))
+			{
+				throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+			}
+			copyFileNameToBuffer( rt.astCacheDir, sizeof(rt.astCacheDir), value);
+		}
+		else if (key == "gc")
+		{
+			rt.gcPolicy = getGcPolicy( functionName, ls, li);
+		}
+		else
+		{
+			throw mewa::Error( mewa::Error::InvalidCompilerConfiguration, mewa::string_format( "%s [%d] %s", functionName, li, key.data()));
+		}
+		lua_pop( ls, 1);
+	}
+	lua_pop( ls, 1);
+	return rt;
+}
+
 static int mewa_new_compiler( lua_State* ls)
 {
 	[[maybe_unused]] static const char* functionName = "mewa.compiler";
+	CompilerConfiguration config;
 	try
 	{
-		mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 1/*maxNofArgs*/);
+		int nargs = mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 2/*maxNofArgs*/);
 		mewa::lua::checkArgumentAsTable( functionName, ls, 1);
-		mewa::lua::checkStack( functionName, ls, 6);
+		mewa::lua::checkStack( functionName, ls, 8);
+		if (nargs >= 2 && !lua_isnil( ls, 2))
+		{
+			config = getCompilerConfiguration( functionName, ls, 2);
+		}
+		lua_settop( ls, 1);
 	}
 	catch (...) { lippincottFunction( ls); }
 
@@ -357,6 +590,31 @@ static int mewa_new_compiler( lua_State* ls)
 	}
 	catch (...) { lippincottFunction( ls); }
 
+	cp->arenaAst = config.arenaAst;
+	cp->profileMode = config.profileMode;
+	cp->profileTypeDb = config.profileTypeDb;
+	std::strcpy( cp->profileOutput, config.profileOutput);
+	cp->statistics = config.statistics;
+	std::strcpy( cp->astCacheDir, config.astCacheDir);
+	cp->gcPolicy = config.gcPolicy;
+	if (cp->astCacheDir[0])
+	{
+		try
+		{
+			cp->automatonHash = mewa::string_hash( cp->automaton.tostring());
+		}
+		catch (...) { lippincottFunction( ls); }
+	}
+	if (config.compactLexems)
+	{
+		try
+		{
+			mewa::luaPushCompactLexemMetatable( ls, cp->automaton);
+		}
+		catch (...) { lippincottFunction( ls); }
+		cp->lexemMetatableRef = luaL_ref( ls, LUA_REGISTRYINDEX);
+	}
+
 	luaL_getmetatable( ls, mewa_compiler_userdata_t::metatableName());
 	lua_setmetatable( ls, -2);
 	return 1;
@@ -401,20 +659,91 @@ static int mewa_compiler_tostring( lua_State* ls)
 	return 1;
 }
 
-static void copyFileNameToBuffer( char* buf, std::size_t bufsize, std::string_view str)
+static void writeOutput( std::string_view outputfn, const std::string& output)
 {
-	if (str.size() >= bufsize) throw mewa::Error( mewa::Error::InternalBufferOverflow, str);
-	std::memcpy( buf, str.data(), str.size());
-	buf[ str.size()] = 0;
+	if (outputfn == "stderr")
+	{
+		std::fputs( output.c_str(), ::stderr);
+	}
+	else if (outputfn == "stdout")
+	{
+		std::fputs( output.c_str(), ::stdout);
+	}
+	else
+	{
+		mewa::writeFile( std::string(outputfn), output);
+	}
+}
+
+static void instrumentProfiledFunctions( lua_State* ls, const mewa_compiler_userdata_t* cp, mewa::LuaCallProfiler* profiler, int profileridx)
+{
+	lua_getglobal( ls, cp->callTableName.buf);			// STK: [CALLTABLE]
+	if (lua_istable( ls, -1))
+	{
+		profiler->instrumentCallTable( ls, profileridx, lua_gettop( ls));
+	}
+	lua_pop( ls, 1);						// STK:
+	if (cp->profileTypeDb)
+	{
+		profiler->instrumentMethods( ls, profileridx, mewa_typedb_userdata_t::metatableName(), "typedb:");
+	}
+}
+
+static void restoreProfiledFunctions( lua_State* ls, const mewa_compiler_userdata_t* cp)
+{
+	lua_getglobal( ls, cp->callTableName.buf);			// STK: [CALLTABLE]
+	if (lua_istable( ls, -1))
+	{
+		mewa::LuaCallProfiler::restoreCallTable( ls, lua_gettop( ls));
+	}
+	lua_pop( ls, 1);						// STK:
+	if (cp->profileTypeDb)
+	{
+		mewa::LuaCallProfiler::restoreMethods( ls, mewa_typedb_userdata_t::metatableName());
+	}
+}
+
+static void pushCompilerStatisticsTime( lua_State* ls, const char* name, const mewa::LuaCompilerStatistics::Time& time)
+{
+	lua_createtable( ls, 0/*narr*/, 2/*nrec*/);
+	lua_pushnumber( ls, time.wall);
+	lua_setfield( ls, -2, "wall");
+	lua_pushnumber( ls, time.cpu);
+	lua_setfield( ls, -2, "cpu");
+	lua_setfield( ls, -2, name);
+}
+
+static void pushCompilerStatistics( lua_State* ls, const mewa::LuaCompilerStatistics& statistics)
+{
+	lua_createtable( ls, 0/*narr*/, 11/*nrec*/);
+	pushCompilerStatisticsTime( ls, "input", statistics.input);
+	pushCompilerStatisticsTime( ls, "lexing", statistics.lexing);
+	pushCompilerStatisticsTime( ls, "parsing", statistics.parsing);
+	pushCompilerStatisticsTime( ls, "callbacks", statistics.callbacks);
+	pushCompilerStatisticsTime( ls, "template", statistics.templating);
+	pushCompilerStatisticsTime( ls, "output", statistics.output);
+	pushCompilerStatisticsTime( ls, "gc", statistics.gc);
+	lua_pushinteger( ls, statistics.nofTokens);
+	lua_setfield( ls, -2, "tokens");
+	lua_pushinteger( ls, statistics.nofReductions);
+	lua_setfield( ls, -2, "reductions");
+	lua_pushinteger( ls, statistics.peakLuaMemory);
+	lua_setfield( ls, -2, "peak_lua_memory");
+	lua_pushinteger( ls, statistics.luaMemory);
+	lua_setfield( ls, -2, "lua_memory");
 }
+
 static int mewa_compiler_run( lua_State* ls)
 {
 	[[maybe_unused]] static const char* functionName = "compiler:run( target, options, inputfile, [,outputfile [,dbgoutput]])";
 	mewa_compiler_userdata_t* cp = (mewa_compiler_userdata_t*)luaL_checkudata( ls, 1, mewa_compiler_userdata_t::metatableName());
+	mewa::LuaCompilerStatistics statistics;
 	try
 	{
 		int nargs = mewa::lua::checkNofArguments( functionName, ls, 4/*minNofArgs*/, 6/*maxNofArgs*/);
 		mewa::lua::checkStack( functionName, ls, 10);
+		mewa::LuaCompilerStatistics::Time phaseStartTime;
+		if (cp->statistics) phaseStartTime = mewa::LuaCompilerStatistics::Time::now();
 
 		char targetfn[ 256]; 	//... target filename
 		if (!lua_isnil( ls, 2))
@@ -427,14 +756,40 @@ static int mewa_compiler_run( lua_State* ls)
 		}
 		int options_index = 3;	//... options
 		char filename[ 256]; 	//... source filename
-		copyFileNameToBuffer( filename, sizeof(filename), mewa::lua::getArgumentAsString( functionName, ls, 4));
 		std::string_view outputfn = "stdout";
-
-		std::string sourcestr_ = mewa::readFile( std::string(filename));
-		std::string_view sourceptr = move_string_on_lua_stack( ls, std::move( sourcestr_));	// STK: [COMPILER] [INPUTFILE] [SOURCE]
+		std::string_view sourceptr;
+		mewa::ScannerReader* reader = nullptr;	//... reader of the source if read incrementally
+		if (lua_type( ls, 4) == LUA_TFUNCTION)
+		{
+			copyFileNameToBuffer( filename, sizeof(filename), "-");
+			reader = move_reader_on_lua_stack( ls, new mewa::LuaChunkReader( ls, 4));		// STK: [COMPILER] [INPUT] [READER]
+		}
+		else if (lua_type( ls, 4) == LUA_TNUMBER)
+		{
+			int fd = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 4);
+			copyFileNameToBuffer( filename, sizeof(filename), "-");
+			reader = move_reader_on_lua_stack( ls, new mewa::ScannerFileReader( fd));		// STK: [COMPILER] [INPUT] [READER]
+		}
+		else
+		{
+			copyFileNameToBuffer( filename, sizeof(filename), mewa::lua::getArgumentAsString( functionName, ls, 4));
+			if (mewa::isRegularFile( filename))
+			{
+				std::string sourcestr_ = mewa::readFile( std::string(filename));
+				sourceptr = move_string_on_lua_stack( ls, std::move( sourcestr_));	// STK: [COMPILER] [INPUTFILE] [SOURCE]
+			}
+			else
+			{
+				reader = move_reader_on_lua_stack( ls, new mewa::ScannerFileReader( std::string(filename)));	// STK: [COMPILER] [INPUTFILE] [READER]
+			}
+		}
 		std::string targetstr_;
 		if (targetfn[0]) targetstr_ = mewa::readFile( std::string(targetfn));
 		std::string_view targetptr = move_string_on_lua_stack( ls, std::move( targetstr_));	// STK: [COMPILER] [INPUTFILE] [SOURCE] [TARGET]
+		if (cp->statistics)
+		{
+			statistics.input += mewa::LuaCompilerStatistics::Time::now() - phaseStartTime;
+		}
 
 		if (nargs >= 5)
 		{
@@ -462,56 +817,349 @@ static int mewa_compiler_run( lua_State* ls)
 		luaL_setfuncs( ls, g_printlib, 1/*number of closure elements*/);
 		lua_pop( ls, 1);
 
-		mewa::luaRunCompiler( ls, cp->automaton, options_index, sourceptr, cp->callTableName.buf, cp->debugFileHandle);
-		{
-			std::string triple = mewa::fileBaseName( targetfn);
+		mewa::LuaCallProfiler* profiler = nullptr;
+		if (cp->profileMode != mewa_compiler_userdata_t::ProfileNone)
+		{
+			profiler = mewa::luaPushCallProfiler( ls);		// STK: [PROFILER]
+			instrumentProfiledFunctions( ls, cp, profiler, lua_gettop( ls));
+		}
+		mewa::LuaCompilerConfig config;
+		config.arenaAst = cp->arenaAst;
+		config.gcPolicy = cp->gcPolicy;
+		if (cp->lexemMetatableRef != LUA_NOREF)
+		{
+			lua_rawgeti( ls, LUA_REGISTRYINDEX, cp->lexemMetatableRef);
+			config.lexemMetatable = lua_gettop( ls);
+		}
+		if (cp->statistics)
+		{
+			config.statistics = &statistics;
+			cp->memoryCounter.install( ls);
+		}
+		char astCacheFile[ 512];	//... file with the cached AST of the source
+		if (cp->astCacheDir[0] && !reader)
+		{
+			config.astCacheKey = mewa::string_hash( sourceptr, cp->automatonHash);
+			std::snprintf( astCacheFile, sizeof(astCacheFile), "%s/%016llx.ast", cp->astCacheDir, (unsigned long long)config.astCacheKey);
+			config.astCacheFile = astCacheFile;
+		}
+		if (reader)
+		{
+			mewa::luaRunCompiler( ls, cp->automaton, options_index, *reader, cp->callTableName.buf, cp->debugFileHandle, config);
+		}
+		else
+		{
+			mewa::luaRunCompiler( ls, cp->automaton, options_index, sourceptr, cp->callTableName.buf, cp->debugFileHandle, config);
+		}
+		if (config.lexemMetatable)
+		{
+			lua_pop( ls, 1);
+		}
+		if (cp->statistics)
+		{
+			statistics.peakLuaMemory = cp->memoryCounter.peak;
+			statistics.luaMemory = cp->memoryCounter.used;
+			cp->memoryCounter.uninstall( ls);
+		}
+		if (profiler)
+		{
+			restoreProfiledFunctions( ls, cp);
+			std::string profile = (cp->profileMode == mewa_compiler_userdata_t::ProfileReport) ? profiler->report() : profiler->collapsedStacks();
+			writeOutput( cp->profileOutput, profile);
+			lua_pop( ls, 1);					// STK:
+		}
+		{
+			std::string triple = mewa::fileBaseName( targetfn);
+
+			// Map output with target template:
+			cp->outputSectionMap[ "Source"] = filename;
+			cp->outputSectionMap[ "Triple"] = triple;
+			cp->outputSectionMap[ "Code"].append( cp->outputBuffer);
+			if (cp->statistics) phaseStartTime = mewa::LuaCompilerStatistics::Time::now();
+			std::string output = mewa::template_format( targetptr, '{', '}', cp->outputSectionMap);
+			if (cp->statistics)
+			{
+				mewa::LuaCompilerStatistics::Time now = mewa::LuaCompilerStatistics::Time::now();
+				statistics.templating += now - phaseStartTime;
+				phaseStartTime = now;
+			}
+			if (cp->outputCapture)
+			{
+				*cp->outputCapture = std::move( output);
+			}
+			else if (outputfn == "stdout")
+			{
+				std::puts( output.c_str());
+			}
+			else
+			{
+				writeOutput( outputfn, output);
+			}
+			if (cp->statistics)
+			{
+				statistics.output += mewa::LuaCompilerStatistics::Time::now() - phaseStartTime;
+			}
+		}
+
+		// Restore old print function that has been left on the stack:
+					//STK: table=_G, key=print, value=function key=debug, value=function
+		lua_settable( ls, -5);	//STK: table=_G, key=print, value=function
+		lua_settable( ls, -3);	//STK: table=_G
+		lua_pop( ls, 1);	//STK:
+		cp->closeOutput();
+		lua_pop( ls, 3);	// ... destroy strings on lua stack created with move_string_on_lua_stack and options
+
+		if (g_called_deprecated_get_types)
+		{
+			std::cerr << "Warning: Called deprecated function typedb:get_types. This function has been renamed to typedb:this_types (issue #4)" << std::endl;
+		}
+		if (g_called_deprecated_get_type)
+		{
+			std::cerr << "Warning: Called deprecated function typedb:get_type. This function has been renamed to typedb:this_type (issue #4)" << std::endl;
+		}
+	}
+	catch (...)
+	{
+		cp->memoryCounter.uninstall( ls);
+		if (cp->profileMode != mewa_compiler_userdata_t::ProfileNone)
+		{
+			restoreProfiledFunctions( ls, cp);
+		}
+		lippincottFunction( ls);
+	}
+	if (cp->statistics)
+	{
+		if (cp->statisticsCapture)
+		{
+			*cp->statisticsCapture = statistics;
+		}
+		pushCompilerStatistics( ls, statistics);
+		return 1;
+	}
+	return 0;
+}
+
+static int mewa_compiler_check( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "compiler:check( inputfile)";
+	mewa_compiler_userdata_t* cp = (mewa_compiler_userdata_t*)luaL_checkudata( ls, 1, mewa_compiler_userdata_t::metatableName());
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 2/*minNofArgs*/, 2/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 8);
+
+		std::string_view sourceptr;
+		mewa::ScannerReader* reader = nullptr;	//... reader of the source if read incrementally
+		if (lua_type( ls, 2) == LUA_TFUNCTION)
+		{
+			reader = move_reader_on_lua_stack( ls, new mewa::LuaChunkReader( ls, 2));		// STK: [COMPILER] [INPUT] [READER]
+		}
+		else if (lua_type( ls, 2) == LUA_TNUMBER)
+		{
+			int fd = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 2);
+			reader = move_reader_on_lua_stack( ls, new mewa::ScannerFileReader( fd));		// STK: [COMPILER] [INPUT] [READER]
+		}
+		else
+		{
+			std::string filename( mewa::lua::getArgumentAsString( functionName, ls, 2));
+			if (mewa::isRegularFile( filename.c_str()))
+			{
+				sourceptr = move_string_on_lua_stack( ls, mewa::readFile( filename));	// STK: [COMPILER] [INPUTFILE] [SOURCE]
+			}
+			else
+			{
+				reader = move_reader_on_lua_stack( ls, new mewa::ScannerFileReader( filename));	// STK: [COMPILER] [INPUTFILE] [READER]
+			}
+		}
+		std::string errmsg;
+		int errline = 0;
+		try
+		{
+			if (reader)
+			{
+				mewa::Scanner scanner( reader);
+				cp->automaton.checkSyntax( scanner);
+			}
+			else
+			{
+				mewa::Scanner scanner( sourceptr);
+				cp->automaton.checkSyntax( scanner);
+			}
+		}
+		catch (const mewa::Error& err)
+		{
+			// ... syntax errors are returned, errors without source location (e.g. reading the source) are thrown
+			if (!err.location().line()) throw;
+			errmsg = err.what();
+			errline = err.location().line();
+		}
+		if (!errline)
+		{
+			lua_pushboolean( ls, 1);
+			return 1;
+		}
+		lua_pushboolean( ls, 0);
+		lua_pushlstring( ls, errmsg.c_str(), errmsg.size());
+		lua_pushinteger( ls, errline);
+		return 3;
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static std::vector<mewa::LuaBatchUnit> getBatchUnits( const char* functionName, lua_State* ls, int li)
+{
+	std::vector<mewa::LuaBatchUnit> rt;
+	mewa::lua::checkArgumentAsTable( functionName, ls, li);
+	for (int ui = 1;; ++ui)
+	{
+		lua_rawgeti( ls, li, ui);
+		if (lua_isnil( ls, -1))
+		{
+			lua_pop( ls, 1);
+			break;
+		}
+		rt.push_back( mewa::LuaBatchUnit());
+		if (lua_type( ls, -1) == LUA_TSTRING)
+		{
+			rt.back().input = lua_tostring( ls, -1);
+		}
+		else if (lua_type( ls, -1) == LUA_TTABLE)
+		{
+			const char* keys[3] = {"input", "output", "debug"};
+			std::string* values[3] = {&rt.back().input, &rt.back().output, &rt.back().dbgout};
+			for (int ki = 0; ki < 3; ++ki)
+			{
+				lua_getfield( ls, -1, keys[ ki]);
+				if (lua_type( ls, -1) == LUA_TSTRING)
+				{
+					*values[ ki] = lua_tostring( ls, -1);
+				}
+				else if (ki == 0 || !lua_isnil( ls, -1))
+				{
+					throw mewa::Error( mewa::Error::ExpectedStringArgument, mewa::string_format( "%s [%d] %d.%s", functionName, li, ui, keys[ ki]));
+				}
+				lua_pop( ls, 1);
+			}
+		}
+		else
+		{
+			throw mewa::Error( mewa::Error::ExpectedTableArgument, mewa::string_format( "%s [%d] %d", functionName, li, ui));
+		}
+		lua_pop( ls, 1);
+	}
+	return rt;
+}
+
+static std::string getPackageVariable( lua_State* ls, const char* name)
+{
+	std::string rt;
+	lua_getglobal( ls, "package");
+	if (lua_type( ls, -1) == LUA_TTABLE)
+	{
+		lua_getfield( ls, -1, name);
+		if (lua_type( ls, -1) == LUA_TSTRING) rt = lua_tostring( ls, -1);
+		lua_pop( ls, 1);
+	}
+	lua_pop( ls, 1);
+	return rt;
+}
+
+struct BatchRun
+{
+	std::vector<mewa::LuaBatchUnit> units;
+	std::vector<mewa::LuaBatchResult> results;
+};
+
+static int mewa_compiler_run_batch( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "compiler:run_batch( target, options, units [, threads])";
+	mewa_compiler_userdata_t* cp = (mewa_compiler_userdata_t*)luaL_checkudata( ls, 1, mewa_compiler_userdata_t::metatableName());
+	const BatchRun* batch = nullptr;
+	try
+	{
+		int nargs = mewa::lua::checkNofArguments( functionName, ls, 4/*minNofArgs*/, 5/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 10);
+
+		std::string target;
+		if (!lua_isnil( ls, 2))
+		{
+			target = mewa::lua::getArgumentAsString( functionName, ls, 2);
+		}
+		mewa::LuaDataCopy options;
+		options.assign( ls, 3);
+		BatchRun run;
+		run.units = getBatchUnits( functionName, ls, 4);
+		int nofThreads = 0;
+		if (nargs >= 5 && !lua_isnil( ls, 5))
+		{
+			nofThreads = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 5);
+		}
+		mewa::LuaBatchEnvironment env;
+		env.openlib = luaopen_mewa;
+		env.packagePath = getPackageVariable( ls, "path");
+		env.packageCPath = getPackageVariable( ls, "cpath");
+
+		run.results = mewa::luaRunBatch( *cp, env, target, options, run.units, nofThreads);
 
-			// Map output with target template:
-			cp->outputSectionMap[ "Source"] = filename;
-			cp->outputSectionMap[ "Triple"] = triple;
-			cp->outputSectionMap[ "Code"].append( cp->outputBuffer);
-			std::string output = mewa::template_format( targetptr, '{', '}', cp->outputSectionMap);
-			if (outputfn == "stderr")
-			{
-				std::fputs( output.c_str(), ::stderr);
-			}
-			else if (outputfn == "stdout")
-			{
-				std::puts( output.c_str());
-			}
-			else
-			{
-				mewa::writeFile( std::string(outputfn), output);
-			}
-		}
+		memblock_userdata_t* mb = memblock_userdata_t::create( ls);
+		mewa::ObjectReference<BatchRun>* obj = new mewa::ObjectReference<BatchRun>( std::move( run));
+		mb->memoryBlock = obj;
+		batch = &obj->obj();						// STK: [MEMBLOCK]
+	}
+	catch (...) { lippincottFunction( ls); }
 
-		// Restore old print function that has been left on the stack:
-					//STK: table=_G, key=print, value=function key=debug, value=function
-		lua_settable( ls, -5);	//STK: table=_G, key=print, value=function
-		lua_settable( ls, -3);	//STK: table=_G
-		lua_pop( ls, 1);	//STK:
-		cp->closeOutput();
-		lua_pop( ls, 3);	// ... destroy strings on lua stack created with move_string_on_lua_stack and options
+	lua_createtable( ls, batch->results.size(), 0);			// STK: [MEMBLOCK] [RESULTS]
+	for (std::size_t ridx = 0; ridx < batch->results.size(); ++ridx)
+	{
+		const mewa::LuaBatchUnit& unit = batch->units[ ridx];
+		const mewa::LuaBatchResult& result = batch->results[ ridx];
 
-		if (g_called_deprecated_get_types)
+		lua_createtable( ls, 0, 3);
+		lua_pushstring( ls, unit.input.c_str());
+		lua_setfield( ls, -2, "input");
+		lua_pushboolean( ls, result.ok);
+		lua_setfield( ls, -2, "ok");
+		if (!result.ok)
 		{
-			std::cerr << "Warning: Called deprecated function typedb:get_types. This function has been renamed to typedb:this_types (issue #4)" << std::endl;
+			lua_pushlstring( ls, result.error.c_str(), result.error.size());
+			lua_setfield( ls, -2, "error");
 		}
-		if (g_called_deprecated_get_type)
+		else
 		{
-			std::cerr << "Warning: Called deprecated function typedb:get_type. This function has been renamed to typedb:this_type (issue #4)" << std::endl;
+			if (unit.output.empty())
+			{
+				lua_pushlstring( ls, result.output.c_str(), result.output.size());
+				lua_setfield( ls, -2, "output");
+			}
+			if (cp->statistics)
+			{
+				pushCompilerStatistics( ls, result.statistics);
+				lua_setfield( ls, -2, "statistics");
+			}
 		}
+		lua_rawseti( ls, -2, ridx+1);
 	}
-	catch (...) { lippincottFunction( ls); }
-	return 0;
+	lua_replace( ls, -2);	// ... dispose the element created with the results
+	return 1;
 }
 
 static int mewa_new_typedb( lua_State* ls)
 {
 	[[maybe_unused]] static const char* functionName = "mewa.typedb";
+	const char* recordFilename = nullptr;
 	try
 	{
-		mewa::lua::checkNofArguments( functionName, ls, 0/*minNofArgs*/, 0/*maxNofArgs*/);
+		int nargs = mewa::lua::checkNofArguments( functionName, ls, 0/*minNofArgs*/, 1/*maxNofArgs*/);
+		if (nargs >= 1 && !lua_isnil( ls, 1))
+		{
+			recordFilename = mewa::lua::getArgumentAsCString( functionName, ls, 1);
+		}
+		else
+		{
+			recordFilename = std::getenv( "MEWA_TYPEDB_RECORD");
+			if (recordFilename && !recordFilename[0]) recordFilename = nullptr;
+		}
 	}
 	catch (...) { lippincottFunction( ls); }
 
@@ -519,7 +1167,7 @@ static int mewa_new_typedb( lua_State* ls)
 	td->init();
 	try
 	{
-		td->create();
+		td->create( recordFilename);
 	}
 	catch (...) { lippincottFunction( ls); }
 
@@ -594,6 +1242,7 @@ static int mewa_typedb_this_instance( lua_State* ls)
 		mewa::lua::checkNofArguments( functionName, ls, 2/*minNofArgs*/, 2/*maxNofArgs*/);
 		mewa::lua::checkStack( functionName, ls, 4);
 		std::string_view name = mewa::lua::getArgumentAsString( functionName, ls, 2);
+		if (td->recorder) td->recorder->getObjectInstanceOfScope( name, td->curScope);
 		handle = td->impl->getObjectInstanceOfScope( name, td->curScope);
 	}
 	catch (...) { lippincottFunction( ls); }
@@ -620,6 +1269,7 @@ static int mewa_typedb_get_instance( lua_State* ls)
 		mewa::lua::checkNofArguments( functionName, ls, 2/*minNofArgs*/, 2/*maxNofArgs*/);
 		mewa::lua::checkStack( functionName, ls, 4);
 		std::string_view name = mewa::lua::getArgumentAsString( functionName, ls, 2);
+		if (td->recorder) td->recorder->getObjectInstance( name, td->curStep);
 		handle = td->impl->getObjectInstance( name, td->curStep);
 	}
 	catch (...) { lippincottFunction( ls); }
@@ -657,6 +1307,7 @@ static int mewa_typedb_set_instance( lua_State* ls)
 
 	try
 	{
+		if (td->recorder) td->recorder->setObjectInstance( name, td->curScope, handle);
 		td->impl->setObjectInstance( name, td->curScope, handle);
 	}
 	catch (...) { lippincottFunction( ls); }
@@ -703,6 +1354,7 @@ static int mewa_typedb_def_type( lua_State* ls)
 		std::pmr::vector<mewa::TypeDatabase::TypeConstructorPair> parameter;
 		if (nargs >= 5 && !lua_isnil(ls,5)) parameter = mewa::lua::getArgumentAsTypeConstructorPairList( functionName, ls, 5, &memrsc_parameter);
 		lua_pop( ls, 1); // ... obj table
+		if (td->recorder) td->recorder->defineType( td->curScope, contextType, name, constructor, parameter);
 		int rt = td->impl->defineType( td->curScope, contextType, name, constructor, parameter);
 		lua_pushinteger( ls, rt);
 	}
@@ -724,6 +1376,7 @@ static int mewa_typedb_def_type_as( lua_State* ls)
 		int contextType = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 2);
 		std::string_view name = mewa::lua::getArgumentAsString( functionName, ls, 3);
 		int asType = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 4);
+		if (td->recorder) td->recorder->defineTypeAs( td->curScope, contextType, name, asType);
 		int rt = td->impl->defineTypeAs( td->curScope, contextType, name, asType);
 		lua_pushinteger( ls, rt);
 	}
@@ -746,6 +1399,7 @@ static int mewa_typedb_this_type( lua_State* ls)
 		std::string_view name = mewa::lua::getArgumentAsString( functionName, ls, 3);
 		std::pmr::vector<int> parameter;
 		if (nargs >= 4 && !lua_isnil(ls,4)) parameter = mewa::lua::getArgumentAsTypeList( functionName, ls, 4, &memrsc_parameter, true/*allow t/c pairs*/);
+		if (td->recorder) td->recorder->getType( td->curScope, contextType, name, parameter);
 		int rt = td->impl->getType( td->curScope, contextType, name, parameter);
 		if (!rt) return 0;
 		lua_pushinteger( ls, rt);
@@ -768,6 +1422,7 @@ static int mewa_typedb_this_types( lua_State* ls)
 		int contextType = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 2);
 		std::string_view name = mewa::lua::getArgumentAsString( functionName, ls, 3);
 		mewa::TypeDatabase::ResultBuffer resbuf;
+		if (td->recorder) td->recorder->getTypes( td->curScope, contextType, name);
 		auto rt = td->impl->getTypes( td->curScope, contextType, name, resbuf);
 		mewa::lua::pushTypeList( ls, functionName, rt.types);
 	}
@@ -799,6 +1454,7 @@ static int mewa_typedb_def_reduction( lua_State* ls)
 		int constructor = mewa::lua::getArgumentAsConstructor( functionName, ls, 4);
 		int tag = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 5);
 		float weight = (nargs >= 6 && !lua_isnil(ls,6)) ? mewa::lua::getArgumentAsFloatingPoint( functionName, ls, 6) : 0.0;
+		if (td->recorder) td->recorder->defineReduction( td->curScope, toType, fromType, constructor, tag, weight);
 		td->impl->defineReduction( td->curScope, toType, fromType, constructor, tag, weight);
 	}
 	catch (...) { lippincottFunction( ls); }
@@ -817,6 +1473,7 @@ static int mewa_typedb_get_reduction( lua_State* ls)
 		int fromType = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 3);
 		mewa::TagMask selectTags( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchAll());
 
+		if (td->recorder) td->recorder->getReduction( td->curStep, toType, fromType, selectTags);
 		auto redu = td->impl->getReduction( td->curStep, toType, fromType, selectTags);
 		if (!redu.defined()) return 0;
 		lua_pushnumber( ls, redu.weight);
@@ -841,6 +1498,7 @@ static int mewa_typedb_get_reductions( lua_State* ls)
 		mewa::TagMask selectTagsCount( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchNothing());
 
 		mewa::TypeDatabase::ResultBuffer resbuf;
+		if (td->recorder) td->recorder->getReductions( td->curStep, type, selectTags, selectTagsCount);
 		auto res = td->impl->getReductions( td->curStep, type, selectTags, selectTagsCount, resbuf);
 		mewa::lua::pushWeightedReductions( ls, functionName, res.reductions);
 	}
@@ -848,6 +1506,61 @@ static int mewa_typedb_get_reductions( lua_State* ls)
 	return 1;
 }
 
+/// \brief Push the result of a derivation as list of type/constructor pairs with the additional fields 'weight' and 'conflict'
+static void pushDeriveResultTable(
+		lua_State* ls, const char* functionName, const mewa::TypeDatabase::TypeConstructorPairList& reductions,
+		float weightsum, int const* conflictPath, int conflictPathSize)
+{
+	mewa::lua::pushTypeConstructorPairs( ls, functionName, reductions);	// STK: [REDUS]
+	lua_pushnumber( ls, weightsum);
+	lua_setfield( ls, -2, "weight");
+	if (conflictPathSize)
+	{
+		lua_createtable( ls, conflictPathSize/*narr*/, 0/*nrec*/);	// STK: [REDUS] [CONFLICT]
+		for (int ci = 0; ci < conflictPathSize; ++ci)
+		{
+			lua_pushinteger( ls, conflictPath[ ci]);
+			lua_rawseti( ls, -2, ci+1);
+		}
+		lua_setfield( ls, -2, "conflict");				// STK: [REDUS]
+	}
+}
+
+static int deriveTypeTargets( lua_State* ls, const char* functionName, mewa_typedb_userdata_t* td, int nargs)
+{
+	int buffer_parameter[ 1024];
+	mewa::monotonic_buffer_resource memrsc_parameter( buffer_parameter, sizeof buffer_parameter);
+	std::pmr::vector<int> toTypes = mewa::lua::getArgumentAsTypeList( functionName, ls, 2, &memrsc_parameter, false/*allow t/c pairs*/);
+	int fromType = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 3);
+	mewa::TagMask selectTags( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchAll());
+	mewa::TagMask selectTagsCount( nargs >= 5 && !lua_isnil(ls,5) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 5) : mewa::TagMask::matchNothing());
+	int maxPathLen = nargs >= 6 && !lua_isnil(ls,6) ? mewa::lua::getArgumentAsInteger( functionName, ls, 6) : 1;
+	mewa::TypeDatabase::ResultBuffer resbuf;
+	if (td->recorder) td->recorder->deriveTypeTargets( td->curStep, toTypes, fromType, selectTags, selectTagsCount, maxPathLen);
+	auto deriveres = td->impl->deriveTypeTargets( td->curStep, toTypes, fromType, selectTags, selectTagsCount, maxPathLen, resbuf);
+
+	lua_createtable( ls, deriveres.targets.size()/*narr*/, 0/*nrec*/);		// STK: [RESULTS]
+	int tidx = 0;
+	for (auto const& target : deriveres.targets)
+	{
+		if (target.defined)
+		{
+			pushDeriveResultTable( ls, functionName,
+						mewa::TypeDatabase::TypeConstructorPairList(
+							target.reductionsEnd - target.reductionsStart, deriveres.reductions.data() + target.reductionsStart),
+						target.weightsum, deriveres.conflictPaths.data() + target.conflictStart, target.conflictEnd - target.conflictStart);
+		}
+		else
+		{
+			lua_pushboolean( ls, 0);
+		}
+		lua_rawseti( ls, -2, ++tidx);						// STK: [RESULTS]
+	}
+	if (deriveres.nearest < 0) return 1;
+	lua_pushinteger( ls, deriveres.nearest+1);					// STK: [RESULTS] [NEAREST]
+	return 2;
+}
+
 static int mewa_typedb_derive_type( lua_State* ls)
 {
 	[[maybe_unused]] static const char* functionName = "typedb:derive_type";
@@ -856,12 +1569,17 @@ static int mewa_typedb_derive_type( lua_State* ls)
 	{
 		int nargs = mewa::lua::checkNofArguments( functionName, ls, 3/*minNofArgs*/, 6/*maxNofArgs*/);
 		mewa::lua::checkStack( functionName, ls, 8);
+		if (lua_type( ls, 2) == LUA_TTABLE)
+		{
+			return deriveTypeTargets( ls, functionName, td, nargs);
+		}
 		int toType = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 2);
 		int fromType = mewa::lua::getArgumentAsUnsignedInteger( functionName, ls, 3);
 		mewa::TagMask selectTags( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchAll());
 		mewa::TagMask selectTagsCount( nargs >= 5 && !lua_isnil(ls,5) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 5) : mewa::TagMask::matchNothing());
 		int maxPathLen = nargs >= 6 && !lua_isnil(ls,6) ? mewa::lua::getArgumentAsInteger( functionName, ls, 6) : 1;
 		mewa::TypeDatabase::ResultBuffer resbuf;
+		if (td->recorder) td->recorder->deriveType( td->curStep, toType, fromType, selectTags, selectTagsCount, maxPathLen);
 		auto deriveres = td->impl->deriveType( td->curStep, toType, fromType, selectTags, selectTagsCount, maxPathLen, resbuf);
 		if (deriveres.defined)
 		{
@@ -886,6 +1604,264 @@ static int mewa_typedb_derive_type( lua_State* ls)
 	return 0;
 }
 
+static int mewa_typedb_derive_types( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:derive_types";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		int nargs = mewa::lua::checkNofArguments( functionName, ls, 2/*minNofArgs*/, 5/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 8);
+		mewa::lua::checkArgumentAsTable( functionName, ls, 2);
+		mewa::TagMask selectTags( nargs >= 3 && !lua_isnil(ls,3) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 3) : mewa::TagMask::matchAll());
+		mewa::TagMask selectTagsCount( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchNothing());
+		int maxPathLen = nargs >= 5 && !lua_isnil(ls,5) ? mewa::lua::getArgumentAsInteger( functionName, ls, 5) : 1;
+
+		int nofPairs = lua_rawlen( ls, 2);
+		lua_createtable( ls, nofPairs/*narr*/, 0/*nrec*/);				// STK: [RESULTS]
+		for (int pi = 1; pi <= nofPairs; ++pi)
+		{
+			lua_rawgeti( ls, 2, pi);						// STK: [RESULTS] [PAIR]
+			if (lua_type( ls, -1) != LUA_TTABLE) mewa::lua::throwArgumentError( functionName, 2, mewa::Error::ExpectedArgumentTypeList);
+			lua_rawgeti( ls, -1, 1);						// STK: [RESULTS] [PAIR] [TO]
+			lua_rawgeti( ls, -2, 2);						// STK: [RESULTS] [PAIR] [TO] [FROM]
+			if (!lua_isinteger( ls, -2) || !lua_isinteger( ls, -1)) mewa::lua::throwArgumentError( functionName, 2, mewa::Error::ExpectedArgumentTypeList);
+			int toType = lua_tointeger( ls, -2);
+			int fromType = lua_tointeger( ls, -1);
+			lua_pop( ls, 3);							// STK: [RESULTS]
+
+			mewa::TypeDatabase::ResultBuffer resbuf;
+			if (td->recorder) td->recorder->deriveType( td->curStep, toType, fromType, selectTags, selectTagsCount, maxPathLen);
+			auto deriveres = td->impl->deriveType( td->curStep, toType, fromType, selectTags, selectTagsCount, maxPathLen, resbuf);
+			if (deriveres.defined)
+			{
+				pushDeriveResultTable( ls, functionName, deriveres.reductions,
+							deriveres.weightsum, deriveres.conflictPath.data(), deriveres.conflictPath.size());	// STK: [RESULTS] [REDUS]
+			}
+			else
+			{
+				lua_pushboolean( ls, 0);						// STK: [RESULTS] false
+			}
+			lua_rawseti( ls, -2, pi);						// STK: [RESULTS]
+		}
+		return 1;
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static mewa::TypeDatabase::WeightAccumulation getArgumentAsWeightAccumulation( const char* functionName, lua_State* ls, int li)
+{
+	std::string_view value = mewa::lua::getArgumentAsString( functionName, ls, li);
+	if (value == "sum")
+	{
+		return mewa::TypeDatabase::AccumulateSum;
+	}
+	else if (value == "max")
+	{
+		return mewa::TypeDatabase::AccumulateMax;
+	}
+	throw mewa::Error( mewa::Error::ExpectedStringArgument, mewa::string_format( "%s [%d] expected \"sum\" or \"max\"", functionName, li));
+}
+
+static int mewa_typedb_resolve_callable( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:resolve_callable";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		int nargs = mewa::lua::checkNofArguments( functionName, ls, 3/*minNofArgs*/, 8/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 12);
+
+		int buffer_parameter[ 1024];
+		mewa::monotonic_buffer_resource memrsc_parameter( buffer_parameter, sizeof buffer_parameter);
+		std::pmr::vector<int> items = mewa::lua::getArgumentAsTypeList( functionName, ls, 2, &memrsc_parameter, false/*allow t/c pairs*/);
+		std::pmr::vector<int> argTypes = mewa::lua::getArgumentAsTypeList( functionName, ls, 3, &memrsc_parameter, true/*allow t/c pairs*/);
+		mewa::TagMask selectTags( nargs >= 4 && !lua_isnil(ls,4) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 4) : mewa::TagMask::matchAll());
+		mewa::TagMask selectTagsCount( nargs >= 5 && !lua_isnil(ls,5) ? mewa::lua::getArgumentAsTagMask( functionName, ls, 5) : mewa::TagMask::matchNothing());
+		int maxPathLen = nargs >= 6 && !lua_isnil(ls,6) ? mewa::lua::getArgumentAsInteger( functionName, ls, 6) : 1;
+		float minWeight = nargs >= 7 && !lua_isnil(ls,7) ? mewa::lua::getArgumentAsFloatingPoint( functionName, ls, 7) : -1.0;
+		auto accumulation = nargs >= 8 && !lua_isnil(ls,8) ? getArgumentAsWeightAccumulation( functionName, ls, 8) : mewa::TypeDatabase::AccumulateSum;
+
+		mewa::TypeDatabase::ResultBuffer resbuf;
+		if (td->recorder) td->recorder->resolveCallable( td->curStep, items, argTypes, selectTags, selectTagsCount, maxPathLen, accumulation, minWeight);
+		auto res = td->impl->resolveCallable( td->curStep, items, argTypes, selectTags, selectTagsCount, maxPathLen, accumulation, minWeight, resbuf);
+		if (!res.defined()) return 0;
+
+		lua_pushnumber( ls, res.weight);						// STK: [WEIGHT]
+		lua_createtable( ls, res.items.size()/*narr*/, 0/*nrec*/);			// STK: [WEIGHT] [CANDIDATES]
+		for (std::size_t ci = 0; ci < res.items.size(); ++ci)
+		{
+			lua_createtable( ls, 0/*narr*/, 3/*nrec*/);				// STK: [WEIGHT] [CANDIDATES] [CANDIDATE]
+			lua_pushinteger( ls, res.items[ ci]);
+			lua_setfield( ls, -2, "type");
+			lua_createtable( ls, res.nofArguments/*narr*/, 0/*nrec*/);		// STK: [WEIGHT] [CANDIDATES] [CANDIDATE] [REDULISTS]
+			bool hasConflicts = false;
+			for (int ai = 0; ai < res.nofArguments; ++ai)
+			{
+				int ri = ci * res.nofArguments + ai;
+				mewa::TypeDatabase::TypeConstructorPairList redulist(
+						res.reductionRanges[ ri+1] - res.reductionRanges[ ri], res.reductions.data() + res.reductionRanges[ ri]);
+				mewa::lua::pushTypeConstructorPairs( ls, functionName, redulist);	// STK: [WEIGHT] [CANDIDATES] [CANDIDATE] [REDULISTS] [REDUS]
+				lua_rawseti( ls, -2, ai+1);						// STK: [WEIGHT] [CANDIDATES] [CANDIDATE] [REDULISTS]
+				if (res.conflictRanges[ ri+1] > res.conflictRanges[ ri]) hasConflicts = true;
+			}
+			lua_setfield( ls, -2, "reductions");					// STK: [WEIGHT] [CANDIDATES] [CANDIDATE]
+			if (hasConflicts)
+			{
+				lua_createtable( ls, 0/*narr*/, 1/*nrec*/);			// STK: [WEIGHT] [CANDIDATES] [CANDIDATE] [CONFLICTS]
+				for (int ai = 0; ai < res.nofArguments; ++ai)
+				{
+					int ri = ci * res.nofArguments + ai;
+					if (res.conflictRanges[ ri+1] > res.conflictRanges[ ri])
+					{
+						lua_createtable( ls, res.conflictRanges[ ri+1] - res.conflictRanges[ ri]/*narr*/, 0/*nrec*/);
+						int tidx = 0;
+						for (int pi = res.conflictRanges[ ri]; pi < res.conflictRanges[ ri+1]; ++pi)
+						{
+							lua_pushinteger( ls, res.conflictPaths[ pi]);
+							lua_rawseti( ls, -2, ++tidx);
+						}
+						lua_rawseti( ls, -2, ai+1);				// STK: [WEIGHT] [CANDIDATES] [CANDIDATE] [CONFLICTS]
+					}
+				}
+				lua_setfield( ls, -2, "conflicts");				// STK: [WEIGHT] [CANDIDATES] [CANDIDATE]
+			}
+			lua_rawseti( ls, -2, ci+1);						// STK: [WEIGHT] [CANDIDATES]
+		}
+		return 2;
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static void pushCacheStatistics( lua_State* ls, const mewa::TypeDatabase::CacheStatistics& stats)
+{
+	lua_createtable( ls, 0/*narr*/, 3/*nrec*/);
+	lua_pushinteger( ls, stats.hits);
+	lua_setfield( ls, -2, "hits");
+	lua_pushinteger( ls, stats.misses);
+	lua_setfield( ls, -2, "misses");
+	lua_pushinteger( ls, stats.size);
+	lua_setfield( ls, -2, "size");
+}
+
+static int mewa_typedb_freeze_reductions( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:freeze_reductions";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 1/*maxNofArgs*/);
+		if (td->recorder) td->recorder->freezeReductions();
+		td->impl->freezeReductions();
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static int mewa_typedb_freeze( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:freeze";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 1/*maxNofArgs*/);
+		if (td->recorder) td->recorder->freeze();
+		td->impl->freeze();
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static int mewa_typedb_cache_statistics( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:cache_statistics";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 1/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 6);
+		lua_createtable( ls, 0/*narr*/, 3/*nrec*/);
+		pushCacheStatistics( ls, td->impl->deriveTypeCacheStatistics());
+		lua_setfield( ls, -2, "derive_type");
+		pushCacheStatistics( ls, td->impl->resolveTypeCacheStatistics());
+		lua_setfield( ls, -2, "resolve_type");
+		pushCacheStatistics( ls, td->impl->reductionIndexStatistics());
+		lua_setfield( ls, -2, "reduction_index");
+		return 1;
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
+static void pushMemoryStatistics( lua_State* ls, const mewa::TypeDatabase::MemoryStatistics& stats)
+{
+	lua_createtable( ls, 0/*narr*/, 3/*nrec*/);
+	lua_pushinteger( ls, stats.used);
+	lua_setfield( ls, -2, "used");
+	lua_pushinteger( ls, stats.size);
+	lua_setfield( ls, -2, "size");
+	lua_pushinteger( ls, stats.upstream);
+	lua_setfield( ls, -2, "upstream");
+}
+
+static int mewa_typedb_stats( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "typedb:stats";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 1/*minNofArgs*/, 1/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, 8);
+		auto stats = td->impl->statistics();
+
+		lua_createtable( ls, 0/*narr*/, 7/*nrec*/);				// STK: [STATS]
+		lua_pushinteger( ls, stats.nofTypes);
+		lua_setfield( ls, -2, "types");
+		lua_pushinteger( ls, stats.nofReductions);
+		lua_setfield( ls, -2, "reductions");
+		lua_pushinteger( ls, stats.nofIdentifiers);
+		lua_setfield( ls, -2, "identifiers");
+		lua_pushinteger( ls, stats.nofObjectInstances);
+		lua_setfield( ls, -2, "instances");
+
+		lua_createtable( ls, 0/*narr*/, 5/*nrec*/);				// STK: [STATS] [MEMORY]
+		pushMemoryStatistics( ls, stats.identmap);
+		lua_setfield( ls, -2, "identmap");
+		pushMemoryStatistics( ls, stats.identstr);
+		lua_setfield( ls, -2, "identstr");
+		pushMemoryStatistics( ls, stats.typetab);
+		lua_setfield( ls, -2, "typetab");
+		pushMemoryStatistics( ls, stats.redutab);
+		lua_setfield( ls, -2, "redutab");
+		pushMemoryStatistics( ls, stats.objtab);
+		lua_setfield( ls, -2, "objtab");
+		lua_setfield( ls, -2, "memory");					// STK: [STATS]
+
+		bool spilled = stats.identmap.upstream || stats.identstr.upstream || stats.typetab.upstream
+				|| stats.redutab.upstream || stats.objtab.upstream;
+		lua_pushboolean( ls, spilled);
+		lua_setfield( ls, -2, "spilled");
+
+		lua_createtable( ls, 0/*narr*/, 5/*nrec*/);				// STK: [STATS] [QUERIES]
+		lua_pushinteger( ls, stats.deriveTypeCalls);
+		lua_setfield( ls, -2, "derive_type");
+		lua_pushinteger( ls, stats.resolveTypeCalls);
+		lua_setfield( ls, -2, "resolve_type");
+		lua_pushinteger( ls, stats.nodesExpanded);
+		lua_setfield( ls, -2, "nodes_expanded");
+		lua_pushinteger( ls, stats.queuePushes);
+		lua_setfield( ls, -2, "queue_pushes");
+		lua_pushinteger( ls, stats.conflicts);
+		lua_setfield( ls, -2, "conflicts");
+		lua_setfield( ls, -2, "queries");					// STK: [STATS]
+		return 1;
+	}
+	catch (...) { lippincottFunction( ls); }
+	return 0;
+}
+
 static int mewa_typedb_resolve_type( lua_State* ls)
 {
 	[[maybe_unused]] static const char* functionName = "typedb:resolve_type";
@@ -905,12 +1881,14 @@ static int mewa_typedb_resolve_type( lua_State* ls)
 			mewa::monotonic_buffer_resource memrsc_parameter( buffer_parameter, sizeof buffer_parameter);
 
 			std::pmr::vector<int> contextTypes = mewa::lua::getArgumentAsTypeList( functionName, ls, 2, &memrsc_parameter, true/*allow t/c pairs*/);
+			if (td->recorder) td->recorder->resolveType( td->curStep, contextTypes, name, selectTags);
 			auto resolveres = td->impl->resolveType( td->curStep, contextTypes, name, selectTags, resbuf);
 			return mewa::lua::pushResolveResult( ls, functionName, 2/*root context argument lua index*/, resolveres);
 		}
 		else
 		{
 			int contextType = mewa::lua::getArgumentAsType( functionName, ls, 2);
+			if (td->recorder) td->recorder->resolveType( td->curStep, contextType, name, selectTags);
 			auto resolveres = td->impl->resolveType( td->curStep, contextType, name, selectTags, resbuf);
 			return mewa::lua::pushResolveResult( ls, functionName, 0/*root context argument lua index*/, resolveres);
 		}
@@ -946,10 +1924,9 @@ static int mewa_typedb_type_string( lua_State* ls)
 		mewa::lua::checkStack( functionName, ls, 2);
 		int type = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, 2);
 		const char* sep = (nargs >= 3 && !lua_isnil(ls,3)) ? mewa::lua::getArgumentAsCString( functionName, ls, 3) : " "/*default separator*/;
-		mewa::TypeDatabase::ResultBuffer resbuf;
 
-		auto rt = td->impl->typeToString( type, sep, resbuf);
-		lua_pushlstring( ls, rt.c_str(), rt.size());
+		std::string_view rt = td->impl->typeString( type, sep);
+		lua_pushlstring( ls, rt.data(), rt.size());
 	}
 	catch (...) { lippincottFunction( ls); }
 	return 1;
@@ -1253,6 +2230,188 @@ static int mewa_objtree_instance( lua_State* ls)
 	return 1;
 }
 
+static void setTraversalScope( const char* functionName, lua_State* ls, mewa_typedb_userdata_t* td, int li)
+{
+	try
+	{
+		td->curScope = mewa::lua::getArgumentAsScope( functionName, ls, li);
+		td->curStep = td->curScope.end()-1;
+	}
+	catch (...) { lippincottFunction( ls); }
+}
+
+static void setTraversalStep( const char* functionName, lua_State* ls, mewa_typedb_userdata_t* td, int li)
+{
+	try
+	{
+		td->curStep = mewa::lua::getArgumentAsNonNegativeInteger( functionName, ls, li);
+	}
+	catch (...) { lippincottFunction( ls); }
+}
+
+static void setTraversalNodeInstance( lua_State* ls, mewa_typedb_userdata_t* td, int subnode)
+{
+	// Get a reference handle of the node in the registry:
+	lua_pushvalue( ls, subnode);
+	int handle = luaL_ref( ls, LUA_REGISTRYINDEX);
+	try
+	{
+		if (td->recorder) td->recorder->setObjectInstance( "node", td->curScope, handle);
+		td->impl->setObjectInstance( "node", td->curScope, handle);
+	}
+	catch (...) { lippincottFunction( ls); }
+}
+
+/// \brief Call the function of an AST node with the current scope or step of the type database set to the scope or step of the node
+///	and push its result on the stack, or push the value of the node if it is a leaf.
+/// \note Implements the function 'processSubnode' of examples/typesystem_utils.lua
+static void traverseSubnode( const char* functionName, lua_State* ls, mewa_typedb_userdata_t* td, int subnode, int firstarg, int nofargs)
+{
+	lua_getfield( ls, subnode, "call");				// STK: [CALL]
+	if (lua_isnil( ls, -1))
+	{
+		lua_pop( ls, 1);					// STK:
+		lua_getfield( ls, subnode, "value");			// STK: [VALUE]
+		return;
+	}
+	mewa::Scope scope_bk = td->curScope;
+	mewa::Scope::Step step_bk = td->curStep;
+	bool hasScope = false;
+	bool hasStep = false;
+
+	lua_getfield( ls, subnode, "scope");				// STK: [CALL] [SCOPE]
+	if (!lua_isnil( ls, -1))
+	{
+		hasScope = true;
+		setTraversalScope( functionName, ls, td, lua_gettop( ls));
+		setTraversalNodeInstance( ls, td, subnode);
+	}
+	else
+	{
+		lua_pop( ls, 1);					// STK: [CALL]
+		lua_getfield( ls, subnode, "step");			// STK: [CALL] [STEP]
+		if (!lua_isnil( ls, -1))
+		{
+			hasStep = true;
+			setTraversalStep( functionName, ls, td, lua_gettop( ls));
+		}
+	}
+	lua_pop( ls, 1);						// STK: [CALL]
+	lua_getfield( ls, -1, "proc");					// STK: [CALL] [PROC]
+	lua_pushvalue( ls, subnode);					// STK: [CALL] [PROC] [NODE]
+	lua_getfield( ls, -3, "obj");					// STK: [CALL] [PROC] [NODE] [OBJ]
+	int nofparams = 1 + nofargs;
+	if (lua_toboolean( ls, -1))
+	{
+		++nofparams;
+	}
+	else
+	{
+		lua_pop( ls, 1);					// STK: [CALL] [PROC] [NODE]
+	}
+	for (int ai = 0; ai < nofargs; ++ai)
+	{
+		lua_pushvalue( ls, firstarg + ai);			// STK: [CALL] [PROC] [NODE] [OBJ] [ARG]..
+	}
+	lua_call( ls, nofparams, 1);					// STK: [CALL] [RESULT]
+	lua_remove( ls, -2);						// STK: [RESULT]
+	if (hasScope)
+	{
+		td->curScope = scope_bk;
+		td->curStep = step_bk;
+	}
+	else if (hasStep)
+	{
+		td->curStep = step_bk;
+	}
+}
+
+static void getTraversalRange( const char* functionName, lua_State* ls, int li, long& start, long& last)
+{
+	try
+	{
+		mewa::lua::checkArgumentAsTable( functionName, ls, li);
+		lua_rawgeti( ls, li, 1);
+		lua_rawgeti( ls, li, 2);
+		start = mewa::lua::getArgumentAsInteger( functionName, ls, -2);
+		last = mewa::lua::getArgumentAsInteger( functionName, ls, -1);
+		lua_pop( ls, 2);
+	}
+	catch (...) { lippincottFunction( ls); }
+}
+
+static int mewa_traverse( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "mewa.traverse( typedb, node, ...)";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	int nargs = lua_gettop( ls);
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 2/*minNofArgs*/, std::numeric_limits<int>::max()/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, nargs + 8);
+	}
+	catch (...) { lippincottFunction( ls); }
+
+	lua_getfield( ls, 2, "arg");					// STK: [ARG]
+	if (lua_isnil( ls, -1))
+	{
+		lua_getfield( ls, 2, "value");				// STK: [ARG] [VALUE]
+		return 1;
+	}
+	int argtable = lua_gettop( ls);
+	lua_newtable( ls);						// STK: [ARG] [RT]
+	for (int ii = 1;; ++ii)
+	{
+		lua_pushinteger( ls, ii);
+		lua_gettable( ls, argtable);				// STK: [ARG] [RT] [SUBNODE]
+		if (lua_isnil( ls, -1))
+		{
+			lua_pop( ls, 1);				// STK: [ARG] [RT]
+			break;
+		}
+		traverseSubnode( functionName, ls, td, lua_gettop( ls), 3/*firstarg*/, nargs - 2);	// STK: [ARG] [RT] [SUBNODE] [RESULT]
+		lua_rawseti( ls, -3, ii);				// STK: [ARG] [RT] [SUBNODE]
+		lua_pop( ls, 1);					// STK: [ARG] [RT]
+	}
+	return 1;
+}
+
+static int mewa_traverseRange( lua_State* ls)
+{
+	[[maybe_unused]] static const char* functionName = "mewa.traverseRange( typedb, node, range, ...)";
+	mewa_typedb_userdata_t* td = (mewa_typedb_userdata_t*)luaL_checkudata( ls, 1, mewa_typedb_userdata_t::metatableName());
+	int nargs = lua_gettop( ls);
+	try
+	{
+		mewa::lua::checkNofArguments( functionName, ls, 3/*minNofArgs*/, std::numeric_limits<int>::max()/*maxNofArgs*/);
+		mewa::lua::checkStack( functionName, ls, nargs + 8);
+	}
+	catch (...) { lippincottFunction( ls); }
+
+	lua_getfield( ls, 2, "arg");					// STK: [ARG]
+	if (lua_isnil( ls, -1))
+	{
+		lua_getfield( ls, 2, "value");				// STK: [ARG] [VALUE]
+		return 1;
+	}
+	int argtable = lua_gettop( ls);
+	long start = 0;
+	long last = 0;
+	getTraversalRange( functionName, ls, 3, start, last);
+	long lasti = last - start + 1;
+	long ofs = start - 1;
+
+	lua_newtable( ls);						// STK: [ARG] [RT]
+	for (long ii = 1; ii <= lasti; ++ii)
+	{
+		lua_pushinteger( ls, ofs + ii);
+		lua_gettable( ls, argtable);				// STK: [ARG] [RT] [SUBNODE]
+		traverseSubnode( functionName, ls, td, lua_gettop( ls), 4/*firstarg*/, nargs - 3);	// STK: [ARG] [RT] [SUBNODE] [RESULT]
+		lua_rawseti( ls, -3, ii);				// STK: [ARG] [RT] [SUBNODE]
+		lua_pop( ls, 1);					// STK: [ARG] [RT]
+	}
+	return 1;
+}
 
 static const struct luaL_Reg memblock_control_methods[] = {
 	{ "__gc",	destroy_memblock },
@@ -1273,6 +2432,8 @@ static const struct luaL_Reg mewa_compiler_methods[] = {
 	{ "__gc",		mewa_destroy_compiler },
 	{ "__tostring",		mewa_compiler_tostring },
 	{ "run",		mewa_compiler_run },
+	{ "check",		mewa_compiler_check },
+	{ "run_batch",		mewa_compiler_run_batch },
 	{ nullptr,		nullptr }
 };
 
@@ -1292,7 +2453,13 @@ static const struct luaL_Reg mewa_typedb_methods[] = {
 	{ "def_reduction",	mewa_typedb_def_reduction },
 	{ "reduction_tagmask",	mewa_typedb_reduction_tagmask },
 	{ "derive_type",	mewa_typedb_derive_type },
+	{ "derive_types",	mewa_typedb_derive_types },
 	{ "resolve_type",	mewa_typedb_resolve_type },
+	{ "resolve_callable",	mewa_typedb_resolve_callable },
+	{ "freeze_reductions",	mewa_typedb_freeze_reductions },
+	{ "freeze",		mewa_typedb_freeze },
+	{ "cache_statistics",	mewa_typedb_cache_statistics },
+	{ "stats",		mewa_typedb_stats },
 	{ "type_name",		mewa_typedb_type_name },
 	{ "type_string",	mewa_typedb_type_string },
 	{ "type_context",	mewa_typedb_type_context },
@@ -1340,6 +2507,8 @@ static const struct luaL_Reg mewa_functions[] = {
 	{ "llvm_float_tohex",	mewa_llvm_float_tohex },
 	{ "llvm_double_tohex",	mewa_llvm_double_tohex },
 	{ "stacktrace",		mewa_stacktrace },
+	{ "traverse",		mewa_traverse },
+	{ "traverseRange",	mewa_traverseRange },
 	{ nullptr,  		nullptr }
 };
 
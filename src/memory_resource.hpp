@@ -57,13 +57,13 @@ class monotonic_buffer_resource : public std::pmr::memory_resource
 {
 public:
 	monotonic_buffer_resource( std::size_t initsize, std::pmr::memory_resource* upstream_)
-		:m_baseptr(nullptr),m_index(0),m_size(initsize),m_upstream(upstream_),m_ownership_upstream(false),m_ownership_baseptr(true)
+		:m_baseptr(nullptr),m_index(0),m_size(initsize),m_upstream(upstream_),m_ownership_upstream(false),m_ownership_baseptr(true),m_upstreamBytes(0)
 	{
 		m_baseptr = (char*)std::malloc( m_size);
 		m_ownership_baseptr = m_baseptr != nullptr;
 	}
 	explicit monotonic_buffer_resource( std::size_t initsize)
-		:m_baseptr(nullptr),m_index(0),m_size(initsize),m_upstream(nullptr),m_ownership_upstream(false),m_ownership_baseptr(true)
+		:m_baseptr(nullptr),m_index(0),m_size(initsize),m_upstream(nullptr),m_ownership_upstream(false),m_ownership_baseptr(true),m_upstreamBytes(0)
 	{
 		init_new_upstream();
 		m_baseptr = (char*)std::malloc( m_size);
@@ -76,13 +76,13 @@ public:
 	}
 
 	monotonic_buffer_resource( void* buffer, std::size_t buffersize)
-		:m_baseptr((char*)buffer),m_index(0),m_size(buffersize),m_upstream(nullptr),m_ownership_upstream(false),m_ownership_baseptr(false)
+		:m_baseptr((char*)buffer),m_index(0),m_size(buffersize),m_upstream(nullptr),m_ownership_upstream(false),m_ownership_baseptr(false),m_upstreamBytes(0)
 	{
 		init_new_upstream();
 	}
 
 	monotonic_buffer_resource( void* buffer, std::size_t buffersize, std::pmr::memory_resource* upstream_)
-		:m_baseptr((char*)buffer),m_index(0),m_size(buffersize),m_upstream(upstream_),m_ownership_upstream(false),m_ownership_baseptr(false)
+		:m_baseptr((char*)buffer),m_index(0),m_size(buffersize),m_upstream(upstream_),m_ownership_upstream(false),m_ownership_baseptr(false),m_upstreamBytes(0)
 	{}
 
 	monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
@@ -107,6 +107,22 @@ public:
 		return false;
 	}
 
+	/// \brief Get the number of bytes allocated from the local buffer
+	std::size_t bytesUsed() const noexcept
+	{
+		return m_index < m_size ? m_index : m_size;
+	}
+	/// \brief Get the size of the local buffer in bytes
+	std::size_t bytesAvailable() const noexcept
+	{
+		return m_size;
+	}
+	/// \brief Get the number of bytes allocated from the upstream resource because the local buffer was exhausted
+	std::size_t bytesUpstream() const noexcept
+	{
+		return m_upstreamBytes;
+	}
+
 private:
 	void init_new_upstream()
 	{
@@ -138,7 +154,9 @@ private:
 		skip_align( __alignment);
 		if (m_index + __bytes > m_size)
 		{
-			return m_upstream->allocate( __bytes, __alignment);
+			void* rt = m_upstream->allocate( __bytes, __alignment);
+			m_upstreamBytes += __bytes;
+			return rt;
 		}
 		void* rt = m_baseptr + m_index;
 		m_index += __bytes;
@@ -152,6 +170,7 @@ private:
 	std::pmr::memory_resource* m_upstream;
 	bool m_ownership_upstream;
 	bool m_ownership_baseptr;
+	std::size_t m_upstreamBytes;
 };
 
 }//namespace
@@ -37,6 +37,7 @@ using namespace mewa;
 static void printUsage()
 {
 	std::cerr << "Usage: mewa [-h][-v][-V][-s][-g][-b LUABIN][-o OUTF][-d DBGOUTF][-t TEMPLAT] INPFILE" << std::endl;
+	std::cerr << "       mewa -c [-V] INPFILE SRCFILE..." << std::endl;
 	std::cerr << "Description: Build a lua module implementing a compiler described in\n";
 	std::cerr << "             a Bison/Yacc-like BNF dialect with lua node function calls implementing\n";
 	std::cerr << "             the type system and the code generation.\n";
@@ -56,6 +57,11 @@ static void printUsage()
 	std::cerr << " --generate-language,\n";
 	std::cerr << " -l           : Generate a Lua table with the language description parsed for Lua\n";
 	std::cerr << "                scripts generating descriptions for interfacing with other tools.\n";
+	std::cerr << " --check-syntax,\n";
+	std::cerr << " -c           : Check the syntax of the source files SRCFILE... with the grammar\n";
+	std::cerr << "                in INPFILE. Runs only the lexer and the parser tables, no Lua\n";
+	std::cerr << "                functions are called. Prints the first syntax error of each\n";
+	std::cerr << "                source file to stderr.\n";
 	std::cerr << " --luabin <LUABIN>,\n";
 	std::cerr << " -b <LUABIN>  : Specify the path of the Lua program in the header of generated scripts.\n";
 	std::cerr << " --output <OUTF>,\n";
@@ -67,6 +73,7 @@ static void printUsage()
 	std::cerr << "Arguments:\n";
 	std::cerr << "INPFILE       : Contains the description of the grammar to process\n";
 	std::cerr << "                attributed with the Lua hooks doing the job.\n";
+	std::cerr << "SRCFILE       : Source file to check with option -c\n";
 }
 
 static void printWarning( const std::string& filename, const Error& error)
@@ -154,6 +161,30 @@ static void printAutomaton( const std::string& filename, const std::string& temp
 	}
 }
 
+static bool checkSyntax( const Automaton& automaton, int nofSourceFiles, const char** sourceFiles, bool verbose)
+{
+	bool rt = true;
+	for (int si = 0; si < nofSourceFiles; ++si)
+	{
+		try
+		{
+			std::string source = readFile( sourceFiles[ si]);
+			Scanner scanner( source);
+			automaton.checkSyntax( scanner);
+			if (verbose)
+			{
+				std::cerr << "OK " << sourceFiles[ si] << std::endl;
+			}
+		}
+		catch (const mewa::Error& err)
+		{
+			std::cerr << "ERR " << sourceFiles[ si] << ": " << err.what() << std::endl;
+			rt = false;
+		}
+	}
+	return rt;
+}
+
 int main( int argc, const char* argv[] )
 {
 	try
@@ -163,7 +194,8 @@ int main( int argc, const char* argv[] )
 			NoCommand,
 			GenerateCompilerForLua,
 			GenerateTypesystemTemplateForLua,
-			GenerateLanguageDescriptionForLua
+			GenerateLanguageDescriptionForLua,
+			CheckSyntax
 		};
 		Command cmd = NoCommand;
 		std::string inputFilename;
@@ -219,6 +251,16 @@ int main( int argc, const char* argv[] )
 				}
 				cmd = GenerateLanguageDescriptionForLua;
 			}
+			else if (0==std::strcmp( argv[argi], "-c") || 0==std::strcmp( argv[argi], "--check-syntax"))
+			{
+				if (cmd != NoCommand || !luabin.empty() || !templat.empty() || !outputFilename.empty())
+				{
+					std::cerr << "Conflicting options" << std::endl << std::endl;
+					printUsage();
+					return ERRCODE_INVALID_ARGUMENTS;
+				}
+				cmd = CheckSyntax;
+			}
 			else if (0==std::memcmp( argv[argi], "-b", 2) || 0==std::memcmp( argv[argi], "--luabin=", 9))
 			{
 				if (cmd == GenerateTypesystemTemplateForLua)
@@ -341,13 +383,19 @@ int main( int argc, const char* argv[] )
 			printUsage();
 			return ERRCODE_INVALID_ARGUMENTS;
 		}
-		if (argi + 1 < argc)
+		if (cmd == CheckSyntax && argi + 1 == argc)
+		{
+			std::cerr << "Too few arguments, source files to check expected" << std::endl << std::endl;
+			printUsage();
+			return ERRCODE_INVALID_ARGUMENTS;
+		}
+		if (argi + 1 < argc && cmd != CheckSyntax)
 		{
 			std::cerr << "Too many arguments, only input file expected" << std::endl << std::endl;
 			printUsage();
 			return ERRCODE_INVALID_ARGUMENTS;
 		}
-		if (!outputFilename.empty() && cmd == NoCommand)
+		if (!outputFilename.empty() && (cmd == NoCommand || cmd == CheckSyntax))
 		{
 			std::cerr << "Output file but no action defined, nothing is written to " << outputFilename << std::endl;
 			printUsage();
@@ -400,7 +448,7 @@ int main( int argc, const char* argv[] )
 		{
 			if (debugFilename.empty())
 			{
-				automaton.build( source, warnings, Automaton::DebugOutput().enable( verbose ? Automaton::DebugOutput::All : Automaton::DebugOutput::None));
+				automaton.build( source, warnings, Automaton::DebugOutput().enable( (verbose && cmd != CheckSyntax) ? Automaton::DebugOutput::All : Automaton::DebugOutput::None));
 			}
 			else
 			{
@@ -433,6 +481,12 @@ int main( int argc, const char* argv[] )
 		{
 			case NoCommand:
 				break;
+			case CheckSyntax:
+				if (!checkSyntax( automaton, argc - argi - 1, argv + argi + 1, verbose))
+				{
+					return ERRCODE_RUNTIME_ERROR;
+				}
+				break;
 			case GenerateCompilerForLua:
 				printAutomaton( outputFilename, templat, automaton, luabin);
 				break;
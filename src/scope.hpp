@@ -452,6 +452,12 @@ public:
 		}
 	}
 
+	/// \brief Get the number of scopes with an instance defined
+	std::size_t size() const noexcept
+	{
+		return m_invtree.nextIndex();
+	}
+
 	VALTYPE get( const Scope::Step step) const noexcept
 	{
 		VALTYPE rt = m_invtree.nullval();
@@ -858,7 +864,9 @@ public:
 	ScopedRelationMap( ScopedRelationMap&& o) noexcept = default;
 	ScopedRelationMap& operator=( ScopedRelationMap&& o) noexcept = default;
 
- 	void set( const Scope scope, const RELNODETYPE& left, const RELNODETYPE& right, const VALTYPE& value, int tag, float weight)
+	/// \brief Define a relation
+	/// \return false if an equal relation has already been defined in the same scope and the definition has been ignored
+ 	bool set( const Scope scope, const RELNODETYPE& left, const RELNODETYPE& right, const VALTYPE& value, int tag, float weight)
 	{
 		if (tag > TagMask::MaxTag || tag < TagMask::MinTag) throw Error( Error::BadRelationTag, string_format("%d",tag));
 		if (weight < 0.0) throw Error( Error::BadRelationWeight, string_format("%.4f",weight));
@@ -874,7 +882,7 @@ public:
 			{
 				if (le.value == value)
 				{
-					return; // We allow and ignore duplicate definitions, if they are equal
+					return false; // We allow and ignore duplicate definitions, if they are equal
 				}
 				else
 				{
@@ -889,6 +897,7 @@ public:
 		{
 			m_list[ prev_li].next = newlistindex;
 		}
+		return true;
 	}
 
 	std::pmr::vector<ResultElement> get( const Scope::Step step, const RELNODETYPE& key, const TagMask& selectTags, std::pmr::memory_resource* res_memrsc) const noexcept
@@ -920,6 +929,28 @@ public:
 		return rt;
 	}
 
+	/// \brief Get the relations of a key visible in a scope-step like 'get', but appending them to a buffer reused by the caller
+	/// \param[out] result where to append the relations to
+	/// \param[in,out] visited set of the related nodes (bool insert( const RELNODETYPE&) returning true if new) used to eliminate duplicates, cleared by the caller
+	template <class VISITEDSET>
+	void get( const Scope::Step step, const RELNODETYPE& key, const TagMask& selectTags, std::vector<ResultElement>& result, VISITEDSET& visited) const
+	{
+		auto range = m_map.match_range( step, key);
+		for (auto ri = range.first; ri != range.second; ++ri)
+		{
+			int li = *ri;
+			while (li >= 0)
+			{
+				const ListElement& le = m_list[ li];
+				if (selectTags.matches( le.tagval) && visited.insert( le.related))
+				{
+					result.push_back( ResultElement( le.related/*right*/, le.value, le.weight, le.tagval));
+				}
+				li = le.next;
+			}
+		}
+	}
+
 	struct TreeNodeElement
 	{
 		std::pair<RELNODETYPE,RELNODETYPE> relation;
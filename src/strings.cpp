@@ -124,3 +124,14 @@ std::string mewa::template_format( const std::string_view& templatstr, char sb,
 	return rt;
 }
 
+std::uint64_t mewa::string_hash( const std::string_view& str, std::uint64_t seed) noexcept
+{
+	std::uint64_t rt = seed;
+	for (unsigned char ch : str)
+	{
+		rt ^= ch;
+		rt *= 0x100000001b3ULL;
+	}
+	return rt;
+}
+
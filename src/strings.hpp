@@ -13,7 +13,9 @@
 #define _MEWA_STRINGS_HPP_INCLUDED
 #if __cplusplus >= 201703L
 #include <string>
+#include <string_view>
 #include <map>
+#include <cstdint>
 
 namespace mewa {
 
@@ -32,6 +34,11 @@ std::string string_format( const char* fmt, ...);
 /// \param[in] substmap variables to substitute
 std::string template_format( const std::string_view& templatstr, char sb, char eb, const std::map<std::string,std::string>& substmap);
 
+/// \brief Calculate the 64 bit FNV-1a hash of a string
+/// \param[in] str string to hash
+/// \param[in] seed hash to continue with for hashing a sequence of strings
+std::uint64_t string_hash( const std::string_view& str, std::uint64_t seed = 0xcbf29ce484222325ULL) noexcept;
+
 }//namespace
 
 #else
@@ -19,18 +19,29 @@
 #include <limits>
 #include <memory>
 #include <memory_resource>
+#include <cstring>
 
 using namespace mewa;
 
-void TypeDatabase::appendTypeToString( std::pmr::string& res, int type, const char* sep) const
+std::string_view TypeDatabase::typeString_( int type, const char* sep) const
 {
-	if (type == 0) return;
+	if (type == 0) return std::string_view("",0);
 	if (type < 0 || type > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle);
 
+	if (type > (int)m_typeStrings.size())
+	{
+		m_typeStrings.resize( m_typerecMap.size(), nullptr);
+	}
+	for (TypeString const* ts = m_typeStrings[ type-1]; ts; ts = ts->next)
+	{
+		if (0==std::strcmp( ts->sep, sep)) return ts->str;
+	}
+	// ... render the type from the strings of its context type and its parameters, they are cached too
+	std::string res;
 	const TypeRecord& rec = m_typerecMap[ type-1];
 	if (rec.inv.contextType)
 	{
-		appendTypeToString( res, rec.inv.contextType, sep);
+		res.append( typeString_( rec.inv.contextType, sep));
 		res.append( sep);
 	}
 	res.append( m_identMap->inv( rec.inv.ident));
@@ -40,17 +51,40 @@ void TypeDatabase::appendTypeToString( std::pmr::string& res, int type, const ch
 		for (int pi = 0; pi < rec.parameterlen; ++pi)
 		{
 			if (pi) res.push_back( ','); 
-			appendTypeToString( res, m_parameterMap[ rec.parameter + pi -1].type, sep);
+			res.append( typeString_( m_parameterMap[ rec.parameter + pi -1].type, sep));
 		}
 		res.push_back( ')');
 	}
+	std::pmr::memory_resource* memrsc = m_memory->resource_identstr();
+	std::size_t seplen = std::strlen( sep);
+	char* strmem = (char*)memrsc->allocate( res.size() + seplen + 1, 1);
+	std::memcpy( strmem, res.c_str(), res.size());
+	std::memcpy( strmem + res.size(), sep, seplen+1);
+
+	TypeString* ts = new (memrsc->allocate( sizeof(TypeString), alignof(TypeString))) TypeString();
+	ts->sep = strmem + res.size();
+	ts->str = std::string_view( strmem, res.size());
+	ts->next = m_typeStrings[ type-1];
+	m_typeStrings[ type-1] = ts;
+	return ts->str;
+}
+
+std::string_view TypeDatabase::typeString( int type, const char* sep) const
+{
+	if (m_frozen)
+	{
+		std::lock_guard<std::mutex> lock( m_typeStringMutex);
+		return typeString_( type, sep);
+	}
+	return typeString_( type, sep);
 }
 
 std::pmr::string TypeDatabase::typeToString( int type, const char* sep, ResultBuffer& resbuf) const
 {
+	std::string_view str = typeString( type, sep);
 	std::pmr::string rt( &resbuf.memrsc);
-	rt.reserve( resbuf.buffersize()-1);
-	appendTypeToString( rt, type, sep);
+	rt.reserve( std::max( (std::size_t)resbuf.buffersize()-1, str.size()));
+	rt.append( str);
 	return rt;
 }
 
@@ -81,6 +115,7 @@ int TypeDatabase::typeContext( int type) const
 
 void TypeDatabase::setObjectInstance( const std::string_view& name, const Scope& scope, int handle)
 {
+	checkNotFrozen();
 	if (handle <= 0) throw Error( Error::InvalidHandle, string_format( "%d", handle));
 
 	int objid = m_identMap->get( name);
@@ -182,20 +217,57 @@ int TypeDatabase::findTypeWithSignature( int typerec, const TypeDatabase::TypeLi
 	return tri;
 }
 
+static std::size_t parameterSignatureHash( const TypeDatabase::TypeList& parameter) noexcept
+{
+	std::size_t rt = parameter.size();
+	for (std::size_t pi = 0; pi < parameter.size(); ++pi)
+	{
+		rt = rt * 1000003 ^ (std::size_t)parameter[ pi];
+	}
+	return rt;
+}
+
+static std::size_t parameterSignatureHash( const TypeDatabase::TypeConstructorPairList& parameter) noexcept
+{
+	std::size_t rt = parameter.size();
+	for (std::size_t pi = 0; pi < parameter.size(); ++pi)
+	{
+		rt = rt * 1000003 ^ (std::size_t)parameter[ pi].type;
+	}
+	return rt;
+}
+
 int TypeDatabase::getType( const Scope& scope, int contextType, const std::string_view& name, const TypeList& parameter) const
 {
 	if (contextType < 0 || contextType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", contextType));
-	TypeDef typeDef( contextType, m_identMap->get( name));
+	int nameid = m_identMap->lookup( name);
+	if (!nameid) return 0;
+	TypeDef typeDef( contextType, nameid);
 
 	int typerec = m_typeTable->getDef( scope, typeDef);
-	return typerec ? findTypeWithSignature( typerec, parameter) : 0;
+	if (!typerec) return 0;
+
+	const TypeRecord& head = m_typerecMap[ typerec-1];
+	if (head.scope == scope && head.inv == typeDef)
+	{
+		// ... the type found is the first of the list of types defined with this name, not one defined with defineTypeAs
+		auto si = m_signatureIndex.find( {typerec, parameterSignatureHash( parameter)});
+		if (si == m_signatureIndex.end()) return 0;
+
+		const TypeRecord& tr = m_typerecMap[ si->second-1];
+		if (compareParameterSignature( parameter, tr.parameter, tr.parameterlen)) return si->second;
+		// ... hash collision, fall back to the search in the list
+	}
+	return findTypeWithSignature( typerec, parameter);
 }
 
 TypeDatabase::GetTypesResult TypeDatabase::getTypes( const Scope& scope, int contextType, const std::string_view& name, ResultBuffer& resbuf) const
 {
 	TypeDatabase::GetTypesResult rt( resbuf);
 	if (contextType < 0 || contextType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", contextType));
-	TypeDef typeDef( contextType, m_identMap->get( name));
+	int nameid = m_identMap->lookup( name);
+	if (!nameid) return rt;
+	TypeDef typeDef( contextType, nameid);
 
 	int tri = m_typeTable->getDef( scope, typeDef);
 	while (tri)
@@ -208,6 +280,7 @@ TypeDatabase::GetTypesResult TypeDatabase::getTypes( const Scope& scope, int con
 
 int TypeDatabase::defineType( const Scope& scope, int contextType, const std::string_view& name, int constructor, const TypeConstructorPairList& parameter)
 {
+	checkNotFrozen();
 	if (parameter.size() >= MaxNofParameter) throw Error( Error::TooManyTypeArguments, string_format( "%zu", parameter.size()));
 	if ((int)(m_parameterMap.size() + parameter.size()) >= std::numeric_limits<int>::max()) throw Error( Error::CompiledSourceTooComplex);
 	if (constructor < 0) throw Error( Error::InvalidHandle, string_format( "%d", constructor));
@@ -229,32 +302,64 @@ int TypeDatabase::defineType( const Scope& scope, int contextType, const std::st
 	int typerec = m_typerecMap.size()+1;
 	TypeDef typeDef( contextType, m_identMap->get( name));
 	m_typerecMap.push_back( TypeRecord( constructor, scope, parameteridx, parameterlen, typeDef));
+	addNameDefinition( typeDef, scope);
 
+	std::size_t signature = parameterSignatureHash( parameter);
 	int prev_typerec = m_typeTable->getOrSet( scope, typeDef, typerec);
 	if (prev_typerec/*already exists*/)
 	{
 		// Check if there is a conflict, and find the end of the single linked list (-> lastListIndex):
 		int lastListIndex = 0;
-		int tri = findTypeWithSignature( prev_typerec, parameter, lastListIndex);
-		if (tri) return -1;
-
+		int listHead = prev_typerec;
+		const TypeRecord& head = m_typerecMap[ prev_typerec-1];
+		if (head.scope == scope && head.inv == typeDef)
+		{
+			auto si = m_signatureIndex.find( {listHead, signature});
+			if (si == m_signatureIndex.end())
+			{
+				lastListIndex = head.last;
+			}
+			else
+			{
+				const TypeRecord& tr = m_typerecMap[ si->second-1];
+				if (compareParameterSignature( parameter, tr.parameter, tr.parameterlen)) return -1;
+				// ... hash collision, fall back to the search in the list
+				if (findTypeWithSignature( prev_typerec, parameter, lastListIndex)) return -1;
+			}
+		}
+		else
+		{
+			// ... the list found has been referenced with defineTypeAs, it is a tail of the list of the type referenced
+			if (findTypeWithSignature( prev_typerec, parameter, lastListIndex)) return -1;
+			listHead = m_typeTable->getDef( head.scope, head.inv);
+		}
 		// ... the definition is new and we got the tail of the list in 'lastListIndex', we add the new created record:
-		if (!lastListIndex) throw Error( Error::LogicError, string_format( "%s line %d", __FILE__, (int)__LINE__));
+		if (!lastListIndex || !listHead) throw Error( Error::LogicError, string_format( "%s line %d", __FILE__, (int)__LINE__));
 		m_typerecMap[ lastListIndex-1].next = typerec;
+		m_typerecMap[ listHead-1].last = typerec;
+		m_signatureIndex.insert( {{listHead, signature}, typerec});
+	}
+	else
+	{
+		m_typerecMap.back().last = typerec;
+		m_signatureIndex.insert( {{typerec, signature}, typerec});
 	}
 	return typerec;
 }
 
 int TypeDatabase::defineTypeAs( const Scope& scope, int contextType, const std::string_view& name, int type)
 {
+	checkNotFrozen();
 	if (contextType < 0 || contextType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", contextType));
 	if (type <= 0 || type > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", type));
 	TypeDef typeDef( contextType, m_identMap->get( name));
+	addNameDefinition( typeDef, scope);
 	return m_typeTable->set( scope, typeDef, type) ? type : 0;
 }
 
 void TypeDatabase::defineReduction( const Scope& scope, int toType, int fromType, int constructor, int tag, float weight)
 {
+	checkNotFrozen();
 	if (constructor < 0) throw Error( Error::InvalidHandle, string_format( "%d", constructor));
 	if (toType < 0 || toType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", toType));
 	if (fromType <= 0 || fromType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", fromType));
@@ -263,39 +368,272 @@ void TypeDatabase::defineReduction( const Scope& scope, int toType, int fromType
 		std::string nam = debugTypeToString( toType, " ");
 		throw Error( Error::InvalidReductionDefinition, string_format( "%s <- %s", nam.c_str(), nam.c_str()));
 	}
-	m_reduTable->set( scope, fromType, toType, constructor, tag, weight);
+	if (m_reduTable->set( scope, fromType, toType, constructor, tag, weight))
+	{
+		m_reduAdjacency.add( scope, fromType, toType, constructor, TagMask::tagValFromTag( tag), weight);
+	}
+	addScopeBoundaries( m_reduScopeBoundaries, scope);
+
+	if (toType >= (int)m_reverseReductions.size())
+	{
+		m_reverseReductions.resize( m_typerecMap.size()+1);
+	}
+	m_reverseReductions[ toType].push_back( {fromType, weight});
+	// ... a search pruned with a lower bound lowered by the new reduction may have skipped types not marked as searched,
+	// the caches are cleared then as if the new reduction started from a searched type:
+	bool prunedSearchChanged = m_queryState.deriveLowerBoundsDropped;
+	auto& deriveLowerBounds = m_queryState.deriveLowerBounds;
+	for (auto bi = deriveLowerBounds.begin(); bi != deriveLowerBounds.end();)
+	{
+		// ... the new reduction lowers the bounds of a table if it shortens the path from its source type to the target of the table,
+		// types defined after the table have no path to its target, otherwise the table would have been erased before
+		const std::vector<float>& lowerBound = bi->second;
+		float toTypeBound = toType < (int)lowerBound.size() ? lowerBound[ toType] : std::numeric_limits<float>::infinity();
+		float fromTypeBound = fromType < (int)lowerBound.size() ? lowerBound[ fromType] : std::numeric_limits<float>::infinity();
+		if (toTypeBound + weight < fromTypeBound)
+		{
+			prunedSearchChanged = true;
+			bi = deriveLowerBounds.erase( bi);
+		}
+		else
+		{
+			++bi;
+		}
+	}
+	if (prunedSearchChanged || (fromType < (int)m_searchedTypes.size() && m_searchedTypes[ fromType]))
+	{
+		// ... the new reduction may change the result of a search stored in the caches
+		m_queryState.deriveCache.clear();
+		m_queryState.resolveCache.clear();
+		m_queryState.deriveLowerBoundsDropped = false;
+		m_searchedTypes.clear();
+	}
+	if (fromType < (int)m_indexedTypes.size() && m_indexedTypes[ fromType])
+	{
+		// ... the new reduction may change a path stored in the reduction index or the scopes where it is valid
+		m_queryState.reductionPathIndex.clear();
+		m_queryState.reductionEdgeIndex.clear();
+		m_indexedTypes.clear();
+	}
+	if (scope.start() != 0 || scope.end() != std::numeric_limits<Scope::Step>::max())
+	{
+		m_localReductionScopes.push_back( scope);
+		m_localReductionCoverValid = false;
+		if (fromType >= (int)m_localReductionSources.size())
+		{
+			m_localReductionSources.resize( m_typerecMap.size()+1, false);
+		}
+		m_localReductionSources[ fromType] = true;
+	}
 }
 
-struct ReduStackElem
+void TypeDatabase::freezeReductions()
 {
-	int type;
-	int constructor;
-	int prev;
-	int pathlen;
+	if (m_frozen) return;
+	m_reductionsFrozen = true;
+	m_reduAdjacency.compact();
+}
 
-	ReduStackElem( const ReduStackElem& o) noexcept
-		:type(o.type),constructor(o.constructor),prev(o.prev),pathlen(o.pathlen){}
-	ReduStackElem( int type_, int constructor_, int prev_, int pathlen_) noexcept
-		:type(type_),constructor(constructor_),prev(prev_),pathlen(pathlen_){}
-};
+void TypeDatabase::freeze()
+{
+	if (m_frozen) return;
+	freezeReductions();
+	// ... the lazily built data used by the queries is completed here, the queries only read it from now on
+	updateLocalReductionCover();
+	m_freeQueryStates.reserve( 16);
+	m_freeQueryStates.push_back( &m_queryState);
+	m_queryState.published = m_queryState.statistics();
+	m_frozen = true;
+}
+
+void TypeDatabase::checkNotFrozen() const
+{
+	if (m_frozen) throw Error( Error::ModificationOfFrozenTypeDatabase);
+}
+
+TypeDatabase::QueryStateScope::QueryStateScope( const TypeDatabase& typedb)
+	:m_typedb(typedb),m_state(&typedb.m_queryState)
+{
+	if (m_typedb.m_frozen)
+	{
+		std::lock_guard<std::mutex> lock( m_typedb.m_queryStateMutex);
+		if (m_typedb.m_freeQueryStates.empty())
+		{
+			// ... reserve the place in the pool of the new state, so that releasing it in the destructor does not allocate
+			m_typedb.m_freeQueryStates.reserve( m_typedb.m_queryStates.size() + 2);
+			m_typedb.m_queryStates.emplace_back( new QueryState());
+			m_state = m_typedb.m_queryStates.back().get();
+		}
+		else
+		{
+			m_state = m_typedb.m_freeQueryStates.back();
+			m_typedb.m_freeQueryStates.pop_back();
+		}
+	}
+}
+
+TypeDatabase::QueryStateScope::~QueryStateScope()
+{
+	if (m_typedb.m_frozen)
+	{
+		QueryStateStatistics stats = m_state->statistics();
+		std::lock_guard<std::mutex> lock( m_typedb.m_queryStateMutex);
+		m_state->published = stats;
+		m_typedb.m_freeQueryStates.push_back( m_state);
+	}
+}
+
+TypeDatabase::QueryStateStatistics TypeDatabase::QueryState::statistics() const noexcept
+{
+	QueryStateStatistics rt;
+	rt.deriveCache = deriveCacheStatistics;
+	rt.deriveCache.size = deriveCache.size();
+	rt.resolveCache = resolveCacheStatistics;
+	rt.resolveCache.size = resolveCache.size();
+	rt.reductionIndex = reductionIndexStatistics;
+	rt.reductionIndex.size = reductionPathIndex.size() + reductionEdgeIndex.size();
+	rt.queries = queryStatistics;
+	rt.nodesExpanded = searchWorkspace.queue.nofPops();
+	rt.queuePushes = searchWorkspace.queue.nofPushes();
+	return rt;
+}
+
+template <class FUNC>
+void TypeDatabase::foreachQueryStateStatistics( FUNC func) const
+{
+	if (!m_frozen)
+	{
+		func( m_queryState.statistics());
+		return;
+	}
+	// ... the states in use are modified by concurrent queries, only the statistics taken when they were returned to the pool are read
+	std::lock_guard<std::mutex> lock( m_queryStateMutex);
+	func( m_queryState.published);
+	for (auto const& qs : m_queryStates)
+	{
+		func( qs->published);
+	}
+}
+
+bool TypeDatabase::isLocalReductionSource( int type) const noexcept
+{
+	return type < (int)m_localReductionSources.size() && m_localReductionSources[ type];
+}
+
+void TypeDatabase::updateLocalReductionCover() const
+{
+	if (!m_localReductionCoverValid)
+	{
+		std::vector<Scope> scopes( m_localReductionScopes);
+		std::sort( scopes.begin(), scopes.end(), []( const Scope& aa, const Scope& bb){return aa.start() < bb.start();});
+		m_localReductionCover.clear();
+		for (auto const& scope : scopes)
+		{
+			if (!m_localReductionCover.empty() && m_localReductionCover.back().end() >= scope.start())
+			{
+				Scope& last = m_localReductionCover.back();
+				last = Scope( last.start(), std::max( last.end(), scope.end()));
+			}
+			else
+			{
+				m_localReductionCover.push_back( scope);
+			}
+		}
+		m_localReductionCoverValid = true;
+	}
+}
+
+bool TypeDatabase::localReductionVisible( const Scope::Step step) const
+{
+	updateLocalReductionCover();
+	auto ci = std::upper_bound( m_localReductionCover.begin(), m_localReductionCover.end(), step,
+					[]( const Scope::Step step_, const Scope& scope){return step_ < scope.start();});
+	return ci != m_localReductionCover.begin() && (ci-1)->contains( step);
+}
+
+Scope::Step TypeDatabase::globalReductionStep() const
+{
+	// ... get a scope-step where only the reductions of the global scope are visible, -1 if there is none
+	updateLocalReductionCover();
+	if (m_localReductionCover.empty() || m_localReductionCover[0].start() > 0) return 0;
+	Scope::Step rt = m_localReductionCover[0].end();
+	return rt == std::numeric_limits<Scope::Step>::max() ? -1 : rt;
+}
+
+void TypeDatabase::addScopeBoundaries( std::vector<Scope::Step>& boundaries, const Scope& scope)
+{
+	for (Scope::Step step : {scope.start(), scope.end()})
+	{
+		auto bi = std::lower_bound( boundaries.begin(), boundaries.end(), step);
+		if (bi == boundaries.end() || *bi != step)
+		{
+			boundaries.insert( bi, step);
+		}
+	}
+}
+
+Scope::Step TypeDatabase::scopeRegion( const std::vector<Scope::Step>& boundaries, const Scope::Step step) noexcept
+{
+	// ... all steps with the same closest scope start or end step lower or equal see the same definitions,
+	//	the region is identified by this boundary as it stays valid when new boundaries are inserted
+	auto bi = std::upper_bound( boundaries.begin(), boundaries.end(), step);
+	return bi == boundaries.begin() ? -1 : *(bi-1);
+}
+
+void TypeDatabase::markIndexedType( int type) const
+{
+	if (m_frozen) return; // ... no definitions anymore that could invalidate the index
+	if (type >= (int)m_indexedTypes.size())
+	{
+		m_indexedTypes.resize( m_typerecMap.size()+1, false);
+	}
+	m_indexedTypes[ type] = true;
+}
+
+void TypeDatabase::markSearchedType( int type) const
+{
+	if (m_frozen) return; // ... no definitions anymore that could invalidate the caches
+	if (type >= (int)m_searchedTypes.size())
+	{
+		m_searchedTypes.resize( m_typerecMap.size()+1, false);
+	}
+	m_searchedTypes[ type] = true;
+}
+
+void TypeDatabase::addNameDefinition( const TypeDef& typeDef, const Scope& scope)
+{
+	if ((int)m_nameScopeStates.size() < typeDef.ident)
+	{
+		m_nameScopeStates.resize( typeDef.ident);
+	}
+	NameScopeState& state = m_nameScopeStates[ typeDef.ident-1];
+	++state.generation;
+	addScopeBoundaries( state.boundaries, scope);
+
+	// ... types are mostly defined in contexts defined before, the insert is usually an append
+	auto ci = std::lower_bound( state.contextTypes.begin(), state.contextTypes.end(), typeDef.contextType);
+	if (ci == state.contextTypes.end() || *ci != typeDef.contextType)
+	{
+		state.contextTypes.insert( ci, typeDef.contextType);
+	}
+}
 
 class ReduStack
 {
 public:
-	ReduStack( std::pmr::memory_resource* memrsc, int buffersize)
-		:m_ar( memrsc)
+	ReduStack( std::vector<ReduStackElem>& ar, TypeMarkSet& startTypes)
+		:m_ar(ar),m_startTypes(startTypes)
 	{
-		m_ar.reserve( buffersize / sizeof(ReduStackElem));
+		m_ar.clear();
+		m_startTypes.clear();
 	}
 
 	int pushNonDuplicateStart( int type, int constructor)
 	{
 		int rt = -1;
-		std::size_t ai = 0;
-		for (; ai < m_ar.size() && m_ar[ ai].type != type; ++ai){}
-		if (ai == m_ar.size())
+		if (m_startTypes.insert( type))
 		{
-			rt = ai;
+			rt = m_ar.size();
 			m_ar.push_back( {type,constructor,-1/*prev*/,0/*path len*/});
 		}
 		return rt;
@@ -323,7 +661,8 @@ public:
 		return m_ar[ idx];
 	}
 
-	void collectResult( std::pmr::vector<TypeDatabase::TypeConstructorPair>& result, int index) const
+	template <class RESULT>
+	void collectResult( RESULT& result, int index) const
 	{
 		while (index >= 0)
 		{
@@ -371,7 +710,8 @@ public:
 		return rt;
 	}
 
-	void collectConflictPath( std::pmr::vector<int>& result, int index) const
+	template <class RESULT>
+	void collectConflictPath( RESULT& result, int index) const
 	{
 		while (index >= 0)
 		{
@@ -386,29 +726,8 @@ public:
 	}
 
 private:
-	std::pmr::vector<ReduStackElem> m_ar;
-};
-
-struct ReduQueueElem
-{
-	float weight;
-	int index;
-
-	ReduQueueElem() noexcept
-		:weight(0.0),index(-1){}
-	ReduQueueElem( float weight_, int index_) noexcept
-		:weight(weight_),index(index_){}
-	ReduQueueElem( const ReduQueueElem& o) noexcept
-		:weight(o.weight),index(o.index){}
-
-	bool operator < (const ReduQueueElem& o) const noexcept
-	{
-		return weight == o.weight ? index < o.index : weight < o.weight;
-	}
-	bool operator > (const ReduQueueElem& o) const noexcept
-	{
-		return weight == o.weight ? index > o.index : weight > o.weight;
-	}
+	std::vector<ReduStackElem>& m_ar;
+	TypeMarkSet& m_startTypes;
 };
 
 std::string TypeDatabase::reductionsToString( const std::pmr::vector<TypeConstructorPair>& reductions) const
@@ -446,36 +765,95 @@ std::string TypeDatabase::resolveResultToString( const ResolveResult& res) const
 	return rt;
 }
 
-template <typename ELEMTYPE>
-class LocalMemVector :public std::pmr::vector<ELEMTYPE>
+const std::vector<TypeDatabase::ReductionTable::ResultElement>& TypeDatabase::getReductionList( QueryState& qs, const Scope::Step step, int fromType, const TagMask& selectTags) const
 {
-public:
-	typedef std::pmr::vector<ELEMTYPE> ParentClass;
-
-public:
-	LocalMemVector()
-		:std::pmr::vector<ELEMTYPE>( &m_memrsc),m_memrsc(m_buffer,sizeof m_buffer){}
-	LocalMemVector( const LocalMemVector& o)
-		:std::pmr::vector<ELEMTYPE>( &m_memrsc),m_memrsc(m_buffer,sizeof m_buffer)
+	SearchWorkspace& workspace = qs.searchWorkspace;
+	workspace.reductions.clear();
+	workspace.reductionTypes.clear();
+	if (!m_reduAdjacency.get( step, fromType, selectTags, workspace.reductions, workspace.reductionTypes))
 	{
-		insert( ParentClass::end(), o.begin(), o.end());
+		m_reduTable->get( step, fromType, selectTags, workspace.reductions, workspace.reductionTypes);
 	}
+	return workspace.reductions;
+}
 
-private:
-	int m_buffer[ 1024];
-	mewa::monotonic_buffer_resource m_memrsc;
-};
+void ReductionAdjacency::compact()
+{
+	if (m_pending.empty()) return;
+
+	std::vector<int> pendingCounts( m_nodes.size(), 0);
+	for (auto const& pe : m_pending)
+	{
+		++pendingCounts[ pe.fromType];
+	}
+	std::vector<Edge> edges;
+	edges.reserve( m_edges.size() + m_pending.size());
+	std::vector<int> fillpos( m_nodes.size(), 0);
+	for (std::size_t ni = 0; ni < m_nodes.size(); ++ni)
+	{
+		Node& node = m_nodes[ ni];
+		int start = edges.size();
+		edges.insert( edges.end(), m_edges.begin() + node.start, m_edges.begin() + node.start + node.size);
+		fillpos[ ni] = edges.size();
+		edges.resize( edges.size() + pendingCounts[ ni], m_pending[0].edge);
+		node.start = start;
+		node.size += pendingCounts[ ni];
+	}
+	for (auto const& pe : m_pending)
+	{
+		edges[ fillpos[ pe.fromType]++] = pe.edge;
+	}
+	for (std::size_t ni = 0; ni < m_nodes.size(); ++ni)
+	{
+		Node& node = m_nodes[ ni];
+		if (!node.compacted)
+		{
+			// ... inner scopes first, a scope containing the step of a query in an other scope containing it has a bigger start or an equal start and a smaller end
+			std::stable_sort( edges.begin() + node.start, edges.begin() + node.start + node.size,
+						[]( const Edge& aa, const Edge& bb)
+						{
+							return aa.scopeStart == bb.scopeStart ? aa.scopeEnd < bb.scopeEnd : aa.scopeStart > bb.scopeStart;
+						});
+			node.tagmask = 0;
+			for (int ei = node.start; ei < node.start + node.size; ++ei)
+			{
+				node.tagmask |= (TagMask::BitSet)1 << edges[ ei].tagval;
+			}
+			node.compacted = true;
+		}
+	}
+	m_edges.swap( edges);
+	m_pending.clear();
+}
 
 TypeDatabase::GetReductionResult TypeDatabase::getReduction( const Scope::Step step, int toType, int fromType, const TagMask& selectTags) const
 {
 	if (fromType <= 0 || fromType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", fromType));
 	if (toType < 0 || toType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", toType));
 
-	int redu_buffer[ 512];
-	mewa::monotonic_buffer_resource redu_memrsc( redu_buffer, sizeof redu_buffer);
-	auto redulist = m_reduTable->get( step, fromType, selectTags, &redu_memrsc);
-
 	TypeDatabase::GetReductionResult rt;
+	QueryStateScope qss( *this);
+	const ReductionEdgeIndex* index = m_reductionsFrozen ? getReductionEdgeIndex( qss.state(), fromType, selectTags) : nullptr;
+	if (index && (index->scopeIndependent || !localReductionVisible( step)))
+	{
+		ReductionEdge key{toType, 0, 0.0, false};
+		auto ei = std::lower_bound( index->edges.begin(), index->edges.end(), key);
+		if (ei != index->edges.end() && ei->type == toType)
+		{
+			if (ei->ambiguous)
+			{
+				ResultBuffer resbuf_err;
+				auto toTypeStr = typeToString( toType, " ", resbuf_err);
+				auto fromTypeStr = typeToString( fromType, " ", resbuf_err);
+				throw Error( Error::AmbiguousReductionDefinitions, string_format( "%s <- %s", toTypeStr.c_str(), fromTypeStr.c_str()));
+			}
+			rt.constructor = ei->constructor;
+			rt.weight = ei->weight;
+		}
+		return rt;
+	}
+	auto const& redulist = getReductionList( qss.state(), step, fromType, selectTags);
+
 	for (auto const& redu : redulist)
 	{
 		if (toType == redu.right())
@@ -507,9 +885,8 @@ TypeDatabase::GetReductionsResult TypeDatabase::getReductions(
 
 	GetReductionsResult rt( resbuf);
 
-	int redu_buffer[ 512];
-	mewa::monotonic_buffer_resource redu_memrsc( redu_buffer, sizeof redu_buffer);
-	auto redulist = m_reduTable->get( step, fromType, selectTags, &redu_memrsc);
+	QueryStateScope qss( *this);
+	auto const& redulist = getReductionList( qss.state(), step, fromType, selectTags);
 
 	for (auto const& redu : redulist)
 	{
@@ -522,33 +899,587 @@ TypeDatabase::GetReductionsResult TypeDatabase::getReductions(
 TypeDatabase::DeriveResult TypeDatabase::deriveType( 
 	const Scope::Step step, int toType, int fromType,
 	const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, ResultBuffer& resbuf) const
+{
+	QueryStateScope qss( *this);
+	return deriveType( qss.state(), step, toType, fromType, selectTags, selectTagsCount, maxCount, resbuf);
+}
+
+TypeDatabase::DeriveResult TypeDatabase::deriveType( QueryState& qs,
+	const Scope::Step step, int toType, int fromType,
+	const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, ResultBuffer& resbuf) const
 {
 	DeriveResult rt( resbuf);
-	bool alt_searchstate = false;
 
 	if (fromType <= 0 || fromType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", fromType));
 	if (toType < 0 || toType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", toType));
 	if (maxCount == -1) maxCount = std::numeric_limits<int>::max();
 	if (maxCount < 0) throw Error( Error::InvalidBoundary, string_format( "%d", maxCount));
+	++qs.queryStatistics.deriveTypeCalls;
+
+	const ReductionPathIndex* index = m_reductionsFrozen ? getReductionPathIndex( qs, fromType, selectTags, selectTagsCount, maxCount) : nullptr;
+	if (index && index->complete && (index->scopeIndependent || !localReductionVisible( step)))
+	{
+		ReductionPathTarget key{toType, -1, -1, 0.0};
+		auto ti = std::lower_bound( index->targets.begin(), index->targets.end(), key);
+		if (ti != index->targets.end() && ti->type == toType)
+		{
+			auto const& nodes = index->nodes;
+			rt.defined = true;
+			rt.weightsum = ti->weightsum;
+			for (int ni = ti->first; nodes[ ni].prev >= 0; ni = nodes[ ni].prev)
+			{
+				rt.reductions.push_back( {nodes[ ni].type, nodes[ ni].constructor});
+			}
+			std::reverse( rt.reductions.begin(), rt.reductions.end());
+			if (ti->conflict >= 0)
+			{
+				for (int ni = ti->conflict; nodes[ ni].prev >= 0; ni = nodes[ ni].prev)
+				{
+					rt.conflictPath.push_back( nodes[ ni].type);
+				}
+				std::reverse( rt.conflictPath.begin(), rt.conflictPath.end());
+			}
+		}
+		return rt;
+	}
+	DeriveCacheKey key( scopeRegion( m_reduScopeBoundaries, step), toType, fromType, selectTags.mask(), selectTagsCount.mask(), maxCount);
+	auto ci = qs.deriveCache.find( key);
+	if (ci != qs.deriveCache.end())
+	{
+		++qs.deriveCacheStatistics.hits;
+		rt.reductions.insert( rt.reductions.end(), ci->second.reductions.begin(), ci->second.reductions.end());
+		rt.conflictPath.insert( rt.conflictPath.end(), ci->second.conflictPath.begin(), ci->second.conflictPath.end());
+		rt.weightsum = ci->second.weightsum;
+		rt.defined = ci->second.defined;
+		return rt;
+	}
+	++qs.deriveCacheStatistics.misses;
+	deriveType_( qs, rt, step, toType, fromType, selectTags, selectTagsCount, maxCount, getDeriveLowerBound( qs, toType));
+
+	if (qs.deriveCache.size() >= MaxDeriveCacheSize)
+	{
+		qs.deriveCache.clear();
+	}
+	qs.deriveCache.insert( {key, DeriveCacheValue{
+			std::vector<TypeConstructorPair>( rt.reductions.begin(), rt.reductions.end()),
+			std::vector<int>( rt.conflictPath.begin(), rt.conflictPath.end()),
+			rt.weightsum, rt.defined}});
+	return rt;
+}
+
+TypeDatabase::DeriveTargetsResult TypeDatabase::deriveTypeTargets(
+	const Scope::Step step, const TypeList& toTypes, int fromType,
+	const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, ResultBuffer& resbuf) const
+{
+	DeriveTargetsResult rt( resbuf);
+
+	if (fromType <= 0 || fromType > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", fromType));
+	for (int ti = 0; ti < toTypes.arsize; ++ti)
+	{
+		if (toTypes.ar[ ti] < 0 || toTypes.ar[ ti] > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", toTypes.ar[ ti]));
+	}
+	if (maxCount == -1) maxCount = std::numeric_limits<int>::max();
+	if (maxCount < 0) throw Error( Error::InvalidBoundary, string_format( "%d", maxCount));
+	QueryStateScope qss( *this);
+	QueryState& qs = qss.state();
+	qs.queryStatistics.deriveTypeCalls += toTypes.arsize;
+
+	auto appendTarget = [&rt]( auto reductionsBegin, auto reductionsEnd, auto conflictBegin, auto conflictEnd, float weightsum, bool defined)
+	{
+		DeriveTarget target{(int)rt.reductions.size(), 0, (int)rt.conflictPaths.size(), 0, weightsum, defined};
+		rt.reductions.insert( rt.reductions.end(), reductionsBegin, reductionsEnd);
+		rt.conflictPaths.insert( rt.conflictPaths.end(), conflictBegin, conflictEnd);
+		target.reductionsEnd = rt.reductions.size();
+		target.conflictEnd = rt.conflictPaths.size();
+		rt.targets.push_back( target);
+	};
+	rt.targets.reserve( toTypes.arsize);
+
+	const ReductionPathIndex* index = m_reductionsFrozen ? getReductionPathIndex( qs, fromType, selectTags, selectTagsCount, maxCount) : nullptr;
+	if (index && index->complete && (index->scopeIndependent || !localReductionVisible( step)))
+	{
+		std::vector<TypeConstructorPair> reductions;
+		std::vector<int> conflictPath;
+		auto const& nodes = index->nodes;
+		for (int ti = 0; ti < toTypes.arsize; ++ti)
+		{
+			reductions.clear();
+			conflictPath.clear();
+			ReductionPathTarget key{toTypes.ar[ ti], -1, -1, 0.0};
+			auto ii = std::lower_bound( index->targets.begin(), index->targets.end(), key);
+			if (ii != index->targets.end() && ii->type == toTypes.ar[ ti])
+			{
+				for (int ni = ii->first; nodes[ ni].prev >= 0; ni = nodes[ ni].prev)
+				{
+					reductions.push_back( {nodes[ ni].type, nodes[ ni].constructor});
+				}
+				for (int ni = ii->conflict; ni >= 0 && nodes[ ni].prev >= 0; ni = nodes[ ni].prev)
+				{
+					conflictPath.push_back( nodes[ ni].type);
+				}
+				appendTarget( reductions.rbegin(), reductions.rend(), conflictPath.rbegin(), conflictPath.rend(), ii->weightsum, true);
+			}
+			else
+			{
+				appendTarget( reductions.begin(), reductions.end(), conflictPath.begin(), conflictPath.end(), 0.0, false);
+			}
+		}
+	}
+	else
+	{
+		// Take the results from the cache, search the targets not found in the cache with one search:
+		Scope::Step region = scopeRegion( m_reduScopeBoundaries, step);
+		std::vector<const DeriveCacheValue*> values( toTypes.arsize, nullptr);
+		std::vector<int> searchTypes;
+		for (int ti = 0; ti < toTypes.arsize; ++ti)
+		{
+			DeriveCacheKey key( region, toTypes.ar[ ti], fromType, selectTags.mask(), selectTagsCount.mask(), maxCount);
+			auto ci = qs.deriveCache.find( key);
+			if (ci != qs.deriveCache.end())
+			{
+				++qs.deriveCacheStatistics.hits;
+				values[ ti] = &ci->second;
+			}
+			else
+			{
+				searchTypes.push_back( toTypes.ar[ ti]);
+			}
+		}
+		std::sort( searchTypes.begin(), searchTypes.end());
+		searchTypes.erase( std::unique( searchTypes.begin(), searchTypes.end()), searchTypes.end());
 
-	int buffer[ 4096];
-	mewa::monotonic_buffer_resource stack_memrsc( buffer, sizeof buffer);
+		std::vector<DeriveCacheValue> searchResults;
+		if (!searchTypes.empty())
+		{
+			qs.deriveCacheStatistics.misses += searchTypes.size();
+			deriveTypeTargets_( qs, searchResults, searchTypes, step, fromType, selectTags, selectTagsCount, maxCount);
+		}
+		for (int ti = 0; ti < toTypes.arsize; ++ti)
+		{
+			const DeriveCacheValue* value = values[ ti];
+			if (!value)
+			{
+				auto si = std::lower_bound( searchTypes.begin(), searchTypes.end(), toTypes.ar[ ti]);
+				value = &searchResults[ si - searchTypes.begin()];
+			}
+			appendTarget( value->reductions.begin(), value->reductions.end(), value->conflictPath.begin(), value->conflictPath.end(),
+					value->weightsum, value->defined);
+		}
+		// ... the results are inserted into the cache after their use, as an insert may clear the cache
+		if (qs.deriveCache.size() + searchTypes.size() > MaxDeriveCacheSize)
+		{
+			qs.deriveCache.clear();
+		}
+		for (std::size_t si = 0; si < searchTypes.size(); ++si)
+		{
+			DeriveCacheKey key( region, searchTypes[ si], fromType, selectTags.mask(), selectTagsCount.mask(), maxCount);
+			qs.deriveCache.insert( {key, std::move( searchResults[ si])});
+		}
+	}
+	for (int ti = 0; ti < toTypes.arsize; ++ti)
+	{
+		const DeriveTarget& target = rt.targets[ ti];
+		if (target.defined && (rt.nearest < 0 || target.weightsum < rt.targets[ rt.nearest].weightsum))
+		{
+			rt.nearest = ti;
+		}
+	}
+	return rt;
+}
 
-	ReduStack stack( &stack_memrsc, sizeof buffer);
-	std::priority_queue<ReduQueueElem,LocalMemVector<ReduQueueElem>,std::greater<ReduQueueElem> > priorityQueue;
+/// \brief Evaluate if a path with a weight to a type can still lead to the target with a weight not bigger than a bound
+/// \note A bound for the rounding errors of the different order of float additions in the calculation of the lower bound is subtracted
+static bool lowerBoundAccepts( const std::vector<float>& lowerBound, int type, float weight, float maxweight)
+{
+	if (type >= (int)lowerBound.size()) return true;
+	float lb = lowerBound[ type];
+	if (lb == std::numeric_limits<float>::infinity()) return false;
+	return weight + lb * (1.0f - 1E-4f) <= maxweight + std::numeric_limits<float>::epsilon();
+}
+
+void TypeDatabase::deriveTypeTargets_( QueryState& qs, std::vector<DeriveCacheValue>& results, const std::vector<int>& toTypes,
+	const Scope::Step step, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const
+{
+	// Same search as in deriveType_ with the lower bounds of all targets, the order of visits does not depend on the target.
+	// The result for a target is settled by a conflicting path or by a visit with a weight exceeding the weight of its best path.
+	// Targets without any path from the start type are settled from the beginning. The search skips types that cannot lead to
+	// a target not settled yet with a weight of its first or a conflicting result and ends when all targets are settled:
+	struct TargetState
+	{
+		int first;
+		int conflict;
+		float weightsum;
+		bool settled;
+	};
+	std::vector<TargetState> states( toTypes.size(), TargetState{-1, -1, 0.0, false});
+	std::vector<int> foundOrder;
+	std::size_t settledIdx = 0;
+	int nofOpen = toTypes.size();
+
+	// ... the tables are referenced during the whole search, the map is cleared before if they do not fit into it without a clear
+	std::vector<const std::vector<float>*> lowerBounds;
+	if (toTypes.size() <= MaxDeriveLowerBoundTables)
+	{
+		if (qs.deriveLowerBounds.size() + toTypes.size() > MaxDeriveLowerBoundTables)
+		{
+			qs.deriveLowerBounds.clear();
+			qs.deriveLowerBoundsDropped = true;
+		}
+		for (std::size_t si = 0; si < toTypes.size(); ++si)
+		{
+			lowerBounds.push_back( &getDeriveLowerBound( qs, toTypes[ si]));
+			if (!lowerBoundAccepts( *lowerBounds.back(), fromType, 0.0, std::numeric_limits<float>::max()))
+			{
+				states[ si].settled = true;
+				--nofOpen;
+			}
+		}
+	}
+	auto leadsToOpenTarget = [&states,&lowerBounds]( int type, float weight)
+	{
+		if (lowerBounds.empty()) return true;
+		for (std::size_t si = 0; si < states.size(); ++si)
+		{
+			const TargetState& state = states[ si];
+			float maxweight = state.first >= 0 ? state.weightsum : std::numeric_limits<float>::max();
+			if (!state.settled && lowerBoundAccepts( *lowerBounds[ si], type, weight, maxweight)) return true;
+		}
+		return false;
+	};
+
+	ReduStack stack( qs.searchWorkspace.stack, qs.searchWorkspace.startTypes);
+	ReduQueue& priorityQueue = qs.searchWorkspace.queue;
+	priorityQueue.clear();
 	{
 		int index = stack.pushNonDuplicateStart( fromType, 0/*constructor*/);
 		priorityQueue.push( ReduQueueElem( 0.0/*weight*/, index));
 	}
 	while (!priorityQueue.empty())
+	{
+		auto qe = priorityQueue.pop();
+
+		for (; settledIdx < foundOrder.size(); ++settledIdx)
+		{
+			TargetState& state = states[ foundOrder[ settledIdx]];
+			if (qe.weight <= state.weightsum + std::numeric_limits<float>::epsilon()) break;
+			if (!state.settled)
+			{
+				state.settled = true;
+				--nofOpen;
+			}
+		}
+		if (nofOpen == 0) break;
+
+		ReduStackElem elem = stack[ qe.index];
+		markSearchedType( elem.type);
+
+		auto ti = std::lower_bound( toTypes.begin(), toTypes.end(), elem.type);
+		if (ti != toTypes.end() && *ti == elem.type)
+		{
+			int slot = ti - toTypes.begin();
+			TargetState& state = states[ slot];
+			if (state.first < 0)
+			{
+				state.first = qe.index;
+				state.weightsum = qe.weight;
+				foundOrder.push_back( slot);
+			}
+			else if (!state.settled)
+			{
+				++qs.queryStatistics.conflicts;
+				state.conflict = qe.index;
+				state.settled = true;
+				--nofOpen;
+			}
+		}
+		// ... the targets this element was pushed for may have been settled in the meantime
+		if (!leadsToOpenTarget( elem.type, qe.weight)) continue;
+
+		auto const& redulist = getReductionList( qs, step, elem.type, selectTags);
+		for (auto const& redu : redulist)
+		{
+			int pathlen = selectTagsCount.matches( redu.tagval()) ? (elem.pathlen+1) : elem.pathlen;
+			if (pathlen <= maxCount)
+			{
+				float weight = qe.weight + redu.weight();
+				if (!leadsToOpenTarget( redu.right(), weight))
+				{
+					// ... a reduction defined later from the type skipped may change the result, the caches have to be cleared then
+					markSearchedType( redu.right());
+					continue;
+				}
+				int index = stack.pushIfNew( redu.right()/*type*/, redu.value()/*constructor*/, qe.index/*prev*/, pathlen);
+				if (index >= 0)
+				{
+					priorityQueue.push( ReduQueueElem( weight, index));
+				}
+			}
+		}
+	}
+	results.resize( toTypes.size());
+	for (std::size_t si = 0; si < toTypes.size(); ++si)
+	{
+		const TargetState& state = states[ si];
+		DeriveCacheValue& value = results[ si];
+		value.defined = state.first >= 0;
+		value.weightsum = state.weightsum;
+		if (state.first >= 0) stack.collectResult( value.reductions, state.first);
+		if (state.conflict >= 0) stack.collectConflictPath( value.conflictPath, state.conflict);
+	}
+}
+
+const TypeDatabase::ReductionPathIndex* TypeDatabase::getReductionPathIndex( QueryState& qs,
+	int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const
+{
+	ReductionIndexKey key( fromType, selectTags.mask(), selectTagsCount.mask(), maxCount);
+	auto ii = qs.reductionPathIndex.find( key);
+	if (ii != qs.reductionPathIndex.end())
+	{
+		++qs.reductionIndexStatistics.hits;
+		return &ii->second;
+	}
+	Scope::Step step = globalReductionStep();
+	if (step < 0) return nullptr;
+
+	++qs.reductionIndexStatistics.misses;
+	if (qs.reductionPathIndex.size() + qs.reductionEdgeIndex.size() >= MaxReductionIndexSize)
+	{
+		qs.reductionPathIndex.clear();
+		qs.reductionEdgeIndex.clear();
+	}
+	ReductionPathIndex& index = qs.reductionPathIndex[ key];
+	buildReductionPathIndex( qs, index, step, fromType, selectTags, selectTagsCount, maxCount);
+	return &index;
+}
+
+void TypeDatabase::buildReductionPathIndex( QueryState& qs, ReductionPathIndex& index,
+	const Scope::Step step, int fromType,
+	const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const
+{
+	// Same search as in deriveType_ but without a target, the path of the first visit of a type is the result of deriveType
+	// for this type and a second visit with the same weight is a conflict. Negative weights are rejected by defineReduction,
+	// so the types are visited in the order of their weight sums:
+	index.complete = false;
+	index.scopeIndependent = true;
+
+	ReduStack stack( qs.searchWorkspace.stack, qs.searchWorkspace.startTypes);
+	ReduQueue& priorityQueue = qs.searchWorkspace.queue;
+	priorityQueue.clear();
+	std::unordered_map<int,int> targetmap;
+	{
+		int stkidx = stack.pushNonDuplicateStart( fromType, 0/*constructor*/);
+		priorityQueue.push( ReduQueueElem( 0.0/*weight*/, stkidx));
+	}
+	while (!priorityQueue.empty())
+	{
+		auto qe = priorityQueue.pop();
+
+		if (stack.size() > (int)MaxReductionIndexSearchSize) return;
+
+		ReduStackElem elem = stack[ qe.index];
+		markIndexedType( elem.type);
+		if (isLocalReductionSource( elem.type)) index.scopeIndependent = false;
+
+		auto ins = targetmap.insert( {elem.type, (int)index.targets.size()});
+		if (ins.second)
+		{
+			index.targets.push_back( {elem.type, qe.index/*first*/, -1/*conflict*/, qe.weight});
+		}
+		else
+		{
+			ReductionPathTarget& target = index.targets[ ins.first->second];
+			if (target.conflict < 0 && qe.weight <= target.weightsum + std::numeric_limits<float>::epsilon())
+			{
+				++qs.queryStatistics.conflicts;
+				target.conflict = qe.index;
+			}
+		}
+		auto const& redulist = getReductionList( qs, step, elem.type, selectTags);
+
+		for (auto const& redu : redulist)
+		{
+			int pathlen = selectTagsCount.matches( redu.tagval()) ? (elem.pathlen+1) : elem.pathlen;
+			if (pathlen <= maxCount)
+			{
+				int stkidx = stack.pushIfNew( redu.right()/*type*/, redu.value()/*constructor*/, qe.index/*prev*/, pathlen);
+				if (stkidx >= 0)
+				{
+					priorityQueue.push( ReduQueueElem( qe.weight + redu.weight(), stkidx));
+				}
+			}
+		}
+	}
+	// Compress the tree of paths to the nodes referenced by the targets:
+	std::vector<int> nodemap( stack.size(), -1);
+	for (auto const& target : index.targets)
+	{
+		for (int si : {target.first, target.conflict})
+		{
+			for (; si >= 0 && nodemap[ si] < 0; si = stack[ si].prev)
+			{
+				nodemap[ si] = 0;
+			}
+		}
+	}
+	for (int si = 0; si < stack.size(); ++si)
+	{
+		if (nodemap[ si] >= 0)
+		{
+			// ... the predecessor has a lower index than the successor and is already mapped
+			auto const& elem = stack[ si];
+			nodemap[ si] = index.nodes.size();
+			index.nodes.push_back( {elem.type, elem.constructor, elem.prev >= 0 ? nodemap[ elem.prev] : -1});
+		}
+	}
+	for (auto& target : index.targets)
+	{
+		target.first = nodemap[ target.first];
+		if (target.conflict >= 0) target.conflict = nodemap[ target.conflict];
+	}
+	std::sort( index.targets.begin(), index.targets.end());
+	index.complete = true;
+}
+
+const TypeDatabase::ReductionEdgeIndex* TypeDatabase::getReductionEdgeIndex( QueryState& qs, int fromType, const TagMask& selectTags) const
+{
+	ReductionIndexKey key( fromType, selectTags.mask(), 0, 0);
+	auto ii = qs.reductionEdgeIndex.find( key);
+	if (ii != qs.reductionEdgeIndex.end())
+	{
+		++qs.reductionIndexStatistics.hits;
+		return &ii->second;
+	}
+	Scope::Step step = globalReductionStep();
+	if (step < 0) return nullptr;
+
+	++qs.reductionIndexStatistics.misses;
+	if (qs.reductionPathIndex.size() + qs.reductionEdgeIndex.size() >= MaxReductionIndexSize)
+	{
+		qs.reductionPathIndex.clear();
+		qs.reductionEdgeIndex.clear();
+	}
+	ReductionEdgeIndex& index = qs.reductionEdgeIndex[ key];
+	index.scopeIndependent = !isLocalReductionSource( fromType);
+	markIndexedType( fromType);
+
+	auto const& redulist = getReductionList( qs, step, fromType, selectTags);
+
+	// Same selection as in getReduction, the first ambiguity found is reported there:
+	for (auto const& redu : redulist)
+	{
+		auto ei = index.edges.begin();
+		for (; ei != index.edges.end() && ei->type != redu.right(); ++ei){}
+		if (ei == index.edges.end())
+		{
+			index.edges.push_back( {redu.right(), redu.value()/*constructor*/, redu.weight(), false});
+		}
+		else if (!ei->ambiguous)
+		{
+			if (ei->weight < redu.weight() - std::numeric_limits<float>::epsilon()) continue;
+			if (ei->weight <= redu.weight() + std::numeric_limits<float>::epsilon())
+			{
+				ei->ambiguous = true;
+			}
+			else
+			{
+				ei->constructor = redu.value();
+				ei->weight = redu.weight();
+			}
+		}
+	}
+	std::sort( index.edges.begin(), index.edges.end());
+	return &index;
+}
+
+static void addCacheStatistics( TypeDatabase::CacheStatistics& res, const TypeDatabase::CacheStatistics& stats) noexcept
+{
+	res.hits += stats.hits;
+	res.misses += stats.misses;
+	res.size += stats.size;
+}
+
+TypeDatabase::CacheStatistics TypeDatabase::reductionIndexStatistics() const noexcept
+{
+	CacheStatistics rt;
+	foreachQueryStateStatistics( [&rt]( const QueryStateStatistics& qs)
+	{
+		addCacheStatistics( rt, qs.reductionIndex);
+	});
+	return rt;
+}
+
+TypeDatabase::CacheStatistics TypeDatabase::deriveTypeCacheStatistics() const noexcept
+{
+	CacheStatistics rt;
+	foreachQueryStateStatistics( [&rt]( const QueryStateStatistics& qs)
+	{
+		addCacheStatistics( rt, qs.deriveCache);
+	});
+	return rt;
+}
+
+const std::vector<float>& TypeDatabase::getDeriveLowerBound( QueryState& qs, int toType) const
+{
+	auto& deriveLowerBounds = qs.deriveLowerBounds;
+	auto bi = deriveLowerBounds.find( toType);
+	if (bi != deriveLowerBounds.end()) return bi->second;
+
+	if (deriveLowerBounds.size() >= MaxDeriveLowerBoundTables)
+	{
+		deriveLowerBounds.clear();
+		qs.deriveLowerBoundsDropped = true;
+	}
+	// Calculate the minimal weight of a path from any type to the target type with a Dijkstra search on the reversed reductions
+	// of all scopes and tags. This is a lower bound for the weight of paths of a search with a subset of the reductions:
+	std::vector<float>& rt = deriveLowerBounds[ toType];
+	rt.resize( m_typerecMap.size()+1, std::numeric_limits<float>::infinity());
+	std::priority_queue<std::pair<float,int>,std::vector<std::pair<float,int> >,std::greater<std::pair<float,int> > > priorityQueue;
+	rt[ toType] = 0.0;
+	priorityQueue.push( {0.0, toType});
+	while (!priorityQueue.empty())
 	{
 		auto qe = priorityQueue.top();
 		priorityQueue.pop();
+		if (qe.first > rt[ qe.second] || qe.second >= (int)m_reverseReductions.size()) continue;
+
+		for (auto const& redu : m_reverseReductions[ qe.second])
+		{
+			float weight = qe.first + redu.weight;
+			if (weight < rt[ redu.fromType])
+			{
+				rt[ redu.fromType] = weight;
+				priorityQueue.push( {weight, redu.fromType});
+			}
+		}
+	}
+	return rt;
+}
+
+void TypeDatabase::deriveType_( QueryState& qs, DeriveResult& rt,
+	const Scope::Step step, int toType, int fromType,
+	const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, const std::vector<float>& lowerBound) const
+{
+	// The search skips types that cannot lead to the target or, after the first result has been found, not to a path with
+	// a weight of a conflicting result. The order of the remaining elements in the queue is not affected by this and the
+	// results including the conflict path reported are the same as with the complete search:
+	bool alt_searchstate = false;
+
+	ReduStack stack( qs.searchWorkspace.stack, qs.searchWorkspace.startTypes);
+	ReduQueue& priorityQueue = qs.searchWorkspace.queue;
+	priorityQueue.clear();
+	{
+		int index = stack.pushNonDuplicateStart( fromType, 0/*constructor*/);
+		priorityQueue.push( ReduQueueElem( 0.0/*weight*/, index));
+	}
+	while (!priorityQueue.empty())
+	{
+		auto qe = priorityQueue.pop();
 
 		if (alt_searchstate && qe.weight > rt.weightsum + std::numeric_limits<float>::epsilon()) break;
 		// ... weight bigger than best match, according Dijkstra we are done
 
-		auto const& elem = stack[ qe.index];
+		ReduStackElem elem = stack[ qe.index];
+		markSearchedType( elem.type);
 		if (elem.type == toType)
 		{
 			// ... we found a result
@@ -563,29 +1494,36 @@ TypeDatabase::DeriveResult TypeDatabase::deriveType(
 			else
 			{
 				// We have foud an alternative match with the same weight, report an ambiguous reference error:
+				++qs.queryStatistics.conflicts;
 				stack.collectConflictPath( rt.conflictPath, qe.index);
 				break;
 			}
 		}
 		// Put follow elements into priority queue:
-		int redu_buffer[ 512];
-		mewa::monotonic_buffer_resource redu_memrsc( redu_buffer, sizeof redu_buffer);
-		auto redulist = m_reduTable->get( step, elem.type, selectTags, &redu_memrsc);
+		auto const& redulist = getReductionList( qs, step, elem.type, selectTags);
 
 		for (auto const& redu : redulist)
 		{
 			int pathlen = selectTagsCount.matches( redu.tagval()) ? (elem.pathlen+1) : elem.pathlen;
 			if (pathlen <= maxCount)
 			{
+				float weight = qe.weight + redu.weight();
+				float maxweight = alt_searchstate ? rt.weightsum : std::numeric_limits<float>::max();
+				if (!lowerBoundAccepts( lowerBound, redu.right(), weight, maxweight))
+				{
+					// ... a reduction defined later from the type skipped may change the result, the caches have to be cleared then
+					markSearchedType( redu.right());
+					continue;
+				}
+
 				int index = stack.pushIfNew( redu.right()/*type*/, redu.value()/*constructor*/, qe.index/*prev*/, pathlen);
 				if (index >= 0)
 				{
-					priorityQueue.push( ReduQueueElem( qe.weight + redu.weight(), index));
+					priorityQueue.push( ReduQueueElem( weight, index));
 				}
 			}
 		}
 	}
-	return rt;
 }
 
 void TypeDatabase::collectResultItems( std::pmr::vector<int>& items, int typerecidx) const
@@ -601,31 +1539,128 @@ TypeDatabase::ResolveResult TypeDatabase::resolveType(
 		const Scope::Step step, const std::pmr::vector<int>& contextTypes,
 		const std::string_view& name, const TagMask& selectTags, ResultBuffer& resbuf) const
 {
-	return resolveType_( step, contextTypes.data(), contextTypes.size(), name, selectTags, resbuf);
+	QueryStateScope qss( *this);
+	return resolveType_( qss.state(), step, contextTypes.data(), contextTypes.size(), name, selectTags, resbuf);
 }
 
 TypeDatabase::ResolveResult TypeDatabase::resolveType(
 		const Scope::Step step, int contextType,
 		const std::string_view& name, const TagMask& selectTags, ResultBuffer& resbuf) const
 {
-	return resolveType_( step, &contextType, 1, name, selectTags, resbuf);
+	QueryStateScope qss( *this);
+	return resolveType_( qss.state(), step, &contextType, 1, name, selectTags, resbuf);
 }
 
-TypeDatabase::ResolveResult TypeDatabase::resolveType_(
+TypeDatabase::ResolveResult TypeDatabase::resolveType_( QueryState& qs,
 		const Scope::Step step, int const* contextTypeAr, std::size_t contextTypeSize,
 		const std::string_view& name, const TagMask& selectTags, ResultBuffer& resbuf) const
 {
 	ResolveResult rt( resbuf);
-	bool alt_searchstate = false;
+	++qs.queryStatistics.resolveTypeCalls;
 
 	int nameid = m_identMap->lookup( name);
 	if (!nameid) return rt;
 
-	int buffer[ 1024];
-	mewa::monotonic_buffer_resource stack_memrsc( buffer, sizeof buffer);
+	if (nameid > (int)m_nameScopeStates.size())
+	{
+		// ... no type with this name defined
+		resolveTypeSearch( qs, rt, step, contextTypeAr, contextTypeSize, nameid, std::vector<int>(), selectTags);
+		return rt;
+	}
+	const NameScopeState& state = m_nameScopeStates[ nameid-1];
+	if (contextTypeSize > MaxResolveCacheContextTypes)
+	{
+		resolveTypeSearch( qs, rt, step, contextTypeAr, contextTypeSize, nameid, state.contextTypes, selectTags);
+		return rt;
+	}
+	ResolveCacheKey key( scopeRegion( m_reduScopeBoundaries, step), scopeRegion( state.boundaries, step), nameid, state.generation,
+				selectTags.mask(), contextTypeAr, contextTypeSize);
+	auto ci = qs.resolveCache.find( key);
+	if (ci != qs.resolveCache.end())
+	{
+		++qs.resolveCacheStatistics.hits;
+		rt.reductions.insert( rt.reductions.end(), ci->second.reductions.begin(), ci->second.reductions.end());
+		rt.items.insert( rt.items.end(), ci->second.items.begin(), ci->second.items.end());
+		rt.rootIndex = ci->second.rootIndex;
+		rt.contextType = ci->second.contextType;
+		rt.conflictType = ci->second.conflictType;
+		rt.weightsum = ci->second.weightsum;
+		return rt;
+	}
+	++qs.resolveCacheStatistics.misses;
+	resolveTypeSearch( qs, rt, step, contextTypeAr, contextTypeSize, nameid, state.contextTypes, selectTags);
+
+	if (qs.resolveCache.size() >= MaxResolveCacheSize)
+	{
+		qs.resolveCache.clear();
+	}
+	qs.resolveCache.insert( {key, ResolveCacheValue{
+			std::vector<TypeConstructorPair>( rt.reductions.begin(), rt.reductions.end()),
+			std::vector<int>( rt.items.begin(), rt.items.end()),
+			rt.rootIndex, rt.contextType, rt.conflictType, rt.weightsum}});
+	return rt;
+}
+
+TypeDatabase::CacheStatistics TypeDatabase::resolveTypeCacheStatistics() const noexcept
+{
+	CacheStatistics rt;
+	foreachQueryStateStatistics( [&rt]( const QueryStateStatistics& qs)
+	{
+		addCacheStatistics( rt, qs.resolveCache);
+	});
+	return rt;
+}
+
+TypeDatabase::Statistics TypeDatabase::statistics() const
+{
+	Statistics rt;
+	rt.nofTypes = m_typerecMap.size();
+	rt.nofReductions = m_reduAdjacency.size();
+	rt.nofIdentifiers = m_identMap->size();
+	rt.nofObjectInstances = 0;
+	for (auto const& oa : m_objAr)
+	{
+		rt.nofObjectInstances += oa.size();
+	}
+	rt.identmap = m_memory->statistics_identmap();
+	if (m_frozen)
+	{
+		// ... the strings of types are allocated from the memory of identifier strings by concurrent calls of typeString
+		std::lock_guard<std::mutex> lock( m_typeStringMutex);
+		rt.identstr = m_memory->statistics_identstr();
+	}
+	else
+	{
+		rt.identstr = m_memory->statistics_identstr();
+	}
+	rt.typetab = m_memory->statistics_typetab();
+	rt.redutab = m_memory->statistics_redutab();
+	rt.objtab = m_memory->statistics_objtab();
+	rt.deriveTypeCalls = 0;
+	rt.resolveTypeCalls = 0;
+	rt.nodesExpanded = 0;
+	rt.queuePushes = 0;
+	rt.conflicts = 0;
+	foreachQueryStateStatistics( [&rt]( const QueryStateStatistics& qs)
+	{
+		rt.deriveTypeCalls += qs.queries.deriveTypeCalls;
+		rt.resolveTypeCalls += qs.queries.resolveTypeCalls;
+		rt.nodesExpanded += qs.nodesExpanded;
+		rt.queuePushes += qs.queuePushes;
+		rt.conflicts += qs.queries.conflicts;
+	});
+	return rt;
+}
+
+void TypeDatabase::resolveTypeSearch( QueryState& qs, ResolveResult& rt,
+		const Scope::Step step, int const* contextTypeAr, std::size_t contextTypeSize,
+		int nameid, const std::vector<int>& nameContextTypes, const TagMask& selectTags) const
+{
+	bool alt_searchstate = false;
 
-	ReduStack stack( &stack_memrsc, sizeof buffer);
-	std::priority_queue<ReduQueueElem,LocalMemVector<ReduQueueElem>,std::greater<ReduQueueElem> > priorityQueue;
+	ReduStack stack( qs.searchWorkspace.stack, qs.searchWorkspace.startTypes);
+	ReduQueue& priorityQueue = qs.searchWorkspace.queue;
+	priorityQueue.clear();
 
 	std::size_t ci = 0;
 	for (; ci < contextTypeSize; ++ci)
@@ -637,17 +1672,26 @@ TypeDatabase::ResolveResult TypeDatabase::resolveType_(
 		int index = stack.pushNonDuplicateStart( contextTypeAr[ci], (int)ci+1/*root index stored as constructor*/);
 		if (index >= 0) priorityQueue.push( ReduQueueElem( 0.0/*weight*/, index));
 	}
+	if (nameContextTypes.empty()) return; // ... no context type with a definition of this name, the search cannot find anything
+	int minContextType = nameContextTypes.front();
+	int maxContextType = nameContextTypes.back();
+
 	while (!priorityQueue.empty())
 	{
-		auto qe = priorityQueue.top();
-		priorityQueue.pop();
+		auto qe = priorityQueue.pop();
 
 		if (alt_searchstate && qe.weight > rt.weightsum + std::numeric_limits<float>::epsilon()) break;
 		// ... weight bigger than best match, according Dijkstra we are done
 
-		auto const& elem = stack[ qe.index];
+		ReduStackElem elem = stack[ qe.index];
+		markSearchedType( elem.type);
 
-		int typerecidx = m_typeTable->get( step, TypeDef( elem.type, nameid));
+		int typerecidx = 0;
+		if (elem.type >= minContextType && elem.type <= maxContextType
+			&& std::binary_search( nameContextTypes.begin(), nameContextTypes.end(), elem.type))
+		{
+			typerecidx = m_typeTable->get( step, TypeDef( elem.type, nameid));
+		}
 		if (typerecidx)
 		{
 			//... we found a match
@@ -664,13 +1708,12 @@ TypeDatabase::ResolveResult TypeDatabase::resolveType_(
 			else
 			{
 				// We have foud an alternative match with the same weight, report an ambiguous reference error:
+				++qs.queryStatistics.conflicts;
 				rt.conflictType = elem.type;
 				break;
 			}
 		}
-		int redu_buffer[ 512];
-		mewa::monotonic_buffer_resource redu_memrsc( redu_buffer, sizeof redu_buffer);
-		auto redulist = m_reduTable->get( step, elem.type, selectTags, &redu_memrsc);
+		auto const& redulist = getReductionList( qs, step, elem.type, selectTags);
 
 		for (auto const& redu : redulist)
 		{
@@ -682,6 +1725,77 @@ TypeDatabase::ResolveResult TypeDatabase::resolveType_(
 			}
 		}
 	}
+}
+
+TypeDatabase::ResolveCallableResult TypeDatabase::resolveCallable( const Scope::Step step, const TypeList& items, const TypeList& argTypes,
+		const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount,
+		WeightAccumulation accumulation, float minWeight, ResultBuffer& resbuf) const
+{
+	ResolveCallableResult rt( resbuf);
+	rt.nofArguments = argTypes.arsize;
+	QueryStateScope qss( *this);
+	rt.reductionRanges.push_back( 0);
+	rt.conflictRanges.push_back( 0);
+
+	// Reductions of the arguments of the candidate evaluated, copied to the result if it is one of the best:
+	std::vector<TypeConstructorPair> reductions;
+	std::vector<int> reductionRanges;
+	std::vector<int> conflictPaths;
+	std::vector<int> conflictRanges;
+
+	for (int ii = 0; ii < items.arsize; ++ii)
+	{
+		int item = items.ar[ ii];
+		if (item <= 0 || item > (int)m_typerecMap.size()) throw Error( Error::InvalidHandle, string_format( "%d", item));
+
+		const TypeRecord& rec = m_typerecMap[ item-1];
+		if (rec.parameterlen != argTypes.arsize) continue;
+
+		reductions.clear();
+		reductionRanges.clear();
+		conflictPaths.clear();
+		conflictRanges.clear();
+
+		float weight = 0.0;
+		int ai = 0;
+		for (; ai < argTypes.arsize; ++ai)
+		{
+			int paramType = m_parameterMap[ rec.parameter - 1 + ai].type;
+			if (paramType != argTypes.ar[ ai])
+			{
+				ResultBuffer derivebuf;
+				auto deriveres = deriveType( qss.state(), step, paramType, argTypes.ar[ ai], selectTags, selectTagsCount, maxCount, derivebuf);
+				if (!deriveres.defined) break;
+
+				weight = (accumulation == AccumulateMax) ? std::max( weight, deriveres.weightsum) : (weight + deriveres.weightsum);
+				if (rt.defined() && weight > rt.weight + std::numeric_limits<float>::epsilon()) break;
+				// ... the weight of the candidate can only grow, it cannot be one of the best anymore
+
+				reductions.insert( reductions.end(), deriveres.reductions.begin(), deriveres.reductions.end());
+				conflictPaths.insert( conflictPaths.end(), deriveres.conflictPath.begin(), deriveres.conflictPath.end());
+			}
+			reductionRanges.push_back( reductions.size());
+			conflictRanges.push_back( conflictPaths.size());
+		}
+		if (ai < argTypes.arsize) continue;
+		if (minWeight >= 0.0 && weight <= minWeight + std::numeric_limits<float>::epsilon()) continue;
+
+		if (!rt.defined() || weight < rt.weight - std::numeric_limits<float>::epsilon())
+		{
+			// ... the candidate is the single best match found
+			rt.items.clear();
+			rt.reductions.clear();
+			rt.reductionRanges.resize( 1);
+			rt.conflictPaths.clear();
+			rt.conflictRanges.resize( 1);
+			rt.weight = weight;
+		}
+		rt.items.push_back( item);
+		for (int range : reductionRanges) rt.reductionRanges.push_back( rt.reductions.size() + range);
+		for (int range : conflictRanges) rt.conflictRanges.push_back( rt.conflictPaths.size() + range);
+		rt.reductions.insert( rt.reductions.end(), reductions.begin(), reductions.end());
+		rt.conflictPaths.insert( rt.conflictPaths.end(), conflictPaths.begin(), conflictPaths.end());
+	}
 	return rt;
 }
 
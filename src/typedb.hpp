@@ -19,12 +19,15 @@
 #include "identmap.hpp"
 #include "tree.hpp"
 #include "memory_resource.hpp"
+#include "typedb_search.hpp"
 #include <string_view>
 #include <vector>
 #include <cstdlib>
 #include <memory>
 #include <utility>
 #include <algorithm>
+#include <unordered_map>
+#include <mutex>
 
 namespace mewa {
 
@@ -33,7 +36,13 @@ class TypeDatabase
 public:
 	explicit TypeDatabase( std::size_t initmemsize = 1<<26)
 		:m_memblock(std::max((initmemsize/8) *8,(std::size_t)1024)),m_memory()
-		,m_objidMap(),m_objAr(),m_typeTable(),m_reduTable(),m_identMap(),m_parameterMap(),m_typerecMap()
+		,m_objidMap(),m_objAr(),m_typeTable(),m_reduTable(),m_identMap(),m_parameterMap(),m_typerecMap(),m_signatureIndex()
+		,m_reduScopeBoundaries()
+		,m_nameScopeStates(),m_searchedTypes()
+		,m_reductionsFrozen(false),m_localReductionScopes(),m_localReductionSources(),m_localReductionCover(),m_localReductionCoverValid(true)
+		,m_indexedTypes(),m_reverseReductions(),m_reduAdjacency(),m_queryState()
+		,m_frozen(false),m_queryStateMutex(),m_queryStates(),m_freeQueryStates()
+		,m_typeStrings(),m_typeStringMutex()
 	{
 		m_memory.reset( new Memory( m_memblock.ptr, m_memblock.size));
 
@@ -223,6 +232,66 @@ public:
 			:reductions(std::move(o.reductions)),items(std::move(o.items))
 			,rootIndex(o.rootIndex),contextType(o.contextType),conflictType(o.conflictType),weightsum(o.weightsum){}
 	};
+	/// \brief Result of a deriveTypeTargets query for one of the target types
+	/// \note The path found is [reductionsStart, reductionsEnd) and the conflict path [conflictStart, conflictEnd) in the lists of the result
+	struct DeriveTarget
+	{
+		int reductionsStart;
+		int reductionsEnd;
+		int conflictStart;
+		int conflictEnd;
+		float weightsum;
+		bool defined;
+	};
+	/// \brief Result of a deriveTypeTargets query, the paths with the minimal sum of weights from one type to each type of a set of types
+	struct DeriveTargetsResult
+	{
+		std::pmr::vector<DeriveTarget> targets;
+		std::pmr::vector<TypeConstructorPair> reductions;
+		std::pmr::vector<int> conflictPaths;
+		int nearest;		//< index of the first target with the minimal weight sum, -1 if no target can be derived
+
+		DeriveTargetsResult( ResultBuffer& resbuf) noexcept
+			:targets(&resbuf.memrsc),reductions(&resbuf.memrsc),conflictPaths(&resbuf.memrsc),nearest(-1)
+		{
+			reductions.reserve( resbuf.buffersize() / 2 / sizeof(TypeConstructorPair));
+		}
+		DeriveTargetsResult( const DeriveTargetsResult&) = delete;
+		DeriveTargetsResult( DeriveTargetsResult&& o)
+			:targets(std::move(o.targets)),reductions(std::move(o.reductions)),conflictPaths(std::move(o.conflictPaths)),nearest(o.nearest){}
+	};
+	/// \brief Candidates with the best weight of a resolveCallable query
+	/// \note The reductions of the argument ai of the candidate ci are the elements [reductionRanges[k], reductionRanges[k+1]) of reductions with k = ci*nofArguments+ai,
+	///	the conflict path of a derivation of an argument (empty if the derivation is unique) is defined the same way with conflictRanges and conflictPaths
+	struct ResolveCallableResult
+	{
+		std::pmr::vector<int> items;
+		std::pmr::vector<int> reductionRanges;
+		std::pmr::vector<TypeConstructorPair> reductions;
+		std::pmr::vector<int> conflictRanges;
+		std::pmr::vector<int> conflictPaths;
+		int nofArguments;
+		float weight;
+
+		ResolveCallableResult( ResultBuffer& resbuf) noexcept
+			:items(&resbuf.memrsc),reductionRanges(&resbuf.memrsc),reductions(&resbuf.memrsc)
+			,conflictRanges(&resbuf.memrsc),conflictPaths(&resbuf.memrsc),nofArguments(0),weight(0.0)
+		{
+			reductions.reserve( resbuf.buffersize() / 2 / sizeof(TypeConstructorPair));
+		}
+		ResolveCallableResult( const ResolveCallableResult&) = delete;
+		ResolveCallableResult( ResolveCallableResult&& o)
+			:items(std::move(o.items)),reductionRanges(std::move(o.reductionRanges)),reductions(std::move(o.reductions))
+			,conflictRanges(std::move(o.conflictRanges)),conflictPaths(std::move(o.conflictPaths)),nofArguments(o.nofArguments),weight(o.weight){}
+
+		bool defined() const noexcept	{return !items.empty();}
+	};
+	/// \brief Function accumulating the weights of the derivations of the arguments to the weight of a callable candidate
+	enum WeightAccumulation
+	{
+		AccumulateSum,		///< sum of the weights
+		AccumulateMax		///< maximum of the weights
+	};
 	struct ReductionDefinition
 	{
 		int toType;
@@ -236,6 +305,38 @@ public:
 		ReductionDefinition( int toType_, int fromType_, int constructor_, int tag_, float weight_) noexcept
 			:toType(toType_),fromType(fromType_),constructor(constructor_),tag(tag_),weight(weight_){}
 	};
+	struct CacheStatistics
+	{
+		long hits;		///< number of queries answered from the cache
+		long misses;		///< number of queries not found in the cache
+		std::size_t size;	///< number of results currently stored in the cache
+
+		CacheStatistics() noexcept
+			:hits(0),misses(0),size(0){}
+	};
+	struct MemoryStatistics
+	{
+		std::size_t used;	///< number of bytes allocated from the part of the memory block assigned to the resource
+		std::size_t size;	///< size of the part of the memory block assigned to the resource in bytes
+		std::size_t upstream;	///< number of bytes allocated from the system because the part of the memory block was exhausted
+	};
+	struct Statistics
+	{
+		std::size_t nofTypes;		///< number of types defined
+		std::size_t nofReductions;	///< number of reductions defined
+		std::size_t nofIdentifiers;	///< number of identifiers (names of types and object instances)
+		std::size_t nofObjectInstances;	///< number of object instances defined (object names with scopes)
+		MemoryStatistics identmap;	///< memory used by the map of identifiers
+		MemoryStatistics identstr;	///< memory used by the strings of identifiers
+		MemoryStatistics typetab;	///< memory used by the table of types
+		MemoryStatistics redutab;	///< memory used by the table of reductions
+		MemoryStatistics objtab;	///< memory used by the table of object instances
+		long deriveTypeCalls;		///< number of type derivations queried (deriveType, a target of deriveTypeTargets)
+		long resolveTypeCalls;		///< number of resolveType queries
+		long nodesExpanded;		///< number of nodes taken from the priority queue by all searches
+		long queuePushes;		///< number of nodes put into the priority queue by all searches
+		long conflicts;			///< number of ambiguous results (conflicting paths of the same weight) found by all searches
+	};
 	typedef std::vector<ReductionDefinition> ReductionDefinitionList;
 	typedef std::vector<int> TypeDefinitionList;
 
@@ -354,6 +455,69 @@ public:
 	DeriveResult deriveType( const Scope::Step step, int toType, int fromType, 
 				 const TagMask& selectTags, const TagMask& selectTagsPathLength, int maxPathLengthCount, ResultBuffer& resbuf) const;
 
+	/// \brief Search for the sequences of reductions with the minimal sum of weights from one type to each type of a set of types with one search
+	/// \note The result for each target type is the same as the result of deriveType for it. The results are taken from the index
+	///	of best paths (freezeReductions) or the cache of deriveType if available, the remaining targets are searched with one expansion of the reductions
+	/// \param[in] step the scope-step of the search defining what are valid reductions
+	/// \param[in] toTypes the target types of the reduction
+	/// \param[in] fromType the source type of the reduction
+	/// \param[in] selectTags set of tags selecting the reduction classes to use in this search
+	/// \param[in] selectTagsCount set of tags (subset of selectTags) that contribute to length count of the search
+	/// \param[in] maxCount maximum count (number of reductions matching selectTagsCount) of an accepted result, -1 for undefined
+	/// \param[in,out] resbuf the buffer used for memory allocation when building the result (allocate memory on the stack instead of the heap)
+	/// \return the path found, its weight sum and a conflict path if the solution is not unique for each target type and the index of the nearest target
+	DeriveTargetsResult deriveTypeTargets( const Scope::Step step, const TypeList& toTypes, int fromType,
+				 const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, ResultBuffer& resbuf) const;
+
+	/// \brief Get the counters of the cache of results of deriveType
+	/// \note The cache is invalidated by a call of defineReduction from a type visited by a search for a cached result
+	/// \return the number of hits and misses and the number of results stored
+	CacheStatistics deriveTypeCacheStatistics() const noexcept;
+
+	/// \brief Declare the reductions defined in the global scope [0,INF] as complete.
+	/// \note From now on deriveType and getReduction are answered from an index of best paths over the reductions of the global scope,
+	///	built once per source type and set of tags in use. An entry of the index is used if no reduction of another scope from a type
+	///	visited by its search exists or if no reduction of another scope is visible from the scope-step of the query.
+	///	Reductions defined later from a type visited by a search of the index invalidate it.
+	///	The pending reductions are merged into the compacted adjacency lists used by the searches.
+	void freezeReductions();
+
+	/// \brief Evaluate if freezeReductions has been called
+	/// \return true if the reductions have been frozen
+	bool reductionsFrozen() const noexcept
+	{
+		return m_reductionsFrozen;
+	}
+
+	/// \brief Make the database read-only and its queries thread-safe
+	/// \note	Calls freezeReductions. From now on the definitions (setObjectInstance, defineType, defineTypeAs, defineReduction) throw an error.
+	///	The queries (getObjectInstance, getType, getTypes, getReduction, getReductions, deriveType, deriveTypeTargets, resolveType,
+	///	resolveCallable and the type attributes like typeToString) can be called from different threads concurrently.
+	///	A query uses a state with the caches and the buffers of the searches taken from a pool for exclusive use,
+	///	so there are as many states as threads querying at the same time. The statistics are the sums over all states.
+	void freeze();
+
+	/// \brief Evaluate if freeze has been called
+	/// \return true if the database is read-only
+	bool frozen() const noexcept
+	{
+		return m_frozen;
+	}
+
+	/// \brief Get the counters of the index of best paths of reductions built after freezeReductions
+	/// \return the number of queries answered from the index, the number of index entries built and the number of entries stored
+	CacheStatistics reductionIndexStatistics() const noexcept;
+
+	/// \brief Get the counters of the cache of results of resolveType
+	/// \note The cache is invalidated by a call of defineReduction from a type visited by a search for a cached result,
+	///	the results for a name by every call of defineType or defineTypeAs with this name
+	/// \return the number of hits and misses and the number of results stored
+	CacheStatistics resolveTypeCacheStatistics() const noexcept;
+
+	/// \brief Get the number of definitions, the memory used and the counters of the work done by the queries
+	/// \note The counters are cumulative since the creation of the type database
+	Statistics statistics() const;
+
 	/// \brief Resolve a type name in a context reducible from one of the contexts passed
 	/// \param[in] step the scope-step of the search defining what are valid reductions
 	/// \param[in] contextTypes the context of the candidate query types.
@@ -376,6 +540,23 @@ public:
 	ResolveResult resolveType( const Scope::Step step, int contextType,
 				   const std::string_view& name, const TagMask& selectTags, ResultBuffer& resbuf) const;
 
+	/// \brief Select the callable items with parameters matching the arguments passed with the minimal weight (overload resolution)
+	/// \note The weight of a candidate is the accumulated weight of the derivations (deriveType) of its parameter types from the argument types.
+	///	Only items with as many parameters as arguments are candidates. The evaluation of a candidate stops as soon as its partial weight exceeds the best weight found.
+	/// \param[in] step the scope-step of the search defining what are valid reductions
+	/// \param[in] items the candidate items, types with parameters
+	/// \param[in] argTypes the types of the arguments
+	/// \param[in] selectTags set of tags selecting the reduction classes used to derive the arguments
+	/// \param[in] selectTagsCount set of tags (subset of selectTags) that contribute to length count of a derivation
+	/// \param[in] maxCount maximum count (number of reductions matching selectTagsCount) of an accepted derivation, -1 for undefined
+	/// \param[in] accumulation function accumulating the weights of the arguments
+	/// \param[in] minWeight only candidates with a bigger weight are selected, negative for none, used to iterate through the groups of candidates by ascending weight
+	/// \param[in,out] resbuf buffer used for memory allocation when building the result (allocate memory on the stack instead of the heap)
+	/// \return the candidates with the best weight in the order of the items passed, more than one if the match is ambiguous, with the reductions of each argument
+	ResolveCallableResult resolveCallable( const Scope::Step step, const TypeList& items, const TypeList& argTypes,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount,
+				WeightAccumulation accumulation, float minWeight, ResultBuffer& resbuf) const;
+
 	/// \brief Get the string representation of a type
 	/// \param[in] type the handle of the type (return value of defineType)
 	/// \param[in] sep separator between type elements
@@ -383,6 +564,13 @@ public:
 	/// \return the complete string assigned to a type
 	std::pmr::string typeToString( int type, const char* sep, ResultBuffer& resbuf) const;
 
+	/// \brief Get the string representation of a type without copying it
+	/// \note The string is rendered on the first call for a type and separator and stored in the memory of the database, later calls return it directly
+	/// \param[in] type the handle of the type (return value of defineType)
+	/// \param[in] sep separator between type elements
+	/// \return the complete string assigned to a type, valid as long as the database exists
+	std::string_view typeString( int type, const char* sep) const;
+
 	/// \brief Get the name of a type (without context info and parameters)
 	/// \param[in] type the handle of the type (return value of defineType)
 	/// \return the name string of a type (name parameter of define type)
@@ -418,10 +606,39 @@ private:
 	std::string reductionsToString( const std::pmr::vector<TypeConstructorPair>& reductions) const;
 	std::string deriveResultToString( const DeriveResult& res) const;
 	std::string resolveResultToString( const ResolveResult& res) const;
-	void appendTypeToString( std::pmr::string& res, int type, const char* sep) const;
+	std::string_view typeString_( int type, const char* sep) const;
 	std::string debugTypeToString( int type, const char* sep) const;
-	ResolveResult resolveType_( const Scope::Step step, int const* contextTypeAr, std::size_t contextTypeSize,
+	struct QueryState;
+	DeriveResult deriveType( QueryState& qs, const Scope::Step step, int toType, int fromType,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, ResultBuffer& resbuf) const;
+	void deriveType_( QueryState& qs, DeriveResult& result, const Scope::Step step, int toType, int fromType,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount, const std::vector<float>& lowerBound) const;
+	const std::vector<float>& getDeriveLowerBound( QueryState& qs, int toType) const;
+	struct DeriveCacheValue;
+	void deriveTypeTargets_( QueryState& qs, std::vector<DeriveCacheValue>& results, const std::vector<int>& toTypes,
+				const Scope::Step step, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const;
+	static Scope::Step scopeRegion( const std::vector<Scope::Step>& boundaries, const Scope::Step step) noexcept;
+	static void addScopeBoundaries( std::vector<Scope::Step>& boundaries, const Scope& scope);
+	struct TypeDef;
+	void addNameDefinition( const TypeDef& typeDef, const Scope& scope);
+	void checkNotFrozen() const;
+	void markSearchedType( int type) const;
+	void markIndexedType( int type) const;
+	bool isLocalReductionSource( int type) const noexcept;
+	void updateLocalReductionCover() const;
+	bool localReductionVisible( const Scope::Step step) const;
+	Scope::Step globalReductionStep() const;
+	ResolveResult resolveType_( QueryState& qs, const Scope::Step step, int const* contextTypeAr, std::size_t contextTypeSize,
 				   const std::string_view& name, const TagMask& selectTags, ResultBuffer& resbuf) const;
+	struct ReductionPathIndex;
+	struct ReductionEdgeIndex;
+	const ReductionPathIndex* getReductionPathIndex( QueryState& qs, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const;
+	void buildReductionPathIndex( QueryState& qs, ReductionPathIndex& index, const Scope::Step step, int fromType,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount) const;
+	const ReductionEdgeIndex* getReductionEdgeIndex( QueryState& qs, int fromType, const TagMask& selectTags) const;
+	void resolveTypeSearch( QueryState& qs, ResolveResult& result, const Scope::Step step, int const* contextTypeAr, std::size_t contextTypeSize,
+				int nameid, const std::vector<int>& nameContextTypes, const TagMask& selectTags) const;
+	const std::vector<ScopedRelationMap<int,int>::ResultElement>& getReductionList( QueryState& qs, const Scope::Step step, int fromType, const TagMask& selectTags) const;
 
 private:
 	struct MemoryBlock
@@ -462,6 +679,12 @@ private:
 		std::pmr::memory_resource* resource_redutab() noexcept		{return &m_redutab_memrsc;}
 		std::pmr::memory_resource* resource_objtab() noexcept		{return &m_objtab_memrsc;}
 
+		MemoryStatistics statistics_identmap() const noexcept		{return statistics( m_identmap_memrsc);}
+		MemoryStatistics statistics_identstr() const noexcept		{return statistics( m_identstr_memrsc);}
+		MemoryStatistics statistics_typetab() const noexcept		{return statistics( m_typetab_memrsc);}
+		MemoryStatistics statistics_redutab() const noexcept		{return statistics( m_redutab_memrsc);}
+		MemoryStatistics statistics_objtab() const noexcept		{return statistics( m_objtab_memrsc);}
+
 		std::size_t nofIdentInitBuckets() const noexcept		{return m_nofInitBuckets;}
 		std::size_t nofScopedMapInitBuckets() const noexcept		{return m_nofInitBuckets;}
 		std::size_t nofReductionMapInitBuckets() const noexcept		{return std::max( m_nofInitBuckets/2, (std::size_t)1024);}
@@ -469,6 +692,12 @@ private:
 		std::size_t nofTypeRecordMapInitBuckets() const noexcept	{return m_nofInitBuckets;}
 		std::size_t nofObjectInstanceTableInitBuckets() const noexcept	{return std::max( m_nofInitBuckets/8, (std::size_t)1024);}
 
+	private:
+		static MemoryStatistics statistics( const mewa::monotonic_buffer_resource& memrsc) noexcept
+		{
+			return MemoryStatistics{memrsc.bytesUsed(), memrsc.bytesAvailable(), memrsc.bytesUpstream()};
+		}
+
 	private:
 		mewa::monotonic_buffer_resource m_identmap_memrsc;
 		mewa::monotonic_buffer_resource m_identstr_memrsc;
@@ -480,7 +709,13 @@ private:
 
 private:
 	enum {
-		MaxNofParameter = 1U<<15
+		MaxNofParameter = 1U<<15,
+		MaxDeriveCacheSize = 1U<<14,
+		MaxResolveCacheSize = 1U<<14,
+		MaxResolveCacheContextTypes = 8,
+		MaxReductionIndexSize = 1U<<12,
+		MaxReductionIndexSearchSize = 1U<<14,
+		MaxDeriveLowerBoundTables = 1U<<8
 	};
 	struct TypeDef
 	{
@@ -502,6 +737,269 @@ private:
 	typedef ScopedMap<TypeDef,int> TypeTable;
 	typedef ScopedRelationMap<int,int> ReductionTable;
 
+	/// \brief Arguments of a deriveType query identifying a cached result
+	/// \note The scope-step is represented by the start of the region between two start or end steps of reduction scopes, all steps in a region see the same reductions
+	struct DeriveCacheKey
+	{
+		Scope::Step region;
+		int toType;
+		int fromType;
+		TagMask::BitSet selectTags;
+		TagMask::BitSet selectTagsCount;
+		int maxCount;
+
+		DeriveCacheKey( Scope::Step region_, int toType_, int fromType_, TagMask::BitSet selectTags_, TagMask::BitSet selectTagsCount_, int maxCount_) noexcept
+			:region(region_),toType(toType_),fromType(fromType_),selectTags(selectTags_),selectTagsCount(selectTagsCount_),maxCount(maxCount_){}
+
+		bool operator == (const DeriveCacheKey& o) const noexcept
+		{
+			return region == o.region && toType == o.toType && fromType == o.fromType
+				&& selectTags == o.selectTags && selectTagsCount == o.selectTagsCount && maxCount == o.maxCount;
+		}
+	};
+	struct DeriveCacheKeyHash
+	{
+		std::size_t operator()( const DeriveCacheKey& key) const noexcept
+		{
+			std::size_t rt = (std::size_t)key.region;
+			rt = rt * 1000003 ^ (std::size_t)key.toType;
+			rt = rt * 1000003 ^ (std::size_t)key.fromType;
+			rt = rt * 1000003 ^ (std::size_t)key.selectTags;
+			rt = rt * 1000003 ^ (std::size_t)key.selectTagsCount;
+			rt = rt * 1000003 ^ (std::size_t)key.maxCount;
+			return rt;
+		}
+	};
+	/// \brief Result of a deriveType query stored in the cache
+	struct DeriveCacheValue
+	{
+		std::vector<TypeConstructorPair> reductions;
+		std::vector<int> conflictPath;
+		float weightsum;
+		bool defined;
+	};
+	typedef std::unordered_map<DeriveCacheKey,DeriveCacheValue,DeriveCacheKeyHash> DeriveCache;
+
+	/// \brief Counters of the queries, part of the statistics
+	struct QueryStatistics
+	{
+		long deriveTypeCalls;
+		long resolveTypeCalls;
+		long conflicts;
+
+		QueryStatistics() noexcept
+			:deriveTypeCalls(0),resolveTypeCalls(0),conflicts(0){}
+	};
+	/// \brief Scope boundaries and generation of the definitions of types with the same name, used to identify cached resolveType results
+	struct NameScopeState
+	{
+		int generation;				//< incremented with every definition of a type with this name
+		std::vector<Scope::Step> boundaries;	//< sorted list of start and end steps of all scopes of types defined with this name
+		std::vector<int> contextTypes;		//< sorted list of the context types of all types defined with this name, used by resolveType to skip context types without definitions
+
+		NameScopeState()
+			:generation(0),boundaries(),contextTypes(){}
+	};
+	/// \brief Arguments of a resolveType query identifying a cached result
+	/// \note Queries with more than MaxResolveCacheContextTypes context types are not cached
+	struct ResolveCacheKey
+	{
+		Scope::Step reduRegion;
+		Scope::Step nameRegion;
+		int nameid;
+		int generation;
+		TagMask::BitSet selectTags;
+		int nofContextTypes;
+		int contextTypes[ MaxResolveCacheContextTypes];
+
+		ResolveCacheKey( Scope::Step reduRegion_, Scope::Step nameRegion_, int nameid_, int generation_, TagMask::BitSet selectTags_,
+				 int const* contextTypeAr, std::size_t contextTypeSize) noexcept
+			:reduRegion(reduRegion_),nameRegion(nameRegion_),nameid(nameid_),generation(generation_),selectTags(selectTags_),nofContextTypes(contextTypeSize)
+		{
+			std::fill( std::copy( contextTypeAr, contextTypeAr + contextTypeSize, contextTypes), contextTypes + MaxResolveCacheContextTypes, 0);
+		}
+
+		bool operator == (const ResolveCacheKey& o) const noexcept
+		{
+			return reduRegion == o.reduRegion && nameRegion == o.nameRegion && nameid == o.nameid && generation == o.generation
+				&& selectTags == o.selectTags && nofContextTypes == o.nofContextTypes
+				&& std::equal( contextTypes, contextTypes + MaxResolveCacheContextTypes, o.contextTypes);
+		}
+	};
+	struct ResolveCacheKeyHash
+	{
+		std::size_t operator()( const ResolveCacheKey& key) const noexcept
+		{
+			std::size_t rt = (std::size_t)key.reduRegion;
+			rt = rt * 1000003 ^ (std::size_t)key.nameRegion;
+			rt = rt * 1000003 ^ (std::size_t)key.nameid;
+			rt = rt * 1000003 ^ (std::size_t)key.generation;
+			rt = rt * 1000003 ^ (std::size_t)key.selectTags;
+			for (int ci = 0; ci < key.nofContextTypes; ++ci)
+			{
+				rt = rt * 1000003 ^ (std::size_t)key.contextTypes[ ci];
+			}
+			return rt;
+		}
+	};
+	/// \brief Result of a resolveType query stored in the cache
+	struct ResolveCacheValue
+	{
+		std::vector<TypeConstructorPair> reductions;
+		std::vector<int> items;
+		int rootIndex;
+		int contextType;
+		int conflictType;
+		float weightsum;
+	};
+	typedef std::unordered_map<ResolveCacheKey,ResolveCacheValue,ResolveCacheKeyHash> ResolveCache;
+
+	/// \brief Source type and tags identifying an entry of the reduction index
+	/// \note The fields selectTagsCount and maxCount are 0 for entries of the index of single reductions used by getReduction
+	struct ReductionIndexKey
+	{
+		int fromType;
+		TagMask::BitSet selectTags;
+		TagMask::BitSet selectTagsCount;
+		int maxCount;
+
+		ReductionIndexKey( int fromType_, TagMask::BitSet selectTags_, TagMask::BitSet selectTagsCount_, int maxCount_) noexcept
+			:fromType(fromType_),selectTags(selectTags_),selectTagsCount(selectTagsCount_),maxCount(maxCount_){}
+
+		bool operator == (const ReductionIndexKey& o) const noexcept
+		{
+			return fromType == o.fromType && selectTags == o.selectTags && selectTagsCount == o.selectTagsCount && maxCount == o.maxCount;
+		}
+	};
+	struct ReductionIndexKeyHash
+	{
+		std::size_t operator()( const ReductionIndexKey& key) const noexcept
+		{
+			std::size_t rt = (std::size_t)key.fromType;
+			rt = rt * 1000003 ^ (std::size_t)key.selectTags;
+			rt = rt * 1000003 ^ (std::size_t)key.selectTagsCount;
+			rt = rt * 1000003 ^ (std::size_t)key.maxCount;
+			return rt;
+		}
+	};
+	/// \brief Node of the tree of best paths from a source type, linked to the root by the index of the predecessor
+	struct ReductionPathNode
+	{
+		int type;
+		int constructor;
+		int prev;
+	};
+	/// \brief Best path (and a conflicting path of the same weight if it exists) from a source type to a target type
+	struct ReductionPathTarget
+	{
+		int type;
+		int first;		//< index of the node of the best path in the tree
+		int conflict;		//< index of the node of the conflicting path in the tree, -1 if the best path is unique
+		float weightsum;
+
+		bool operator < (const ReductionPathTarget& o) const noexcept	{return type < o.type;}
+	};
+	/// \brief Best paths from a source type to all types reachable with the reductions of the global scope
+	struct ReductionPathIndex
+	{
+		bool complete;					//< false if the search got too big, queries fall back to the search then
+		bool scopeIndependent;				//< true if no type visited is the source of a reduction of another scope than the global scope
+		std::vector<ReductionPathNode> nodes;		//< tree of best paths
+		std::vector<ReductionPathTarget> targets;	//< targets sorted by type
+	};
+	/// \brief Single reduction of the global scope from a source type
+	struct ReductionEdge
+	{
+		int type;
+		int constructor;
+		float weight;
+		bool ambiguous;		//< true if there are reductions to this type with the same weight
+
+		bool operator < (const ReductionEdge& o) const noexcept	{return type < o.type;}
+	};
+	/// \brief Single reductions of the global scope from a source type, sorted by target type
+	struct ReductionEdgeIndex
+	{
+		bool scopeIndependent;				//< true if the source type has no reductions of another scope than the global scope
+		std::vector<ReductionEdge> edges;
+	};
+	/// \brief Reduction in the list of reductions to a type, used to calculate lower bounds of the weight of paths to a type
+	struct ReverseReduction
+	{
+		int fromType;
+		float weight;
+	};
+	/// \brief Buffers of the searches reused by all queries, growing with the biggest search
+	struct SearchWorkspace
+	{
+		std::vector<ReduStackElem> stack;			//< tree of paths searched
+		ReduQueue queue;					//< priority queue of the paths to expand
+		TypeMarkSet startTypes;					//< start types of a search, for eliminating duplicates
+		TypeMarkSet reductionTypes;				//< target types of the reductions from a type, for eliminating duplicates
+		std::vector<ReductionTable::ResultElement> reductions;	//< reductions from a type
+	};
+	typedef std::unordered_map<ReductionIndexKey,ReductionPathIndex,ReductionIndexKeyHash> ReductionPathIndexMap;
+	typedef std::unordered_map<ReductionIndexKey,ReductionEdgeIndex,ReductionIndexKeyHash> ReductionEdgeIndexMap;
+
+	/// \brief Counters and cache sizes of a query state
+	struct QueryStateStatistics
+	{
+		CacheStatistics deriveCache;				//< statistics of the deriveType cache
+		CacheStatistics resolveCache;				//< statistics of the resolveType cache
+		CacheStatistics reductionIndex;				//< statistics of the reduction index
+		QueryStatistics queries;				//< counters of the queries
+		long nodesExpanded;					//< number of paths expanded by the searches
+		long queuePushes;					//< number of paths pushed into the priority queue of the searches
+
+		QueryStateStatistics() noexcept
+			:deriveCache(),resolveCache(),reductionIndex(),queries(),nodesExpanded(0),queuePushes(0){}
+	};
+	/// \brief Caches, indices and buffers modified by the queries, the state of the database used by a query exclusively
+	struct QueryState
+	{
+		DeriveCache deriveCache;				//< cache of deriveType results
+		CacheStatistics deriveCacheStatistics;			//< hit and miss counters of the deriveType cache
+		ResolveCache resolveCache;				//< cache of resolveType results
+		CacheStatistics resolveCacheStatistics;			//< hit and miss counters of the resolveType cache
+		ReductionPathIndexMap reductionPathIndex;		//< index of best paths of reductions of the global scope for deriveType
+		ReductionEdgeIndexMap reductionEdgeIndex;		//< index of single reductions of the global scope for getReduction
+		CacheStatistics reductionIndexStatistics;		//< hit and miss counters of the reduction index
+		std::unordered_map<int,std::vector<float> > deriveLowerBounds;//< map target type to a table of lower bounds of the weight of paths from any type to it
+		bool deriveLowerBoundsDropped;				//< tables of lower bounds used for pruning searches with results in the caches have been dropped
+		SearchWorkspace searchWorkspace;			//< buffers of the searches, reused by all queries using this state
+		QueryStatistics queryStatistics;			//< counters of the queries
+		QueryStateStatistics published;				//< statistics taken when the state was returned to the pool of a frozen database, guarded by the mutex of the pool
+
+		QueryStateStatistics statistics() const noexcept;
+	};
+	/// \brief Query state acquired for the duration of a query, the state of the database if not frozen, a state of the pool else
+	class QueryStateScope
+	{
+	public:
+		explicit QueryStateScope( const TypeDatabase& typedb);
+		~QueryStateScope();
+		QueryStateScope( const QueryStateScope&) = delete;
+
+		QueryState& state() noexcept
+		{
+			return *m_state;
+		}
+
+	private:
+		const TypeDatabase& m_typedb;
+		QueryState* m_state;
+	};
+	template <class FUNC>
+	void foreachQueryStateStatistics( FUNC func) const;
+
+	/// \brief String representation of a type for a separator, element of the list of strings of a type
+	struct TypeString
+	{
+		const char* sep;	//< separator between type elements
+		std::string_view str;	//< string representation of the type
+		TypeString* next;	//< string of the same type with another separator
+	};
+
 	struct TypeRecord
 	{
 		Scope scope;
@@ -509,13 +1007,31 @@ private:
 		short parameterlen;
 		int parameter;
 		int next;
+		int last;	//< last record of the list of types with the same name and context type in the same scope, only maintained in the first record of the list
 		TypeDef inv;
 
 		TypeRecord( const TypeRecord& o)
-			:scope(o.scope),constructor(o.constructor),parameterlen(o.parameterlen),parameter(o.parameter),next(o.next),inv(o.inv){}
+			:scope(o.scope),constructor(o.constructor),parameterlen(o.parameterlen),parameter(o.parameter),next(o.next),last(o.last),inv(o.inv){}
 		TypeRecord( int constructor_, const Scope scope_, int parameter_, short parameterlen_, const TypeDef& inv_)
-			:scope(scope_),constructor(constructor_),parameterlen(parameterlen_),parameter(parameter_),next(0),inv(inv_){}
+			:scope(scope_),constructor(constructor_),parameterlen(parameterlen_),parameter(parameter_),next(0),last(0),inv(inv_){}
+	};
+
+	/// \brief Key of the index of types by the list of types with the same name and context type they belong to and their parameter signature
+	struct SignatureKey
+	{
+		int listHead;			//< first record of the list of types with the same name and context type in the same scope
+		std::size_t signature;		//< hash value of the parameter types
+
+		bool operator == (const SignatureKey& o) const noexcept		{return listHead == o.listHead && signature == o.signature;}
+	};
+	struct SignatureKeyHash
+	{
+		std::size_t operator()( const SignatureKey& key) const noexcept
+		{
+			return (std::size_t)key.listHead * 1000003 ^ key.signature;
+		}
 	};
+	typedef std::unordered_map<SignatureKey,int,SignatureKeyHash> SignatureIndex;
 
 	MemoryBlock m_memblock;				//< memory block used first by m_memory
 	std::unique_ptr<Memory> m_memory;		//< memory resource used by maps (has to be defined before tables and maps as these depend on it!)
@@ -526,6 +1042,25 @@ private:
 	std::unique_ptr<IdentMap> m_identMap;		//< identifier string to integer map
 	std::vector<TypeConstructorPair> m_parameterMap;//< map index to parameter arrays
 	std::vector<TypeRecord> m_typerecMap;		//< type definition structures
+	SignatureIndex m_signatureIndex;		//< index of type definitions by list and parameter signature, the first definition wins on hash collisions
+	std::vector<Scope::Step> m_reduScopeBoundaries;	//< sorted list of start and end steps of all scopes of reductions defined
+	std::vector<NameScopeState> m_nameScopeStates;	//< map identifier to the state of the definitions of types with this name
+	mutable std::vector<bool> m_searchedTypes;	//< types visited by searches since the caches have been cleared, a reduction from one of these invalidates the caches
+	bool m_reductionsFrozen;			//< true if the reduction index is used (freezeReductions called)
+	std::vector<Scope> m_localReductionScopes;	//< scopes of all reductions not defined in the global scope
+	std::vector<bool> m_localReductionSources;	//< source types of all reductions not defined in the global scope
+	mutable std::vector<Scope> m_localReductionCover;//< sorted, disjoint union of m_localReductionScopes
+	mutable bool m_localReductionCoverValid;	//< false if m_localReductionCover has to be rebuilt
+	mutable std::vector<bool> m_indexedTypes;	//< types with reductions used in the reduction index, a reduction from one of these invalidates the index
+	std::vector<std::vector<ReverseReduction> > m_reverseReductions;//< map type to the list of all reductions to it, regardless of scope and tag
+	ReductionAdjacency m_reduAdjacency;		//< compacted adjacency lists of the reductions used by the searches
+	mutable QueryState m_queryState;		//< caches and buffers of the queries, the first state of the pool after freeze
+	bool m_frozen;					//< true if the database is read-only and its queries are thread-safe (freeze called)
+	mutable std::mutex m_queryStateMutex;		//< mutex of the pool of query states of a frozen database
+	mutable std::vector<std::unique_ptr<QueryState> > m_queryStates;//< query states created for concurrent queries of a frozen database
+	mutable std::vector<QueryState*> m_freeQueryStates;//< pool of query states of a frozen database not in use
+	mutable std::vector<TypeString*> m_typeStrings;	//< map type to the list of its string representations rendered, allocated in the memory of identifier strings
+	mutable std::mutex m_typeStringMutex;		//< mutex of the string representations of types of a frozen database
 };
 
 }//namespace
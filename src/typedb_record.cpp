@@ -0,0 +1,782 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Recording of the calls of the type database to a file and replay of a recording against a new type database
+/// \file "typedb_record.cpp"
+#include "typedb_record.hpp"
+#include "fileio.hpp"
+#include "strings.hpp"
+#include "error.hpp"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+using namespace mewa;
+
+static const char g_recordMagic[] = "MEWATDB1";
+enum {RecordMagicSize = sizeof(g_recordMagic)-1};
+
+const char* mewa::typeDbOpName( TypeDbOp op) noexcept
+{
+	switch (op)
+	{
+		case TypeDbOp::SetObjectInstance: return "setObjectInstance";
+		case TypeDbOp::GetObjectInstance: return "getObjectInstance";
+		case TypeDbOp::GetObjectInstanceOfScope: return "getObjectInstanceOfScope";
+		case TypeDbOp::DefineType: return "defineType";
+		case TypeDbOp::DefineTypeAs: return "defineTypeAs";
+		case TypeDbOp::GetType: return "getType";
+		case TypeDbOp::GetTypes: return "getTypes";
+		case TypeDbOp::DefineReduction: return "defineReduction";
+		case TypeDbOp::GetReduction: return "getReduction";
+		case TypeDbOp::GetReductions: return "getReductions";
+		case TypeDbOp::DeriveType: return "deriveType";
+		case TypeDbOp::DeriveTypeTargets: return "deriveTypeTargets";
+		case TypeDbOp::ResolveType: return "resolveType";
+		case TypeDbOp::ResolveTypeList: return "resolveTypeList";
+		case TypeDbOp::ResolveCallable: return "resolveCallable";
+		case TypeDbOp::FreezeReductions: return "freezeReductions";
+		case TypeDbOp::Freeze: return "freeze";
+	}
+	return nullptr;
+}
+
+TypeDatabaseRecorder::TypeDatabaseRecorder( const std::string& filename)
+	:m_filename(filename),m_file(nullptr),m_buffer(),m_names()
+{
+	m_file = std::fopen( filename.c_str(), "wb");
+	if (!m_file) throw Error( (Error::Code)errno, filename);
+	m_buffer.reserve( FlushSize + 1024);
+	m_buffer.append( g_recordMagic, RecordMagicSize);
+}
+
+TypeDatabaseRecorder::~TypeDatabaseRecorder()
+{
+	try
+	{
+		flush();
+	}
+	catch (...) {}
+	std::fclose( m_file);
+}
+
+void TypeDatabaseRecorder::flush()
+{
+	if (m_buffer.empty()) return;
+	errno = 0;
+	if (m_buffer.size() != std::fwrite( m_buffer.data(), 1, m_buffer.size(), m_file) || 0 != std::fflush( m_file))
+	{
+		int ec = errno ? errno : EIO; // ... ferror does not return an error code, fwrite and fflush set errno
+		m_buffer.clear();
+		std::clearerr( m_file);
+		throw Error( (Error::Code)ec, m_filename);
+	}
+	m_buffer.clear();
+}
+
+void TypeDatabaseRecorder::writeOp( TypeDbOp op)
+{
+	if (m_buffer.size() >= FlushSize) flush();
+	m_buffer.push_back( (char)(unsigned char)op);
+}
+
+void TypeDatabaseRecorder::writeUInt( unsigned int value)
+{
+	for (; value >= 0x80; value >>= 7)
+	{
+		m_buffer.push_back( (char)(unsigned char)((value & 0x7f) | 0x80));
+	}
+	m_buffer.push_back( (char)(unsigned char)value);
+}
+
+void TypeDatabaseRecorder::writeInt( int value)
+{
+	writeUInt( ((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+}
+
+void TypeDatabaseRecorder::writeFloat( float value)
+{
+	std::uint32_t bits;
+	std::memcpy( &bits, &value, sizeof bits);
+	for (int bi = 0; bi < 4; ++bi, bits >>= 8)
+	{
+		m_buffer.push_back( (char)(unsigned char)(bits & 0xff));
+	}
+}
+
+void TypeDatabaseRecorder::writeName( const std::string_view& name)
+{
+	auto ins = m_names.insert( {std::string( name), (int)m_names.size()});
+	writeUInt( ins.first->second);
+	if (ins.second)
+	{
+		writeUInt( name.size());
+		m_buffer.append( name.data(), name.size());
+	}
+}
+
+void TypeDatabaseRecorder::writeScope( const Scope& scope)
+{
+	writeInt( scope.start());
+	writeInt( scope.end());
+}
+
+void TypeDatabaseRecorder::writeTypeList( const TypeDatabase::TypeList& types)
+{
+	writeUInt( types.size());
+	for (int ti = 0; ti < types.arsize; ++ti)
+	{
+		writeInt( types[ ti]);
+	}
+}
+
+void TypeDatabaseRecorder::writeTypeConstructorPairList( const TypeDatabase::TypeConstructorPairList& pairs)
+{
+	writeUInt( pairs.size());
+	for (auto const& pair : pairs)
+	{
+		writeInt( pair.type);
+		writeInt( pair.constructor);
+	}
+}
+
+void TypeDatabaseRecorder::writeTagMask( const TagMask& tagmask)
+{
+	writeUInt( tagmask.mask());
+}
+
+void TypeDatabaseRecorder::setObjectInstance( const std::string_view& name, const Scope& scope, int handle)
+{
+	writeOp( TypeDbOp::SetObjectInstance);
+	writeName( name);
+	writeScope( scope);
+	writeInt( handle);
+}
+
+void TypeDatabaseRecorder::getObjectInstance( const std::string_view& name, const Scope::Step step)
+{
+	writeOp( TypeDbOp::GetObjectInstance);
+	writeName( name);
+	writeInt( step);
+}
+
+void TypeDatabaseRecorder::getObjectInstanceOfScope( const std::string_view& name, const Scope& scope)
+{
+	writeOp( TypeDbOp::GetObjectInstanceOfScope);
+	writeName( name);
+	writeScope( scope);
+}
+
+void TypeDatabaseRecorder::defineType( const Scope& scope, int contextType, const std::string_view& name, int constructor, const TypeDatabase::TypeConstructorPairList& parameter)
+{
+	writeOp( TypeDbOp::DefineType);
+	writeScope( scope);
+	writeInt( contextType);
+	writeName( name);
+	writeInt( constructor);
+	writeTypeConstructorPairList( parameter);
+}
+
+void TypeDatabaseRecorder::defineTypeAs( const Scope& scope, int contextType, const std::string_view& name, int type)
+{
+	writeOp( TypeDbOp::DefineTypeAs);
+	writeScope( scope);
+	writeInt( contextType);
+	writeName( name);
+	writeInt( type);
+}
+
+void TypeDatabaseRecorder::getType( const Scope& scope, int contextType, const std::string_view& name, const TypeDatabase::TypeList& parameter)
+{
+	writeOp( TypeDbOp::GetType);
+	writeScope( scope);
+	writeInt( contextType);
+	writeName( name);
+	writeTypeList( parameter);
+}
+
+void TypeDatabaseRecorder::getTypes( const Scope& scope, int contextType, const std::string_view& name)
+{
+	writeOp( TypeDbOp::GetTypes);
+	writeScope( scope);
+	writeInt( contextType);
+	writeName( name);
+}
+
+void TypeDatabaseRecorder::defineReduction( const Scope& scope, int toType, int fromType, int constructor, int tag, float weight)
+{
+	writeOp( TypeDbOp::DefineReduction);
+	writeScope( scope);
+	writeInt( toType);
+	writeInt( fromType);
+	writeInt( constructor);
+	writeInt( tag);
+	writeFloat( weight);
+}
+
+void TypeDatabaseRecorder::getReduction( const Scope::Step step, int toType, int fromType, const TagMask& selectTags)
+{
+	writeOp( TypeDbOp::GetReduction);
+	writeInt( step);
+	writeInt( toType);
+	writeInt( fromType);
+	writeTagMask( selectTags);
+}
+
+void TypeDatabaseRecorder::getReductions( const Scope::Step step, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount)
+{
+	writeOp( TypeDbOp::GetReductions);
+	writeInt( step);
+	writeInt( fromType);
+	writeTagMask( selectTags);
+	writeTagMask( selectTagsCount);
+}
+
+void TypeDatabaseRecorder::deriveType( const Scope::Step step, int toType, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount)
+{
+	writeOp( TypeDbOp::DeriveType);
+	writeInt( step);
+	writeInt( toType);
+	writeInt( fromType);
+	writeTagMask( selectTags);
+	writeTagMask( selectTagsCount);
+	writeInt( maxCount);
+}
+
+void TypeDatabaseRecorder::deriveTypeTargets( const Scope::Step step, const TypeDatabase::TypeList& toTypes, int fromType,
+						const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount)
+{
+	writeOp( TypeDbOp::DeriveTypeTargets);
+	writeInt( step);
+	writeTypeList( toTypes);
+	writeInt( fromType);
+	writeTagMask( selectTags);
+	writeTagMask( selectTagsCount);
+	writeInt( maxCount);
+}
+
+void TypeDatabaseRecorder::resolveType( const Scope::Step step, int contextType, const std::string_view& name, const TagMask& selectTags)
+{
+	writeOp( TypeDbOp::ResolveType);
+	writeInt( step);
+	writeInt( contextType);
+	writeName( name);
+	writeTagMask( selectTags);
+}
+
+void TypeDatabaseRecorder::resolveType( const Scope::Step step, const TypeDatabase::TypeList& contextTypes, const std::string_view& name, const TagMask& selectTags)
+{
+	writeOp( TypeDbOp::ResolveTypeList);
+	writeInt( step);
+	writeTypeList( contextTypes);
+	writeName( name);
+	writeTagMask( selectTags);
+}
+
+void TypeDatabaseRecorder::resolveCallable( const Scope::Step step, const TypeDatabase::TypeList& items, const TypeDatabase::TypeList& argTypes,
+						const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount,
+						TypeDatabase::WeightAccumulation accumulation, float minWeight)
+{
+	writeOp( TypeDbOp::ResolveCallable);
+	writeInt( step);
+	writeTypeList( items);
+	writeTypeList( argTypes);
+	writeTagMask( selectTags);
+	writeTagMask( selectTagsCount);
+	writeInt( maxCount);
+	writeInt( (int)accumulation);
+	writeFloat( minWeight);
+}
+
+void TypeDatabaseRecorder::freezeReductions()
+{
+	writeOp( TypeDbOp::FreezeReductions);
+}
+
+void TypeDatabaseRecorder::freeze()
+{
+	writeOp( TypeDbOp::Freeze);
+}
+
+
+/// \brief Reader of the calls of a recording
+class RecordReader
+{
+public:
+	RecordReader( const std::string& filename, const std::string& content)
+		:m_filename(filename),m_itr(content.data()),m_end(content.data()+content.size()),m_names()
+	{
+		if (content.size() < RecordMagicSize || 0!=std::memcmp( content.data(), g_recordMagic, RecordMagicSize))
+		{
+			throw Error( Error::SerializationError, string_format( "%s: not a recording of type database calls", filename.c_str()));
+		}
+		m_itr += RecordMagicSize;
+	}
+
+	bool eof() const noexcept
+	{
+		return m_itr == m_end;
+	}
+	TypeDbOp readOp()
+	{
+		unsigned char op = readByte();
+		if (op == 0 || op >= NofTypeDbOps) throwCorrupt();
+		return (TypeDbOp)op;
+	}
+	unsigned int readUInt()
+	{
+		unsigned int rt = 0;
+		int shift = 0;
+		unsigned char ch = readByte();
+		for (; (ch & 0x80) != 0; ch = readByte())
+		{
+			rt |= (unsigned int)(ch & 0x7f) << shift;
+			shift += 7;
+			if (shift >= 32) throwCorrupt();
+		}
+		return rt | ((unsigned int)ch << shift);
+	}
+	int readInt()
+	{
+		unsigned int value = readUInt();
+		return (int)(value >> 1) ^ -(int)(value & 1);
+	}
+	float readFloat()
+	{
+		std::uint32_t bits = 0;
+		for (int bi = 0; bi < 4; ++bi)
+		{
+			bits |= (std::uint32_t)readByte() << (bi * 8);
+		}
+		float rt;
+		std::memcpy( &rt, &bits, sizeof rt);
+		return rt;
+	}
+	std::string_view readName()
+	{
+		unsigned int idx = readUInt();
+		if (idx == m_names.size())
+		{
+			unsigned int size = readUInt();
+			if ((std::size_t)(m_end - m_itr) < size) throwCorrupt();
+			m_names.push_back( std::string_view( m_itr, size));
+			m_itr += size;
+		}
+		else if (idx > m_names.size())
+		{
+			throwCorrupt();
+		}
+		return m_names[ idx];
+	}
+	Scope readScope()
+	{
+		Scope::Step start = readInt();
+		Scope::Step end = readInt();
+		return Scope( start, end);
+	}
+	void readTypeList( std::vector<int>& types)
+	{
+		types.clear();
+		unsigned int size = readUInt();
+		for (unsigned int ti = 0; ti < size; ++ti)
+		{
+			types.push_back( readInt());
+		}
+	}
+	void readTypeConstructorPairList( std::vector<TypeDatabase::TypeConstructorPair>& pairs)
+	{
+		pairs.clear();
+		unsigned int size = readUInt();
+		for (unsigned int pi = 0; pi < size; ++pi)
+		{
+			int type = readInt();
+			int constructor = readInt();
+			pairs.emplace_back( type, constructor);
+		}
+	}
+	TagMask readTagMask()
+	{
+		return TagMask( readUInt());
+	}
+
+private:
+	unsigned char readByte()
+	{
+		if (m_itr == m_end) throwCorrupt();
+		return (unsigned char)*m_itr++;
+	}
+	[[noreturn]] void throwCorrupt() const
+	{
+		throw Error( Error::SerializationError, string_format( "%s: corrupt recording of type database calls", m_filename.c_str()));
+	}
+
+private:
+	const std::string& m_filename;
+	char const* m_itr;
+	char const* m_end;
+	std::vector<std::string_view> m_names;
+};
+
+TypeDatabaseReplay::TypeDatabaseReplay( const std::string& filename)
+	:m_filename(filename),m_content(readFile( filename))
+{
+	RecordReader header( m_filename, m_content); // ... check the header of the recording
+}
+
+static void appendTypeList( std::string& out, int const* types, std::size_t size)
+{
+	for (std::size_t ti = 0; ti < size; ++ti)
+	{
+		out.append( string_format( " %d", types[ ti]));
+	}
+}
+
+static void appendReductionTypes( std::string& out, TypeDatabase::TypeConstructorPair const* reductions, std::size_t size)
+{
+	for (std::size_t ri = 0; ri < size; ++ri)
+	{
+		out.append( string_format( " %d", reductions[ ri].type));
+	}
+}
+
+static void appendConflictPath( std::string& out, int const* conflictPath, std::size_t size)
+{
+	if (size)
+	{
+		out.append( " conflict");
+		appendTypeList( out, conflictPath, size);
+	}
+}
+
+static void appendDeriveResult( std::string& out, const TypeDatabase::DeriveResult& result)
+{
+	if (result.defined)
+	{
+		appendReductionTypes( out, result.reductions.data(), result.reductions.size());
+		out.append( string_format( " weight %.3f", result.weightsum));
+		appendConflictPath( out, result.conflictPath.data(), result.conflictPath.size());
+	}
+	else
+	{
+		out.append( " none");
+	}
+}
+
+static void appendDeriveTargetsResult( std::string& out, const TypeDatabase::DeriveTargetsResult& result)
+{
+	for (auto const& target : result.targets)
+	{
+		out.append( " target");
+		if (target.defined)
+		{
+			appendReductionTypes( out, result.reductions.data() + target.reductionsStart, target.reductionsEnd - target.reductionsStart);
+			out.append( string_format( " weight %.3f", target.weightsum));
+			appendConflictPath( out, result.conflictPaths.data() + target.conflictStart, target.conflictEnd - target.conflictStart);
+		}
+		else
+		{
+			out.append( " none");
+		}
+	}
+	if (result.nearest >= 0)
+	{
+		out.append( string_format( " nearest %d", result.nearest));
+	}
+	else
+	{
+		out.append( " nearest none");
+	}
+}
+
+static void appendResolveCallableResult( std::string& out, const TypeDatabase::ResolveCallableResult& result)
+{
+	if (!result.defined())
+	{
+		out.append( " none");
+		return;
+	}
+	out.append( string_format( " weight %.3f", result.weight));
+	for (std::size_t ci = 0; ci < result.items.size(); ++ci)
+	{
+		out.append( string_format( " candidate %d", result.items[ ci]));
+		for (int ai = 0; ai < result.nofArguments; ++ai)
+		{
+			int ri = ci * result.nofArguments + ai;
+			out.append( " argument");
+			appendReductionTypes( out, result.reductions.data() + result.reductionRanges[ ri],
+						result.reductionRanges[ ri+1] - result.reductionRanges[ ri]);
+			appendConflictPath( out, result.conflictPaths.data() + result.conflictRanges[ ri],
+						result.conflictRanges[ ri+1] - result.conflictRanges[ ri]);
+		}
+	}
+}
+
+static void appendObjectInstance( std::string& out, int handle)
+{
+	if (handle >= 0)
+	{
+		out.append( string_format( " %d", handle));
+	}
+	else
+	{
+		out.append( " none");
+	}
+}
+
+static void appendResolveResult( std::string& out, const TypeDatabase::ResolveResult& result)
+{
+	if (result.rootIndex < 0)
+	{
+		out.append( " none");
+	}
+	else if (result.conflictType >= 0)
+	{
+		out.append( string_format( " conflict %d %d", result.contextType, result.conflictType));
+	}
+	else
+	{
+		out.append( string_format( " context %d items", result.contextType));
+		appendTypeList( out, result.items.data(), result.items.size());
+	}
+}
+
+TypeDatabaseReplay::Statistics TypeDatabaseReplay::run( TypeDatabase& typedb, std::string* results) const
+{
+	typedef std::chrono::steady_clock Clock;
+	Statistics rt( NofTypeDbOps);
+	RecordReader reader( m_filename, m_content);
+	std::vector<int> types;
+	std::vector<int> argTypes;
+	std::vector<TypeDatabase::TypeConstructorPair> pairs;
+
+	while (!reader.eof())
+	{
+		TypeDbOp op = reader.readOp();
+		Clock::time_point start; // ... set when the call is executed, after the arguments are read
+		std::string result; // ... result of a query, written to results if requested
+		try
+		{
+			switch (op)
+			{
+				case TypeDbOp::SetObjectInstance:
+				{
+					std::string_view name = reader.readName();
+					Scope scope = reader.readScope();
+					int handle = reader.readInt();
+					start = Clock::now();
+					typedb.setObjectInstance( name, scope, handle);
+					break;
+				}
+				case TypeDbOp::GetObjectInstance:
+				{
+					std::string_view name = reader.readName();
+					Scope::Step step = reader.readInt();
+					start = Clock::now();
+					int handle = typedb.getObjectInstance( name, step);
+					if (results) appendObjectInstance( result, handle);
+					break;
+				}
+				case TypeDbOp::GetObjectInstanceOfScope:
+				{
+					std::string_view name = reader.readName();
+					Scope scope = reader.readScope();
+					start = Clock::now();
+					int handle = typedb.getObjectInstanceOfScope( name, scope);
+					if (results) appendObjectInstance( result, handle);
+					break;
+				}
+				case TypeDbOp::DefineType:
+				{
+					Scope scope = reader.readScope();
+					int contextType = reader.readInt();
+					std::string_view name = reader.readName();
+					int constructor = reader.readInt();
+					reader.readTypeConstructorPairList( pairs);
+					start = Clock::now();
+					int type = typedb.defineType( scope, contextType, name, constructor, pairs);
+					if (results) result = string_format( " %d", type);
+					break;
+				}
+				case TypeDbOp::DefineTypeAs:
+				{
+					Scope scope = reader.readScope();
+					int contextType = reader.readInt();
+					std::string_view name = reader.readName();
+					int type = reader.readInt();
+					start = Clock::now();
+					int rtype = typedb.defineTypeAs( scope, contextType, name, type);
+					if (results) result = string_format( " %d", rtype);
+					break;
+				}
+				case TypeDbOp::GetType:
+				{
+					Scope scope = reader.readScope();
+					int contextType = reader.readInt();
+					std::string_view name = reader.readName();
+					reader.readTypeList( types);
+					start = Clock::now();
+					int type = typedb.getType( scope, contextType, name, types);
+					if (results) result = string_format( " %d", type);
+					break;
+				}
+				case TypeDbOp::GetTypes:
+				{
+					Scope scope = reader.readScope();
+					int contextType = reader.readInt();
+					std::string_view name = reader.readName();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto typesres = typedb.getTypes( scope, contextType, name, resbuf);
+					if (results) appendTypeList( result, typesres.types.data(), typesres.types.size());
+					break;
+				}
+				case TypeDbOp::DefineReduction:
+				{
+					Scope scope = reader.readScope();
+					int toType = reader.readInt();
+					int fromType = reader.readInt();
+					int constructor = reader.readInt();
+					int tag = reader.readInt();
+					float weight = reader.readFloat();
+					start = Clock::now();
+					typedb.defineReduction( scope, toType, fromType, constructor, tag, weight);
+					break;
+				}
+				case TypeDbOp::GetReduction:
+				{
+					Scope::Step step = reader.readInt();
+					int toType = reader.readInt();
+					int fromType = reader.readInt();
+					TagMask selectTags = reader.readTagMask();
+					start = Clock::now();
+					auto redu = typedb.getReduction( step, toType, fromType, selectTags);
+					if (results) result = redu.defined() ? string_format( " weight %.3f", redu.weight) : std::string(" none");
+					break;
+				}
+				case TypeDbOp::GetReductions:
+				{
+					Scope::Step step = reader.readInt();
+					int fromType = reader.readInt();
+					TagMask selectTags = reader.readTagMask();
+					TagMask selectTagsCount = reader.readTagMask();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto redus = typedb.getReductions( step, fromType, selectTags, selectTagsCount, resbuf);
+					if (results)
+					{
+						for (auto const& redu : redus.reductions)
+						{
+							result.append( string_format( " %d weight %.3f%s", redu.type, redu.weight, redu.count ? " count" : ""));
+						}
+					}
+					break;
+				}
+				case TypeDbOp::DeriveType:
+				{
+					Scope::Step step = reader.readInt();
+					int toType = reader.readInt();
+					int fromType = reader.readInt();
+					TagMask selectTags = reader.readTagMask();
+					TagMask selectTagsCount = reader.readTagMask();
+					int maxCount = reader.readInt();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto deriveres = typedb.deriveType( step, toType, fromType, selectTags, selectTagsCount, maxCount, resbuf);
+					if (results) appendDeriveResult( result, deriveres);
+					break;
+				}
+				case TypeDbOp::DeriveTypeTargets:
+				{
+					Scope::Step step = reader.readInt();
+					reader.readTypeList( types);
+					int fromType = reader.readInt();
+					TagMask selectTags = reader.readTagMask();
+					TagMask selectTagsCount = reader.readTagMask();
+					int maxCount = reader.readInt();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto deriveres = typedb.deriveTypeTargets( step, types, fromType, selectTags, selectTagsCount, maxCount, resbuf);
+					if (results) appendDeriveTargetsResult( result, deriveres);
+					break;
+				}
+				case TypeDbOp::ResolveType:
+				{
+					Scope::Step step = reader.readInt();
+					int contextType = reader.readInt();
+					std::string_view name = reader.readName();
+					TagMask selectTags = reader.readTagMask();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto resolveres = typedb.resolveType( step, contextType, name, selectTags, resbuf);
+					if (results) appendResolveResult( result, resolveres);
+					break;
+				}
+				case TypeDbOp::ResolveTypeList:
+				{
+					Scope::Step step = reader.readInt();
+					reader.readTypeList( types);
+					std::string_view name = reader.readName();
+					TagMask selectTags = reader.readTagMask();
+					TypeDatabase::ResultBuffer resbuf;
+					std::pmr::vector<int> contextTypes( types.begin(), types.end(), &resbuf.memrsc);
+					start = Clock::now();
+					auto resolveres = typedb.resolveType( step, contextTypes, name, selectTags, resbuf);
+					if (results) appendResolveResult( result, resolveres);
+					break;
+				}
+				case TypeDbOp::ResolveCallable:
+				{
+					Scope::Step step = reader.readInt();
+					reader.readTypeList( types);
+					reader.readTypeList( argTypes);
+					TagMask selectTags = reader.readTagMask();
+					TagMask selectTagsCount = reader.readTagMask();
+					int maxCount = reader.readInt();
+					auto accumulation = (TypeDatabase::WeightAccumulation)reader.readInt();
+					float minWeight = reader.readFloat();
+					TypeDatabase::ResultBuffer resbuf;
+					start = Clock::now();
+					auto callres = typedb.resolveCallable( step, types, argTypes, selectTags, selectTagsCount, maxCount, accumulation, minWeight, resbuf);
+					if (results) appendResolveCallableResult( result, callres);
+					break;
+				}
+				case TypeDbOp::FreezeReductions:
+				{
+					start = Clock::now();
+					typedb.freezeReductions();
+					break;
+				}
+				case TypeDbOp::Freeze:
+				{
+					start = Clock::now();
+					typedb.freeze();
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			if (start == Clock::time_point()) throw; // ... error reading the arguments
+			++rt[ (int)op].errors;
+			result = " error";
+		}
+		if (results)
+		{
+			results->append( typeDbOpName( op));
+			results->append( result);
+			results->push_back( '\n');
+		}
+		OpStatistics& stats = rt[ (int)op];
+		++stats.count;
+		stats.seconds += std::chrono::duration<double>( Clock::now() - start).count();
+	}
+	return rt;
+}
+
@@ -0,0 +1,154 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Recording of the calls of the type database to a file and replay of a recording against a new type database
+/// \file "typedb_record.hpp"
+#ifndef _MEWA_TYPEDB_RECORD_HPP_INCLUDED
+#define _MEWA_TYPEDB_RECORD_HPP_INCLUDED
+#if __cplusplus >= 201703L
+#include "typedb.hpp"
+#include "scope.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+
+namespace mewa {
+
+/// \brief Identifiers of the calls of the type database recorded
+enum class TypeDbOp :unsigned char
+{
+	SetObjectInstance=1,
+	GetObjectInstance=2,
+	GetObjectInstanceOfScope=3,
+	DefineType=4,
+	DefineTypeAs=5,
+	GetType=6,
+	GetTypes=7,
+	DefineReduction=8,
+	GetReduction=9,
+	GetReductions=10,
+	DeriveType=11,
+	DeriveTypeTargets=12,
+	ResolveType=13,
+	ResolveTypeList=14,
+	ResolveCallable=15,
+	FreezeReductions=16,
+	Freeze=17
+};
+enum {NofTypeDbOps = 18};
+
+/// \brief Get the name of a recorded call of the type database
+const char* typeDbOpName( TypeDbOp op) noexcept;
+
+/// \brief Writer of a recording of the calls of a type database with their arguments to a file
+/// \note	The recording starts with the magic "MEWATDB1" followed by the calls. A call is its operation identifier (TypeDbOp)
+///	followed by its arguments. Integers are written as variable length (LEB128) zigzag encoded numbers, floats as 4 bytes little endian.
+///	Names are written as index of the name in the order of their first appearance, followed by its length and characters on first appearance.
+///	The scope of definitions and the scope-step of queries are part of the arguments.
+class TypeDatabaseRecorder
+{
+public:
+	/// \brief Constructor, creates the file and writes the header of the recording
+	/// \param[in] filename path of the file to write
+	explicit TypeDatabaseRecorder( const std::string& filename);
+	TypeDatabaseRecorder( const TypeDatabaseRecorder&) = delete;
+	~TypeDatabaseRecorder();
+
+	void setObjectInstance( const std::string_view& name, const Scope& scope, int handle);
+	void getObjectInstance( const std::string_view& name, const Scope::Step step);
+	void getObjectInstanceOfScope( const std::string_view& name, const Scope& scope);
+	void defineType( const Scope& scope, int contextType, const std::string_view& name, int constructor, const TypeDatabase::TypeConstructorPairList& parameter);
+	void defineTypeAs( const Scope& scope, int contextType, const std::string_view& name, int type);
+	void getType( const Scope& scope, int contextType, const std::string_view& name, const TypeDatabase::TypeList& parameter);
+	void getTypes( const Scope& scope, int contextType, const std::string_view& name);
+	void defineReduction( const Scope& scope, int toType, int fromType, int constructor, int tag, float weight);
+	void getReduction( const Scope::Step step, int toType, int fromType, const TagMask& selectTags);
+	void getReductions( const Scope::Step step, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount);
+	void deriveType( const Scope::Step step, int toType, int fromType, const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount);
+	void deriveTypeTargets( const Scope::Step step, const TypeDatabase::TypeList& toTypes, int fromType,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount);
+	void resolveType( const Scope::Step step, int contextType, const std::string_view& name, const TagMask& selectTags);
+	void resolveType( const Scope::Step step, const TypeDatabase::TypeList& contextTypes, const std::string_view& name, const TagMask& selectTags);
+	void resolveCallable( const Scope::Step step, const TypeDatabase::TypeList& items, const TypeDatabase::TypeList& argTypes,
+				const TagMask& selectTags, const TagMask& selectTagsCount, int maxCount,
+				TypeDatabase::WeightAccumulation accumulation, float minWeight);
+	void freezeReductions();
+	void freeze();
+
+	/// \brief Write the calls buffered to the file
+	void flush();
+
+private:
+	void writeOp( TypeDbOp op);
+	void writeUInt( unsigned int value);
+	void writeInt( int value);
+	void writeFloat( float value);
+	void writeName( const std::string_view& name);
+	void writeScope( const Scope& scope);
+	void writeTypeList( const TypeDatabase::TypeList& types);
+	void writeTypeConstructorPairList( const TypeDatabase::TypeConstructorPairList& pairs);
+	void writeTagMask( const TagMask& tagmask);
+
+private:
+	enum {FlushSize=1<<16};
+
+	std::string m_filename;					//< path of the file written
+	FILE* m_file;						//< file written
+	std::string m_buffer;					//< calls not written yet
+	std::unordered_map<std::string,int> m_names;		//< map of names written to their index
+};
+
+/// \brief Replay of a recording of a TypeDatabaseRecorder against a type database
+class TypeDatabaseReplay
+{
+public:
+	/// \brief Counters of the calls of one operation replayed
+	struct OpStatistics
+	{
+		long count;		///< number of calls
+		long errors;		///< number of calls that threw an exception
+		double seconds;		///< sum of the time spent in the calls in seconds
+
+		OpStatistics() noexcept
+			:count(0),errors(0),seconds(0.0){}
+	};
+	typedef std::vector<OpStatistics> Statistics;	///< statistics indexed by operation identifier (TypeDbOp)
+
+public:
+	/// \brief Constructor, reads the recording
+	/// \param[in] filename path of the file with the recording
+	explicit TypeDatabaseReplay( const std::string& filename);
+
+	/// \brief Execute the calls recorded against a type database
+	/// \note Exceptions thrown by the type database are counted as errors of the operation, the replay continues with the next call
+	/// \param[in,out] typedb the type database, new for a faithful replay of the recording
+	/// \param[out] results if not null, one line is appended for each call with the name of the operation followed by its result (types, weights, conflicts, contexts, candidates and object handles of queries)
+	/// \return the number of calls, errors and time spent for each operation
+	Statistics run( TypeDatabase& typedb, std::string* results = nullptr) const;
+
+	/// \brief Get the size of the recording in bytes
+	std::size_t size() const noexcept
+	{
+		return m_content.size();
+	}
+
+private:
+	std::string m_filename;				//< path of the file with the recording
+	std::string m_content;				//< recording
+};
+
+}//namespace
+
+#else
+#error Building mewa requires C++17
+#endif
+#endif
+
@@ -0,0 +1,295 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+ 
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Structures used by the shortest path searches of the type database
+/// \file "typedb_search.hpp"
+#ifndef _MEWA_TYPEDB_SEARCH_HPP_INCLUDED
+#define _MEWA_TYPEDB_SEARCH_HPP_INCLUDED
+#if __cplusplus >= 201703L
+#include "scope.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace mewa {
+
+/// \brief Element of the stack of a search, a node of the tree of paths linked to its predecessor
+struct ReduStackElem
+{
+	int type;
+	int constructor;
+	int prev;
+	int pathlen;
+
+	ReduStackElem( const ReduStackElem& o) noexcept
+		:type(o.type),constructor(o.constructor),prev(o.prev),pathlen(o.pathlen){}
+	ReduStackElem( int type_, int constructor_, int prev_, int pathlen_) noexcept
+		:type(type_),constructor(constructor_),prev(prev_),pathlen(pathlen_){}
+	ReduStackElem& operator=( const ReduStackElem& o) noexcept = default;
+};
+
+/// \brief Element of the priority queue of a search, the weight of a path and the index of its last node on the stack
+struct ReduQueueElem
+{
+	float weight;
+	int index;
+
+	ReduQueueElem() noexcept
+		:weight(0.0),index(-1){}
+	ReduQueueElem( float weight_, int index_) noexcept
+		:weight(weight_),index(index_){}
+	ReduQueueElem( const ReduQueueElem& o) noexcept
+		:weight(o.weight),index(o.index){}
+
+	bool operator < (const ReduQueueElem& o) const noexcept
+	{
+		return weight == o.weight ? index < o.index : weight < o.weight;
+	}
+	bool operator > (const ReduQueueElem& o) const noexcept
+	{
+		return weight == o.weight ? index > o.index : weight > o.weight;
+	}
+};
+
+/// \brief Monotone priority queue of a search popping the elements in ascending order of (weight,index)
+/// \note Implemented as radix heap: The elements are put into buckets by the highest bit differing from the last element popped,
+///	only the elements of the lowest non empty bucket are redistributed when the bucket of the last element popped gets empty.
+///	The bit patterns of non negative floats have the same order as their values. The element pushed must not be smaller than
+///	the last element popped, this is true for a search with non negative weights, where every element pushed has a bigger index.
+class ReduQueue
+{
+public:
+	ReduQueue()
+		:m_last(0),m_size(0),m_nofPushes(0),m_nofPops(0){}
+
+	void clear() noexcept
+	{
+		for (auto& bucket : m_buckets) bucket.clear();
+		m_last = 0;
+		m_size = 0;
+	}
+	bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+	void push( const ReduQueueElem& elem)
+	{
+		std::uint64_t key = keyFromElem( elem);
+		m_buckets[ bucketIndex( key)].push_back( key);
+		++m_size;
+		++m_nofPushes;
+	}
+	ReduQueueElem pop()
+	{
+		if (m_buckets[ 0].empty())
+		{
+			int bi = 1;
+			for (; m_buckets[ bi].empty(); ++bi){}
+			std::vector<std::uint64_t>& bucket = m_buckets[ bi];
+			m_last = *std::min_element( bucket.begin(), bucket.end());
+			for (auto key : bucket)
+			{
+				m_buckets[ bucketIndex( key)].push_back( key);
+			}
+			bucket.clear();
+		}
+		// ... the keys are unique, the bucket 0 contains the last element popped only
+		std::uint64_t key = m_buckets[ 0].back();
+		m_buckets[ 0].pop_back();
+		--m_size;
+		++m_nofPops;
+		return elemFromKey( key);
+	}
+
+	/// \brief Get the number of elements pushed since the creation of the queue, not reset by clear
+	long nofPushes() const noexcept
+	{
+		return m_nofPushes;
+	}
+	/// \brief Get the number of elements popped since the creation of the queue, not reset by clear
+	long nofPops() const noexcept
+	{
+		return m_nofPops;
+	}
+
+private:
+	static std::uint64_t keyFromElem( const ReduQueueElem& elem) noexcept
+	{
+		std::uint32_t weightbits;
+		float weight = elem.weight + 0.0f; // ... -0.0 to 0.0
+		std::memcpy( &weightbits, &weight, sizeof weightbits);
+		return ((std::uint64_t)weightbits << 32) | (std::uint32_t)elem.index;
+	}
+	static ReduQueueElem elemFromKey( std::uint64_t key) noexcept
+	{
+		std::uint32_t weightbits = key >> 32;
+		float weight;
+		std::memcpy( &weight, &weightbits, sizeof weight);
+		return ReduQueueElem( weight, (int)(std::uint32_t)key);
+	}
+	int bucketIndex( std::uint64_t key) const noexcept
+	{
+		std::uint64_t diff = key ^ m_last;
+#if defined(__GNUC__)
+		return diff ? 64 - __builtin_clzll( diff) : 0;
+#else
+		int rt = 0;
+		for (; diff; diff >>= 1, ++rt){}
+		return rt;
+#endif
+	}
+
+private:
+	std::vector<std::uint64_t> m_buckets[ 65];	//< bucket [i] contains the keys with the highest bit differing from m_last at position i-1
+	std::uint64_t m_last;				//< key of the last element popped
+	std::size_t m_size;				//< number of elements in the queue
+	long m_nofPushes;				//< number of elements pushed since the creation of the queue
+	long m_nofPops;					//< number of elements popped since the creation of the queue
+};
+
+/// \brief Set of type handles implemented as array of generation stamps, cleared by incrementing the generation
+class TypeMarkSet
+{
+public:
+	TypeMarkSet()
+		:m_stamps(),m_generation(1){}
+
+	void clear()
+	{
+		if (++m_generation == 0)
+		{
+			std::fill( m_stamps.begin(), m_stamps.end(), 0);
+			m_generation = 1;
+		}
+	}
+	/// \brief Insert a type
+	/// \return true if the type has not been in the set before
+	bool insert( int type)
+	{
+		if (type >= (int)m_stamps.size())
+		{
+			m_stamps.resize( std::max( (std::size_t)type+1, m_stamps.size() * 2), 0);
+		}
+		if (m_stamps[ type] == m_generation) return false;
+		m_stamps[ type] = m_generation;
+		return true;
+	}
+
+private:
+	std::vector<unsigned int> m_stamps;		//< generation of the last insert of a type
+	unsigned int m_generation;			//< current generation, a type is in the set if its stamp is equal to it
+};
+
+/// \brief Compacted adjacency lists of the reductions (CSR layout), the reductions from a type stored contiguously with their scope and tag inline
+/// \note	The reductions of a type are ordered by scope, inner scopes first, reductions of the same scope in the order of their definition.
+///	This is the order the reductions are visited by ScopedRelationMap::get, the first reduction visited to a type wins against duplicates.
+///	Reductions defined after the last compaction are kept in a list of pending reductions. Types with pending reductions are marked
+///	as not compacted and have to be looked up in the reduction table. The list is merged when its size exceeds a fraction of the compacted list.
+class ReductionAdjacency
+{
+public:
+	ReductionAdjacency()
+		:m_nodes(),m_edges(),m_pending(){}
+
+	/// \brief Add a reduction
+	void add( const Scope& scope, int fromType, int toType, int constructor, std::uint8_t tagval, float weight)
+	{
+		if (fromType >= (int)m_nodes.size())
+		{
+			m_nodes.resize( std::max( (std::size_t)fromType+1, m_nodes.size() * 2));
+		}
+		m_nodes[ fromType].compacted = false;
+		m_pending.push_back( PendingEdge( fromType, Edge( scope, toType, constructor, tagval, weight)));
+		if (m_pending.size() >= std::max( (std::size_t)MinCompactSize, m_edges.size() / 2))
+		{
+			compact();
+		}
+	}
+
+	/// \brief Merge the pending reductions into the compacted lists
+	void compact();
+
+	/// \brief Get the number of reductions stored
+	std::size_t size() const noexcept
+	{
+		return m_edges.size() + m_pending.size();
+	}
+
+	/// \brief Get the reductions from a type visible in a scope-step like ScopedRelationMap::get
+	/// \param[out] result where to append the reductions to
+	/// \param[in,out] visited set of the types reached used to eliminate duplicates, cleared by the caller
+	/// \return false if the reductions of the type are not compacted and have to be retrieved from the reduction table
+	template <class RESULTLIST, class VISITEDSET>
+	bool get( const Scope::Step step, int fromType, const TagMask& selectTags, RESULTLIST& result, VISITEDSET& visited) const
+	{
+		if (fromType >= (int)m_nodes.size()) return true;
+		const Node& node = m_nodes[ fromType];
+		if (!node.compacted) return false;
+		if ((node.tagmask & selectTags.mask()) == 0) return true;
+
+		Edge const* ei = m_edges.data() + node.start;
+		Edge const* ee = ei + node.size;
+		for (; ei != ee; ++ei)
+		{
+			if (ei->scopeStart <= step && step < ei->scopeEnd && selectTags.matches( ei->tagval) && visited.insert( ei->toType))
+			{
+				result.emplace_back( ei->toType, ei->constructor, ei->weight, ei->tagval);
+			}
+		}
+		return true;
+	}
+
+private:
+	enum {MinCompactSize=256};
+
+	struct Edge
+	{
+		Scope::Step scopeStart;
+		Scope::Step scopeEnd;
+		int toType;
+		int constructor;
+		float weight;
+		std::uint8_t tagval;
+
+		Edge( const Scope& scope, int toType_, int constructor_, std::uint8_t tagval_, float weight_) noexcept
+			:scopeStart(scope.start()),scopeEnd(scope.end()),toType(toType_),constructor(constructor_),weight(weight_),tagval(tagval_){}
+	};
+	struct PendingEdge
+	{
+		int fromType;
+		Edge edge;
+
+		PendingEdge( int fromType_, const Edge& edge_) noexcept
+			:fromType(fromType_),edge(edge_){}
+	};
+	struct Node
+	{
+		int start;			//< index of the first reduction in m_edges
+		int size;			//< number of reductions
+		TagMask::BitSet tagmask;	//< union of the tags of the reductions
+		bool compacted;			//< false, if there are pending reductions from this type
+
+		Node() noexcept
+			:start(0),size(0),tagmask(0),compacted(true){}
+	};
+
+private:
+	std::vector<Node> m_nodes;		//< map type to its range of reductions in m_edges
+	std::vector<Edge> m_edges;		//< compacted reductions, grouped by the type they are from
+	std::vector<PendingEdge> m_pending;	//< reductions added since the last compaction in the order of definition
+};
+
+}//namespace
+
+#else
+#error Building mewa requires C++17
+#endif
+#endif
+
@@ -0,0 +1,153 @@
+/*
+  Copyright (c) 2020 Patrick P. Frey
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/// \brief Benchmark program replaying a recording of type database calls (mewa.typedb with record file) against a new type database
+/// \file "benchTypeDbReplay.cpp"
+
+#if __cplusplus < 201703L
+#error Building mewa requires at least C++17
+#endif
+#include "typedb.hpp"
+#include "typedb_record.hpp"
+#include "error.hpp"
+#include "strings.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+
+using namespace mewa;
+
+static const char* g_usage = "Usage: benchTypeDbReplay [-h][-V][-R][-n NOFRUNS] RECORDFILE";
+
+static void printStatistics( std::ostream& out, const TypeDatabaseReplay::Statistics& stats)
+{
+	out << string_format( "%-26s %10s %8s %12s %10s", "call", "count", "errors", "total [ms]", "avg [us]") << std::endl;
+	for (int oi = 1; oi < NofTypeDbOps; ++oi)
+	{
+		const TypeDatabaseReplay::OpStatistics& st = stats[ oi];
+		if (!st.count) continue;
+		out << string_format( "%-26s %10ld %8ld %12.3f %10.3f",
+					typeDbOpName( (TypeDbOp)oi), st.count, st.errors,
+					st.seconds * 1000.0, st.seconds * 1000000.0 / st.count) << std::endl;
+	}
+}
+
+static double totalSeconds( const TypeDatabaseReplay::Statistics& stats)
+{
+	double rt = 0.0;
+	for (auto const& st : stats) rt += st.seconds;
+	return rt;
+}
+
+int main( int argc, const char* argv[] )
+{
+	try
+	{
+		int nofRuns = 1;
+		bool verbose = false;
+		bool printResults = false;
+		int argi = 1;
+		for (; argi < argc; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "-V"))
+			{
+				verbose = true;
+			}
+			else if (0==std::strcmp( argv[argi], "-R"))
+			{
+				printResults = true;
+			}
+			else if (0==std::strcmp( argv[argi], "-n"))
+			{
+				++argi;
+				if (argi == argc || argv[argi][0] < '1' || argv[argi][0] > '9')
+				{
+					std::cerr << g_usage << std::endl;
+					throw std::runtime_error( "Option -n expects argument positive integer (number of runs)");
+				}
+				nofRuns = atoi( argv[argi]);
+			}
+			else if (0==std::strcmp( argv[argi], "-h"))
+			{
+				std::cerr << g_usage << std::endl;
+				return 0;
+			}
+			else if (0==std::strcmp( argv[argi], "--"))
+			{
+				++argi;
+				break;
+			}
+			else if (argv[argi][0] == '-')
+			{
+				std::cerr << g_usage << std::endl;
+				throw std::runtime_error( string_format( "unknown option '%s'", argv[argi]));
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (argi + 1 != argc)
+		{
+			std::cerr << g_usage << std::endl;
+			throw std::runtime_error( "exactly one argument (file with the recording) expected");
+		}
+		TypeDatabaseReplay replay( argv[ argi]);
+		if (printResults)
+		{
+			// ... print the results of the calls of one run instead of the statistics, for comparing them with the results of the recording
+			std::unique_ptr<TypeDatabase> typedb( new TypeDatabase());
+			std::string results;
+			replay.run( *typedb, &results);
+			std::cout << results << std::flush;
+			return 0;
+		}
+		TypeDatabaseReplay::Statistics best;
+		double bestSeconds = 0.0;
+		for (int ri = 0; ri < nofRuns; ++ri)
+		{
+			std::unique_ptr<TypeDatabase> typedb( new TypeDatabase());
+			TypeDatabaseReplay::Statistics stats = replay.run( *typedb);
+			double seconds = totalSeconds( stats);
+			if (verbose)
+			{
+				std::cerr << string_format( "Run [%d] %.3f ms", ri+1, seconds * 1000.0) << std::endl;
+			}
+			if (ri == 0 || seconds < bestSeconds)
+			{
+				best = stats;
+				bestSeconds = seconds;
+			}
+		}
+		std::cout << string_format( "Replay of %s (%ld bytes), best of %d runs: %.3f ms", argv[ argi], (long)replay.size(), nofRuns, bestSeconds * 1000.0) << std::endl;
+		printStatistics( std::cout, best);
+		return 0;
+	}
+	catch (const mewa::Error& err)
+	{
+		std::cerr << "ERR " << err.what() << std::endl;
+		return (int)err.code();
+	}
+	catch (const std::runtime_error& err)
+	{
+		std::cerr << "ERR RUNTIME " << err.what() << std::endl;
+		return 1;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERR out of memory" << std::endl;
+		return 2;
+	}
+	return 0;
+}
+
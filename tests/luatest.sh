@@ -60,6 +60,108 @@ if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xTYPEDB" ] ; then
 $LUABIN tests/typedb.lua
 fi
 
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xRECORD" ] ; then
+# Record a sequence of type database calls writing the results in the format of benchTypeDbReplay -R and compare them with the results of the replay:
+cat > build/typedb_record.lua <<EOR
+mewa = require("mewa")
+local out = assert( io.open( "build/typedb_record.exp", "w"))
+local function typeList( types) local rt = "" for _,tp in ipairs( types) do rt = rt .. " " .. tp end return rt end
+local function deriveResult( redulist, weight, conflict)
+	if not redulist then return " none" end
+	local rt = "" for _,redu in ipairs( redulist) do rt = rt .. " " .. redu.type end
+	return rt .. string.format( " weight %.3f", weight) .. (conflict and (" conflict" .. typeList( conflict)) or "")
+end
+local function deriveTargetsResult( results, nearest)
+	local rt = ""
+	for _,res in ipairs( results) do rt = rt .. " target" .. (res and deriveResult( res, res.weight, res.conflict) or " none") end
+	return rt .. " nearest " .. (nearest and (nearest-1) or "none")
+end
+local function reductionResult( weight)
+	return weight and string.format( " weight %.3f", weight) or " none"
+end
+local function reductionsResult( reductions)
+	local rt = ""
+	for _,redu in ipairs( reductions) do rt = rt .. string.format( " %d weight %.3f", redu.type, redu.weight) .. (redu.count and " count" or "") end
+	return rt
+end
+local function callableResult( weight, candidates)
+	if not weight then return " none" end
+	local rt = string.format( " weight %.3f", weight)
+	for _,candidate in ipairs( candidates) do
+		rt = rt .. " candidate " .. candidate.type
+		for ai,redulist in ipairs( candidate.reductions) do
+			rt = rt .. " argument"
+			for _,redu in ipairs( redulist) do rt = rt .. " " .. redu.type end
+			if candidate.conflicts and candidate.conflicts[ ai] then rt = rt .. " conflict" .. typeList( candidate.conflicts[ ai]) end
+		end
+	end
+	return rt
+end
+local function instanceResult( obj)
+	if not obj then return " none" end
+	for handle,value in pairs( debug.getregistry()) do
+		if rawequal( value, obj) and math.type( handle) == "integer" then return " " .. handle end
+	end
+end
+local function resolveResult( ctx, _, items)
+	if not ctx then return " none" end
+	return " context " .. ctx .. " items" .. typeList( items)
+end
+local typedb = mewa.typedb( "build/typedb_record.rec")
+local mask = typedb.reduction_tagmask( 1)
+local int = typedb:def_type( 0, "int") out:write( "defineType " .. int .. "\n")
+local long = typedb:def_type( 0, "long") out:write( "defineType " .. long .. "\n")
+local float = typedb:def_type( 0, "float") out:write( "defineType " .. float .. "\n")
+local class = typedb:def_type( 0, "class") out:write( "defineType " .. class .. "\n")
+local method = typedb:def_type( class, "method", "m", {int, float}) out:write( "defineType " .. method .. "\n")
+typedb:def_reduction( long, int, "long(int)", 1, 0.5) out:write( "defineReduction\n")
+typedb:def_reduction( float, long, "float(long)", 1, 0.75) out:write( "defineReduction\n")
+local ok = pcall( typedb.def_reduction, typedb, int, float, "int(float)", 1, -1.0) out:write( "defineReduction" .. (ok and "" or " error") .. "\n")
+out:write( "deriveType" .. deriveResult( typedb:derive_type( float, int, mask, nil, 2)) .. "\n")
+out:write( "deriveType" .. deriveResult( typedb:derive_type( int, float, mask)) .. "\n")
+out:write( "resolveType" .. resolveResult( typedb:resolve_type( class, "method")) .. "\n")
+out:write( "getType " .. typedb:get_type( class, "method", {int, float}) .. "\n")
+local short = typedb:def_type( 0, "short") out:write( "defineType " .. short .. "\n")
+typedb:def_reduction( long, short, "long(short)", 1, 0.25) out:write( "defineReduction\n")
+typedb:def_reduction( float, short, "float(short)", 1, 1.0) out:write( "defineReduction\n")
+out:write( "deriveType" .. deriveResult( typedb:derive_type( float, short, mask, nil, 2)) .. "\n")
+out:write( "getReduction" .. reductionResult( typedb:get_reduction( long, int, mask)) .. "\n")
+out:write( "getReduction" .. reductionResult( typedb:get_reduction( int, float, mask)) .. "\n")
+out:write( "getReductions" .. reductionsResult( typedb:get_reductions( short, mask, mask)) .. "\n")
+out:write( "deriveTypeTargets" .. deriveTargetsResult( typedb:derive_type( {float, class, long}, short, mask, nil, 2)) .. "\n")
+out:write( "deriveTypeTargets" .. deriveTargetsResult( typedb:derive_type( {class}, short, mask, nil, 2)) .. "\n")
+out:write( "resolveCallable" .. callableResult( typedb:resolve_callable( {method}, {int, long}, mask, nil, 2)) .. "\n")
+out:write( "resolveCallable" .. callableResult( typedb:resolve_callable( {method}, {int, short}, mask, nil, 2)) .. "\n")
+out:write( "resolveCallable" .. callableResult( typedb:resolve_callable( {method}, {float, int}, mask, nil, 2)) .. "\n")
+local globalObj = {"global"}
+typedb:set_instance( "obj", globalObj) out:write( "setObjectInstance\n")
+out:write( "getObjectInstance" .. instanceResult( typedb:get_instance( "obj")) .. "\n")
+out:write( "getObjectInstanceOfScope" .. instanceResult( typedb:this_instance( "obj")) .. "\n")
+out:write( "getObjectInstance" .. instanceResult( typedb:get_instance( "undefined")) .. "\n")
+typedb:scope( {10,20})
+local inner = typedb:def_type( class, "method", "m2", {long}) out:write( "defineType " .. inner .. "\n")
+typedb:def_reduction( int, long, "int(long)", 1, 0.25) out:write( "defineReduction\n")
+local innerObj = {"inner"}
+typedb:set_instance( "obj", innerObj) out:write( "setObjectInstance\n")
+out:write( "getObjectInstanceOfScope" .. instanceResult( typedb:this_instance( "obj")) .. "\n")
+out:write( "getTypes" .. typeList( typedb:get_types( class, "method")) .. "\n")
+typedb:step( 15)
+out:write( "deriveType" .. deriveResult( typedb:derive_type( int, long, mask)) .. "\n")
+out:write( "resolveTypeList" .. resolveResult( typedb:resolve_type( {class}, "method")) .. "\n")
+out:write( "getObjectInstance" .. instanceResult( typedb:get_instance( "obj")) .. "\n")
+typedb:step( 25)
+out:write( "deriveType" .. deriveResult( typedb:derive_type( int, long, mask)) .. "\n")
+typedb:freeze_reductions() out:write( "freezeReductions\n")
+out:write( "deriveType" .. deriveResult( typedb:derive_type( float, int, mask, nil, 2)) .. "\n")
+out:close()
+typedb = nil
+collectgarbage()
+EOR
+$LUABIN build/typedb_record.lua
+build/benchTypeDbReplay -R build/typedb_record.rec > build/typedb_record.out
+verify_test_result "Check the results of the replay of a recording of type database calls" build/typedb_record.out build/typedb_record.exp
+fi
+
 if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xINDENTL" ] ; then
 build/mewa -o build/indentl.lua -g tests/indentl.g
 INDENTLRES=$?
@@ -152,3 +254,250 @@ do
 done
 
 
+
+verify_compiler_script() {
+	CFGID=$1
+	for tst in fibo class
+	do
+		echo "Compile program examples/language1/sources/$tst.prg to LLVM IR with compiler variant $CFGID"
+		$LUABIN build/language1.compiler.$CFGID.lua -t $TARGET -d build/language1.debug.$CFGID.$tst.tmp -o build/language1.compiler.$CFGID.$tst.llr examples/language1/sources/$tst.prg
+		cat build/language1.debug.$CFGID.$tst.tmp\
+			| sed -E 's/goto [0-9][0-9]*/goto XXX/g'\
+			| sed -E 's/state [0-9][0-9]*/state XXX/g' > build/language1.debug.$CFGID.$tst.out
+		LN=`grep -n 'attributes #0' build/language1.compiler.$CFGID.$tst.llr | awk -F: '{print $1}'`
+		head -n `expr $LN - 1` build/language1.compiler.$CFGID.$tst.llr | tail -n `expr $LN - 5` > build/language1.compiler.$CFGID.$tst.out
+		verify_test_result "Lua test ($tst debug, $CFGID) compiling example program with language1 compiler" \
+						build/language1.debug.$CFGID.$tst.out tests/language1.debug.$tst.exp
+		verify_test_result "Lua test ($tst output, $CFGID) compiling example program with language1 compiler" \
+						build/language1.compiler.$CFGID.$tst.out tests/language1.compiler.$tst.exp
+	done
+}
+
+verify_compiler_config() {
+	CFGID=$1
+	CFG=$2
+	cat build/language1.compiler.lua | sed "s@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, $CFG)@" > build/language1.compiler.$CFGID.lua
+	verify_compiler_script $CFGID
+}
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xCOMPACT" ] ; then
+verify_compiler_config compact '{lexem="compact"}'
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xARENA" ] ; then
+verify_compiler_config arena '{ast="arena"}'
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xPROFILE" ] ; then
+# Profiling must not change the result of the compiler, the profile of the last program compiled is checked for the entries expected:
+verify_compiler_config profile '{profile="report", profile_typedb=true, profile_output="build/language1.profile.report.txt"}'
+verify_compiler_config profile.collapsed '{profile="collapsed", profile_output="build/language1.profile.collapsed.txt"}'
+grep -E '^typedb:def_type ' build/language1.profile.report.txt | awk '{print $1}' > build/language1.profile.report.out
+grep -E '^program [0-9]+$' build/language1.profile.collapsed.txt | awk '{print $1}' > build/language1.profile.collapsed.out
+echo "typedb:def_type" > build/language1.profile.report.exp
+echo "program" > build/language1.profile.collapsed.exp
+verify_test_result "Lua test (profile report) compiling example program with language1 compiler" \
+				build/language1.profile.report.out build/language1.profile.report.exp
+verify_test_result "Lua test (profile collapsed stacks) compiling example program with language1 compiler" \
+				build/language1.profile.collapsed.out build/language1.profile.collapsed.exp
+# An error raised in a profiled node function is reported as without profiling:
+printf 'main\n{\n\tvar int x = undefinedVariable;\n}\n' > build/language1.semanticerror.prg
+for CFGID in noprofile profile.error
+do
+	if [ "$CFGID" = "noprofile" ]; then CFG='{}'; else CFG='{profile="report", profile_typedb=true, profile_output="build/language1.profile.error.txt"}'; fi
+	sed '/^compiler:run(/d' build/language1.compiler.lua | sed "s@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, $CFG)@" > build/language1.compiler.$CFGID.lua
+	cat >> build/language1.compiler.$CFGID.lua <<EOS
+local ok,err = pcall( compiler.run, compiler, ccmd.target, ccmd.options, ccmd.input, ccmd.output)
+local errfile = assert( io.open( "build/language1.compiler.$CFGID.err", "w"))
+errfile:write( tostring( ok) .. " " .. tostring( err) .. "\n")
+errfile:close()
+EOS
+	$LUABIN build/language1.compiler.$CFGID.lua -t $TARGET -o build/language1.compiler.$CFGID.llr build/language1.semanticerror.prg
+done
+verify_test_result "Lua test (profile, error in a node function) compiling example program with language1 compiler" \
+				build/language1.compiler.profile.error.err build/language1.compiler.noprofile.err
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xSTATS" ] ; then
+# Statistics must not change the result of the compiler, the fields of the statistics of the last program compiled are checked:
+cat build/language1.compiler.lua\
+	| sed 's@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, {statistics=true})@'\
+	| sed 's@^compiler:run(\(.*\)$@local stats = compiler:run(\1\
+local statsfile = assert( io.open( "build/language1.statistics.out", "w"))\
+for _,phase in ipairs{ "input", "lexing", "parsing", "callbacks", "template", "output"} do\
+	statsfile:write( phase .. " " .. tostring( stats[ phase].wall >= 0 and stats[ phase].cpu >= 0) .. "\\n")\
+end\
+statsfile:write( "tokens " .. tostring( stats.tokens > 0) .. "\\nreductions " .. tostring( stats.reductions >= stats.tokens) .. "\\n")\
+statsfile:write( "peak_lua_memory " .. tostring( stats.peak_lua_memory > 0) .. "\\n")\
+statsfile:close()@' > build/language1.compiler.stats.lua
+verify_compiler_script stats
+printf "input true\nlexing true\nparsing true\ncallbacks true\ntemplate true\noutput true\ntokens true\nreductions true\npeak_lua_memory true\n" > build/language1.statistics.exp
+verify_test_result "Lua test (statistics) compiling example program with language1 compiler" \
+				build/language1.statistics.out build/language1.statistics.exp
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xGC" ] ; then
+# A garbage collector policy must not change the result of the compiler, the state of the garbage collector must be restored after the run:
+cat build/language1.compiler.lua\
+	| sed 's@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, {statistics=true, gc={parsing="stop", callbacks="incremental", pause=150, stepmul=200, collect=true}})@'\
+	| sed 's@^compiler:run(\(.*\)$@local stats = compiler:run(\1\
+local gcfile = assert( io.open( "build/language1.gc.out", "w"))\
+gcfile:write( "gc " .. tostring( stats.gc.wall >= 0 and stats.gc.cpu >= 0) .. "\\n")\
+gcfile:write( "lua_memory " .. tostring( stats.lua_memory > 0 and stats.lua_memory <= stats.peak_lua_memory) .. "\\n")\
+gcfile:write( "running " .. tostring( collectgarbage( "isrunning")) .. "\\n")\
+gcfile:close()@' > build/language1.compiler.gc.lua
+verify_compiler_script gc
+printf "gc true\nlua_memory true\nrunning true\n" > build/language1.gc.exp
+verify_test_result "Lua test (garbage collector policy) compiling example program with language1 compiler" \
+				build/language1.gc.out build/language1.gc.exp
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xCACHE" ] ; then
+# Compile each program twice with the AST cache, the second run reads the AST from the cache, the output must be the same:
+for CFGID in cache cache.arena
+do
+	rm -Rf build/astcache.$CFGID
+	mkdir -p build/astcache.$CFGID
+	if [ "$CFGID" = "cache" ]; then CFG='{cache="build/astcache.cache"}'; else CFG='{cache="build/astcache.cache.arena", ast="arena"}'; fi
+	cat build/language1.compiler.lua | sed "s@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, $CFG)@" > build/language1.compiler.$CFGID.lua
+	for tst in fibo class
+	do
+		for pass in write read
+		do
+			echo "Compile program examples/language1/sources/$tst.prg to LLVM IR with compiler variant $CFGID ($pass)"
+			$LUABIN build/language1.compiler.$CFGID.lua -t $TARGET -o build/language1.compiler.$CFGID.$tst.llr examples/language1/sources/$tst.prg
+			LN=`grep -n 'attributes #0' build/language1.compiler.$CFGID.$tst.llr | awk -F: '{print $1}'`
+			head -n `expr $LN - 1` build/language1.compiler.$CFGID.$tst.llr | tail -n `expr $LN - 5` > build/language1.compiler.$CFGID.$tst.out
+			verify_test_result "Lua test ($tst output, $CFGID $pass) compiling example program with language1 compiler" \
+							build/language1.compiler.$CFGID.$tst.out tests/language1.compiler.$tst.exp
+		done
+	done
+	ls build/astcache.$CFGID | wc -l | tr -d ' ' > build/language1.compiler.$CFGID.files.out
+	echo 2 > build/language1.compiler.$CFGID.files.exp
+	verify_test_result "Lua test (number of files in AST cache, $CFGID) compiling example program with language1 compiler" \
+					build/language1.compiler.$CFGID.files.out build/language1.compiler.$CFGID.files.exp
+	# A damaged cache file is a cache miss, the program is parsed again:
+	for cachefile in build/astcache.$CFGID/*.ast
+	do
+		head -c 256 /dev/zero | tr '\000' '\377' | dd of=$cachefile bs=1 seek=64 conv=notrunc 2>/dev/null
+	done
+	for tst in fibo class
+	do
+		echo "Compile program examples/language1/sources/$tst.prg to LLVM IR with compiler variant $CFGID (damaged cache file)"
+		$LUABIN build/language1.compiler.$CFGID.lua -t $TARGET -o build/language1.compiler.$CFGID.$tst.llr examples/language1/sources/$tst.prg
+		LN=`grep -n 'attributes #0' build/language1.compiler.$CFGID.$tst.llr | awk -F: '{print $1}'`
+		head -n `expr $LN - 1` build/language1.compiler.$CFGID.$tst.llr | tail -n `expr $LN - 5` > build/language1.compiler.$CFGID.$tst.out
+		verify_test_result "Lua test ($tst output, $CFGID damaged cache file) compiling example program with language1 compiler" \
+						build/language1.compiler.$CFGID.$tst.out tests/language1.compiler.$tst.exp
+	done
+done
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xSTREAM" ] ; then
+# Feed the source in chunks of 7 bytes to the compiler, lexems span chunk boundaries:
+cat build/language1.compiler.lua\
+	| sed 's@^compiler:run( ccmd.target, ccmd.options, ccmd.input,@local src = assert( io.open( ccmd.input)):read( "*a")\
+local pos = 1\
+local function reader() local chunk = src:sub( pos, pos+6); pos = pos + 7; return chunk end\
+compiler:run( ccmd.target, ccmd.options, reader,@' > build/language1.compiler.stream.lua
+verify_compiler_script stream
+# A reader raising an error ends the compilation with this error, the compiler can be used again afterwards:
+sed '/^compiler:run(/d' build/language1.compiler.lua > build/language1.compiler.streamerr.lua
+cat >> build/language1.compiler.streamerr.lua <<EOS
+local src = assert( io.open( ccmd.input)):read( "*a")
+local pos = 1
+local function failingReader()
+	if pos > 64 then error( "reader failure") end
+	local chunk = src:sub( pos, pos+15); pos = pos + 16; return chunk
+end
+local resultfile = assert( io.open( "build/language1.compiler.streamerr.out", "w"))
+local ok,err = pcall( compiler.run, compiler, ccmd.target, ccmd.options, failingReader, ccmd.output)
+resultfile:write( string.format( "ok %s error %s\n", tostring( ok), tostring( string.find( tostring( err), "reader failure", 1, true) ~= nil)))
+compiler:run( ccmd.target, ccmd.options, ccmd.input, ccmd.output)
+resultfile:write( "compiled\n")
+resultfile:close()
+EOS
+echo "Compile program examples/language1/sources/fibo.prg with a reader function raising an error"
+$LUABIN build/language1.compiler.streamerr.lua -t $TARGET -o build/language1.compiler.streamerr.llr examples/language1/sources/fibo.prg
+printf "ok false error true\ncompiled\n" > build/language1.compiler.streamerr.exp
+verify_test_result "Lua test (reader raising an error) compiling example program with language1 compiler" \
+				build/language1.compiler.streamerr.out build/language1.compiler.streamerr.exp
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xBATCH" ] ; then
+sed '/^compiler:run(/d' build/language1.compiler.lua > build/language1.compiler.batch.lua
+cat >> build/language1.compiler.batch.lua <<EOS
+local units = {}
+for _,tst in ipairs{ "fibo", "class"} do
+	table.insert( units, {input="examples/language1/sources/" .. tst .. ".prg",
+				output="build/language1.compiler.batch." .. tst .. ".llr", debug="build/language1.debug.batch." .. tst .. ".tmp"})
+end
+table.insert( units, "examples/language1/sources/fibo.prg")
+for _,result in ipairs( compiler:run_batch( ccmd.target, ccmd.options, units, 2)) do
+	if not result.ok then error( result.error) end
+	if result.output then
+		local outfile = assert( io.open( "build/language1.compiler.batch.captured.llr", "w"))
+		outfile:write( result.output)
+		outfile:close()
+	end
+end
+EOS
+echo "Compile programs examples/language1/sources/fibo.prg and examples/language1/sources/class.prg to LLVM IR as batch"
+$LUABIN build/language1.compiler.batch.lua -t $TARGET examples/language1/sources/fibo.prg
+for tst in fibo class
+do
+	cat build/language1.debug.batch.$tst.tmp\
+		| sed -E 's/goto [0-9][0-9]*/goto XXX/g'\
+		| sed -E 's/state [0-9][0-9]*/state XXX/g' > build/language1.debug.batch.$tst.out
+	LN=`grep -n 'attributes #0' build/language1.compiler.batch.$tst.llr | awk -F: '{print $1}'`
+	head -n `expr $LN - 1` build/language1.compiler.batch.$tst.llr | tail -n `expr $LN - 5` > build/language1.compiler.batch.$tst.out
+	verify_test_result "Lua test ($tst debug, batch) compiling example program with language1 compiler" \
+					build/language1.debug.batch.$tst.out tests/language1.debug.$tst.exp
+	verify_test_result "Lua test ($tst output, batch) compiling example program with language1 compiler" \
+					build/language1.compiler.batch.$tst.out tests/language1.compiler.$tst.exp
+done
+verify_test_result "Lua test (fibo captured output, batch) compiling example program with language1 compiler" \
+				build/language1.compiler.batch.captured.llr build/language1.compiler.batch.fibo.llr
+# The options of the compiler are copied to the workers, the statistics of each unit are returned in its result:
+sed '/^compiler:run(/d' build/language1.compiler.lua | sed "s@mewa.compiler( compilerdef)@mewa.compiler( compilerdef, {statistics=true, gc={collect=true}})@" > build/language1.compiler.batchstats.lua
+cat >> build/language1.compiler.batchstats.lua <<EOS
+local statsfile = assert( io.open( "build/language1.compiler.batchstats.out", "w"))
+local units = {"examples/language1/sources/fibo.prg", "examples/language1/sources/class.prg"}
+for ui,result in ipairs( compiler:run_batch( ccmd.target, ccmd.options, units, 2)) do
+	if not result.ok then error( result.error) end
+	local st = result.statistics
+	statsfile:write( string.format( "%d tokens %s reductions %s callbacks %s gc %s\\n", ui,
+			tostring( st.tokens > 0), tostring( st.reductions > st.tokens), tostring( st.callbacks.wall > 0), tostring( st.gc.wall > 0)))
+end
+statsfile:close()
+EOS
+echo "Compile programs examples/language1/sources/fibo.prg and examples/language1/sources/class.prg as batch with statistics"
+$LUABIN build/language1.compiler.batchstats.lua -t $TARGET examples/language1/sources/fibo.prg
+printf "1 tokens true reductions true callbacks true gc true\n2 tokens true reductions true callbacks true gc true\n" > build/language1.compiler.batchstats.exp
+verify_test_result "Lua test (statistics, batch) compiling example programs with language1 compiler" \
+				build/language1.compiler.batchstats.out build/language1.compiler.batchstats.exp
+fi
+
+if [ "x$TESTID" = "x" ] || [ "x$TESTID" = "xCHECK" ] ; then
+# Syntax check of the example programs and of a program with a syntax error, with compiler:check and with the option -c of the mewa program:
+printf 'main\n{\n\tvar int x = 1 + ;\n}\n' > build/language1.syntaxerror.prg
+sed '/^compiler:run(/d' build/language1.compiler.lua > build/language1.compiler.check.lua
+cat >> build/language1.compiler.check.lua <<EOC
+local checkfile = assert( io.open( "build/language1.check.out", "w"))
+for _,tst in ipairs{ "fibo", "class", "tree"} do
+	checkfile:write( tst .. " " .. tostring( compiler:check( "examples/language1/sources/" .. tst .. ".prg")) .. "\\n")
+end
+local ok, err, line = compiler:check( "build/language1.syntaxerror.prg")
+checkfile:write( "syntaxerror " .. tostring( ok) .. " " .. tostring( line) .. " " .. tostring( err:match( "^#601") ~= nil) .. "\\n")
+checkfile:close()
+EOC
+$LUABIN build/language1.compiler.check.lua -t $TARGET examples/language1/sources/fibo.prg
+printf "fibo true\nclass true\ntree true\nsyntaxerror false 3 true\n" > build/language1.check.exp
+verify_test_result "Lua test (compiler:check) syntax check of example programs with language1 compiler" \
+				build/language1.check.out build/language1.check.exp
+build/mewa -c examples/language1/grammar.g examples/language1/sources/*.prg build/language1.syntaxerror.prg 2> build/language1.check.mewa.tmp\
+	|| echo "exit $?" >> build/language1.check.mewa.tmp
+sed -E 's/ at line ([0-9]+):.*$/ at line \1/' build/language1.check.mewa.tmp > build/language1.check.mewa.out
+printf 'ERR build/language1.syntaxerror.prg: #601 "Syntax error, unexpected token (expected one of {...})" at line 3\nexit 2\n' > build/language1.check.mewa.exp
+verify_test_result "Check 'mewa -c' syntax check of example programs" build/language1.check.mewa.out build/language1.check.mewa.exp
+fi
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <algorithm>
 
 bool g_verbose = false;
 using namespace mewa;
@@ -40,11 +41,32 @@ void testActivation( const char* rxstr, const char* expected)
 	}
 }
 
-void runLexer( const char* name, const Lexer& lexer, const std::string& source, const std::string& expected)
+class ChunkReader
+	:public ScannerReader
+{
+public:
+	ChunkReader( const std::string& source_, std::size_t chunksize_)
+		:m_source(source_),m_chunksize(chunksize_),m_pos(0){}
+
+	virtual bool read( std::string& buf)
+	{
+		if (m_pos >= m_source.size()) return false;
+		std::size_t nn = std::min( m_chunksize, m_source.size() - m_pos);
+		buf.append( m_source.c_str() + m_pos, nn);
+		m_pos += nn;
+		return true;
+	}
+
+private:
+	std::string m_source;
+	std::size_t m_chunksize;
+	std::size_t m_pos;
+};
+
+static std::string lexerOutput( const Lexer& lexer, Scanner& scanner)
 {
 	std::ostringstream outputbuf;
 	outputbuf << "\n";
-	Scanner scanner( source);
 	Lexem lexem = lexer.next( scanner);
 	for (; !lexem.empty(); lexem = lexer.next( scanner))
 	{
@@ -55,7 +77,26 @@ void runLexer( const char* name, const Lexer& lexer, const std::string& source,
 			break;
 		}
 	}
-	std::string output = outputbuf.str();
+	return outputbuf.str();
+}
+
+void runLexer( const char* name, const Lexer& lexer, const std::string& source, const std::string& expected)
+{
+	Scanner scanner( source);
+	std::string output = lexerOutput( lexer, scanner);
+	// Scan the source read in chunks of different sizes with a minimal lookahead, the result must be the same:
+	for (std::size_t chunksize : {1, 3, 17, 1000})
+	{
+		ChunkReader reader( source, chunksize);
+		Scanner streamScanner( &reader, 1/*lookahead*/);
+		std::string streamOutput = lexerOutput( lexer, streamScanner);
+		if (streamOutput != output)
+		{
+			std::cerr << "ERR test output of scanner reading chunks of size " << chunksize << " differs" << std::endl;
+			output = streamOutput;
+			break;
+		}
+	}
 	if (output != expected)
 	{
 		writeFile( std::string("build/testLexer.") + name + ".out", output);
@@ -14,6 +14,7 @@
 #error Building mewa requires at least C++17
 #endif
 #include "typedb.hpp"
+#include "typedb_record.hpp"
 #include "error.hpp"
 #include "fileio.hpp"
 #include "strings.hpp"
@@ -25,7 +26,10 @@
 #include <limits>
 #include <utility>
 #include <memory>
+#include <thread>
+#include <mutex>
 #include <cstring>
+#include <cerrno>
 
 using namespace mewa;
 
@@ -619,6 +623,134 @@ Found match: #member1_myclass( #myclass <- #myclass<-inhclass)
 			removeFile( "build/testTypeDb.out");
 			removeFile( "build/testTypeDb.exp");
 		}
+
+		// Test concurrent queries of a frozen type database:
+		if (verbose) std::cerr << "Do the type resolving tests concurrently on the frozen type database ..." << std::endl;
+		tdbimpl.typedb->freeze();
+		try
+		{
+			tdbimpl.typedb->setObjectInstance( "gurke", {0,100}, 4);
+			throw std::runtime_error( "modification of frozen type database not detected");
+		}
+		catch (const mewa::Error& err)
+		{
+			if (err.code() != Error::ModificationOfFrozenTypeDatabase) throw err;
+		}
+		enum {NofThreads = 8, NofRuns = 20};
+		std::vector<std::string> threadOutputs( NofThreads);
+		std::vector<std::string> threadErrors( NofThreads);
+		std::vector<std::thread> threads;
+		int nofQueries = 0;
+		for (; testQueries[ nofQueries].ar[0]; ++nofQueries){}
+		long resolveTypeCallsBefore = tdbimpl.typedb->statistics().resolveTypeCalls;
+		bool queriesDone = false;
+		std::mutex queriesDoneMutex;
+		std::string statisticsError;
+		// ... read the statistics while the queries are running, the counters must not decrease
+		std::thread statisticsThread( [&tdbimpl,&queriesDone,&queriesDoneMutex,&statisticsError]()
+		{
+			long lastResolveTypeCalls = 0;
+			long lastCacheHits = 0;
+			std::size_t lastIdentStrUsed = 0;
+			for (;;)
+			{
+				{
+					std::lock_guard<std::mutex> lock( queriesDoneMutex);
+					if (queriesDone) break;
+				}
+				auto stats = tdbimpl.typedb->statistics();
+				auto cacheStats = tdbimpl.typedb->resolveTypeCacheStatistics();
+				tdbimpl.typedb->deriveTypeCacheStatistics();
+				tdbimpl.typedb->reductionIndexStatistics();
+				if (stats.resolveTypeCalls < lastResolveTypeCalls || cacheStats.hits < lastCacheHits || stats.identstr.used < lastIdentStrUsed)
+				{
+					statisticsError = "statistics of concurrent queries decreasing";
+					break;
+				}
+				lastResolveTypeCalls = stats.resolveTypeCalls;
+				lastCacheHits = cacheStats.hits;
+				lastIdentStrUsed = stats.identstr.used;
+			}
+		});
+		for (int ti = 0; ti < NofThreads; ++ti)
+		{
+			threads.emplace_back( [&tdbimpl,&expected,&threadOutputs,&threadErrors,ti]()
+			{
+				try
+				{
+					for (int ri = 0; ri < NofRuns; ++ri)
+					{
+						std::ostringstream threadbuf;
+						threadbuf << "\n";
+						for (int qi=0; testQueries[ qi].ar[0]; ++qi)
+						{
+							testQuery( threadbuf, tdbimpl, testQueries[ qi], false/*verbose*/);
+						}
+						threadOutputs[ ti] = threadbuf.str();
+						if (threadOutputs[ ti] != expected) break;
+						// ... render the types with a new separator, the strings are allocated while the statistics are read
+						std::string sep = string_format( "<%d.%d>", ti, ri);
+						for (int type = 1; type <= (int)tdbimpl.typedb->statistics().nofTypes; ++type)
+						{
+							tdbimpl.typedb->typeString( type, sep.c_str());
+						}
+					}
+				}
+				catch (const std::exception& err)
+				{
+					threadErrors[ ti] = err.what();
+				}
+			});
+		}
+		for (auto& th : threads)
+		{
+			th.join();
+		}
+		{
+			std::lock_guard<std::mutex> lock( queriesDoneMutex);
+			queriesDone = true;
+		}
+		statisticsThread.join();
+		if (!statisticsError.empty())
+		{
+			throw std::runtime_error( statisticsError);
+		}
+		for (int ti = 0; ti < NofThreads; ++ti)
+		{
+			if (!threadErrors[ ti].empty())
+			{
+				throw std::runtime_error( string_format( "error in thread %d: %s", ti, threadErrors[ ti].c_str()));
+			}
+			if (threadOutputs[ ti] != expected)
+			{
+				writeFile( "build/testTypeDb.out", threadOutputs[ ti]);
+				writeFile( "build/testTypeDb.exp", expected);
+				std::cerr << "ERR test output (build/testTypeDb.out) of thread " << ti << " differs expected build/testTypeDb.exp" << std::endl;
+				return 3;
+			}
+		}
+		long resolveTypeCalls = tdbimpl.typedb->statistics().resolveTypeCalls - resolveTypeCallsBefore;
+		if (resolveTypeCalls < (long)NofThreads * NofRuns * nofQueries)
+		{
+			throw std::runtime_error( string_format( "statistics of concurrent queries incomplete: %ld resolveType calls counted, at least %ld expected",
+									resolveTypeCalls, (long)NofThreads * NofRuns * nofQueries));
+		}
+
+		// Test the error code of a failing write of a recording of type database calls:
+		if (verbose) std::cerr << "Write a recording of type database calls to a full device ..." << std::endl;
+		{
+			TypeDatabaseRecorder recorder( "/dev/full");
+			recorder.defineTypeAs( {0,100}, 0, "int", 1);
+			try
+			{
+				recorder.flush();
+				throw std::runtime_error( "error writing a recording to a full device not detected");
+			}
+			catch (const mewa::Error& err)
+			{
+				if (err.code() != (Error::Code)ENOSPC) throw err;
+			}
+		}
 		std::cerr << "OK" << std::endl;
 		return 0;
 	}
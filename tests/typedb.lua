@@ -395,12 +395,757 @@ any: int(#b!) 3
 	checkTestResult( "testResolveType_typeConstructorPairs", res, expected)
 end
 
+-- Function that tests the tree traversal functions mewa.traverse and mewa.traverseRange
+function testTraverse()
+	typedb = mewa.typedb()
+	local log = {}
+	local function scopeString()
+		local scope,step = typedb:scope()
+		return "{" .. scope[1] .. "," .. scope[2] .. "}" .. step
+	end
+	local function leaf( node, prefix)
+		table.insert( log, prefix .. " " .. node.name .. " " .. scopeString() .. " node=" .. typedb:this_instance( "node").name)
+		return prefix .. node.name
+	end
+	local function inner( node, obj, prefix)
+		table.insert( log, prefix .. " " .. node.name .. " " .. scopeString() .. " obj=" .. obj)
+		local args = mewa.traverse( typedb, node, prefix .. ".")
+		return node.name .. "(" .. table.concat( args, ",") .. ")"
+	end
+	local tree = {name="root", arg={
+			{call={proc=leaf}, name="a", scope={1,10}},
+			{call={proc=inner, obj="X"}, name="b", step=5, arg={
+				{call={proc=leaf}, name="c", scope={6,8}},
+				{name="ident", value="v"}}},
+			{name="number", value="7"},
+			{call={proc=leaf}, name="d"}
+		}}
+	typedb:scope( {0,100})
+	typedb:set_instance( "node", {name="root"})
+	local res = table.concat( mewa.traverse( typedb, tree, "T"), " ") .. "\n"
+	res = res .. table.concat( mewa.traverseRange( typedb, tree, {2,3}, "R"), " ") .. "\n"
+	res = res .. tostring( mewa.traverse( typedb, {name="ident", value="v"})) .. "\n"
+	res = res .. table.concat( log, "\n") .. "\n" .. scopeString() .. "\n"
+	local expected = [[Ta b(T.c,v) 7 Td
+b(R.c,v) 7
+v
+T a {1,10}9 node=a
+T b {0,100}5 obj=X
+T. c {6,8}7 node=c
+T d {0,100}99 node=root
+R b {0,100}5 obj=X
+R. c {6,8}7 node=c
+{0,100}99
+]]
+	checkTestResult( "testTraverse", res, expected)
+end
+
+-- Function that tests the cache of typedb:derive_type results
+function testDeriveTypeCache()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local short_type = typedb:def_type( 0, "short")
+	local int_type = typedb:def_type( 0, "int")
+	local long_type = typedb:def_type( 0, "long")
+	typedb:def_reduction( int_type, short_type, "int(short)", tag_conv, 1.0)
+	typedb:def_reduction( long_type, int_type, "long(int)", tag_conv, 1.0)
+	typedb:scope( {10,20})
+	typedb:def_reduction( long_type, short_type, "long(short)", tag_conv, 0.5)
+
+	local function deriveString( step)
+		typedb:step( step)
+		local reductions,weight = typedb:derive_type( long_type, short_type, mask_conv, nil, -1)
+		if not reductions then return "NONE" end
+		local rt = ""
+		for _,redu in ipairs( reductions) do rt = rt .. redu.constructor .. " " end
+		return rt .. weight
+	end
+	local function cacheString()
+		local st = typedb:cache_statistics().derive_type
+		return string.format( "hits=%d misses=%d size=%d", st.hits, st.misses, st.size)
+	end
+	local result = deriveString( 5) .. "\n" .. deriveString( 7) .. "\n" .. deriveString( 15) .. "\n" .. deriveString( 19) .. "\n"
+			.. deriveString( 20) .. "\n" .. cacheString() .. "\n"
+	typedb:scope( {12,14})
+	typedb:def_reduction( long_type, short_type, "long(short) inner", tag_conv, 0.25)
+	result = result .. cacheString() .. "\n" .. deriveString( 13) .. "\n" .. deriveString( 15) .. "\n" .. cacheString()
+	local expected = [[
+int(short) long(int) 2.0
+int(short) long(int) 2.0
+long(short) 0.5
+long(short) 0.5
+int(short) long(int) 2.0
+hits=2 misses=3 size=3
+hits=2 misses=3 size=0
+long(short) inner 0.25
+long(short) 0.5
+hits=2 misses=5 size=2]]
+	checkTestResult( "testDeriveTypeCache", result, expected)
+end
+
+-- Function that tests the cache of typedb:resolve_type results
+function testResolveTypeCache()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local base_type = typedb:def_type( 0, "base")
+	local derived_type = typedb:def_type( 0, "derived")
+	local other_type = typedb:def_type( 0, "other")
+	typedb:def_reduction( base_type, derived_type, "base(derived)", tag_conv, 1.0)
+	typedb:def_type( base_type, "f", "base::f")
+	typedb:scope( {10,20})
+	typedb:def_type( derived_type, "f", "derived::f in {10,20}")
+
+	local function resolveString( step, contextType)
+		typedb:step( step)
+		local ctx,reductions,items = typedb:resolve_type( contextType, "f", mask_conv)
+		if not ctx then return "NONE" end
+		if type(ctx) == "table" then return "AMBIGUOUS " .. typedb:type_string( ctx[1]) .. " " .. typedb:type_string( ctx[2]) end
+		local rt = typedb:type_string( ctx)
+		for _,redu in ipairs( reductions) do rt = rt .. " " .. redu.constructor end
+		for _,item in ipairs( items) do rt = rt .. " : " .. typedb:type_constructor( item) end
+		return rt
+	end
+	local function cacheString()
+		local st = typedb:cache_statistics().resolve_type
+		return string.format( "hits=%d misses=%d size=%d", st.hits, st.misses, st.size)
+	end
+	local result = resolveString( 5, derived_type) .. "\n" .. resolveString( 15, derived_type) .. "\n"
+			.. resolveString( 6, derived_type) .. "\n" .. resolveString( 16, derived_type) .. "\n" .. cacheString() .. "\n"
+	typedb:scope( {12,14})
+	typedb:def_type( derived_type, "f", "derived::f in {12,14}")
+	typedb:def_type( other_type, "g", "other::g")
+	result = result .. resolveString( 13, derived_type) .. "\n" .. resolveString( 15, derived_type) .. "\n" .. cacheString() .. "\n"
+	typedb:scope( {0,100})
+	typedb:def_reduction( other_type, derived_type, "other(derived)", tag_conv, 1.0)
+	typedb:def_type( other_type, "f", "other::f")
+	result = result .. resolveString( 5, derived_type) .. "\n" .. cacheString()
+	local expected = [[
+base base(derived) : base::f
+derived : derived::f in {10,20}
+base base(derived) : base::f
+derived : derived::f in {10,20}
+hits=2 misses=2 size=2
+derived : derived::f in {12,14}
+derived : derived::f in {10,20}
+hits=2 misses=4 size=4
+AMBIGUOUS other base
+hits=2 misses=5 size=1]]
+	checkTestResult( "testResolveTypeCache", result, expected)
+end
+
+-- Function that tests that the reduction index built after typedb:freeze_reductions gives the same results as the search
+function testFreezeReductions()
+	local tag_conv = 1
+	local tag_cast = 2
+	local function buildTypeDb( freeze)
+		local db = mewa.typedb()
+		local types = {}
+		for _,name in ipairs{ "bool", "byte", "short", "int", "long", "float", "double", "A", "B"} do
+			types[ name] = db:def_type( 0, name)
+		end
+		local function redu( to, from, tag, weight) db:def_reduction( types[to], types[from], to .. "(" .. from .. ")", tag, weight) end
+		redu( "short", "byte", tag_conv, 0.25); redu( "int", "short", tag_conv, 0.25); redu( "long", "int", tag_conv, 0.25)
+		redu( "float", "int", tag_conv, 0.5); redu( "double", "float", tag_conv, 0.25); redu( "double", "long", tag_conv, 0.5)
+		redu( "bool", "int", tag_cast, 1.0); redu( "byte", "bool", tag_cast, 1.0); redu( "int", "byte", tag_cast, 0.5)
+		if freeze then db:freeze_reductions() end
+		db:scope( {10,20})
+		redu( "B", "A", tag_conv, 0.5); redu( "long", "B", tag_conv, 0.5)
+		db:scope( {30,40})
+		redu( "double", "short", tag_conv, 1.0)
+		db:scope( {0,-1})
+		redu( "A", "double", tag_cast, 2.0)
+		return db, types
+	end
+	local function queryString( db, types)
+		local rt = ""
+		local names = { "bool", "byte", "short", "int", "long", "float", "double", "A", "B"}
+		for _,step in ipairs{ 5, 15, 35, 50} do
+			db:step( step)
+			for _,from in ipairs( names) do
+				for _,to in ipairs( names) do
+					for _,mask in ipairs{ db.reduction_tagmask( tag_conv), db.reduction_tagmask( tag_conv, tag_cast)} do
+						local reductions,weight,conflict = db:derive_type( types[to], types[from], mask, db.reduction_tagmask( tag_cast), 1)
+						if reductions then
+							rt = rt .. string.format( "%d %s <- %s : %.4f", step, to, from, weight)
+							for _,redu in ipairs( reductions) do rt = rt .. " " .. redu.constructor end
+							if conflict then rt = rt .. " CONFLICT " .. #conflict end
+							rt = rt .. "\n"
+						end
+					end
+					local weight,constructor = db:get_reduction( types[to], types[from], db.reduction_tagmask( tag_conv, tag_cast))
+					if constructor then rt = rt .. string.format( "%d REDU %s <- %s : %.4f %s\n", step, to, from, weight, constructor) end
+				end
+			end
+		end
+		return rt
+	end
+	local result = queryString( buildTypeDb( true))
+	local expected = queryString( buildTypeDb( false))
+	local db,types = buildTypeDb( true)
+	queryString( db, types)
+	if db:cache_statistics().reduction_index.hits == 0 then result = result .. "NO INDEX HITS" end
+	checkTestResult( "testFreezeReductions", result, expected)
+end
+
+-- Reference implementation of the search of typedb:derive_type in plain Lua with typedb:get_reductions
+function referenceDeriveType( db, toType, fromType, tagmask, tagmask_pathlen, max_pathlen)
+	local epsilon = 1.1920929e-07 -- std::numeric_limits<float>::epsilon()
+	if max_pathlen == -1 then max_pathlen = math.maxinteger end
+	local stack = {{type=fromType, constructor=0, prev=nil, pathlen=0}}
+	local queue = {{weight=0.0, index=1}}
+	local result,weightsum,conflict = nil,nil,nil
+	local function collectPath( index, getter)
+		local rt = {}
+		while stack[ index].prev do table.insert( rt, 1, getter( stack[ index])); index = stack[ index].prev end
+		return rt
+	end
+	while #queue > 0 do
+		local qi = 1
+		for ii=2,#queue do
+			if queue[ii].weight < queue[qi].weight or (queue[ii].weight == queue[qi].weight and queue[ii].index < queue[qi].index) then qi = ii end
+		end
+		local qe = table.remove( queue, qi)
+		if result and qe.weight > weightsum + epsilon then break end
+		local elem = stack[ qe.index]
+		if elem.type == toType then
+			if not result then
+				result = collectPath( qe.index, function( ee) return {type=ee.type, constructor=ee.constructor} end)
+				weightsum = qe.weight
+			else
+				conflict = collectPath( qe.index, function( ee) return ee.type end)
+				break
+			end
+		end
+		for _,redu in ipairs( db:get_reductions( elem.type, tagmask, tagmask_pathlen)) do
+			local pathlen = redu.count and elem.pathlen+1 or elem.pathlen
+			if pathlen <= max_pathlen then
+				local ai = qe.index
+				while ai and stack[ ai].type ~= redu.type do ai = stack[ ai].prev end
+				if not ai then
+					table.insert( stack, {type=redu.type, constructor=redu.constructor, prev=qe.index, pathlen=pathlen})
+					table.insert( queue, {weight=qe.weight + redu.weight, index=#stack})
+				end
+			end
+		end
+	end
+	return result,weightsum,conflict
+end
+
+-- Function that compares the results of typedb:derive_type on a random type lattice with the reference implementation
+function testDeriveTypeReference()
+	local seed = 12345
+	local function random( range) seed = (seed * 1103515245 + 12345) % 2147483648; return (seed // 65536) % range end
+	local function deriveResultString( reductions, weight, conflict)
+		if not reductions then return "NONE" end
+		local rt = string.format( "%.4f", weight)
+		for _,redu in ipairs( reductions) do rt = rt .. " " .. redu.constructor end
+		if conflict then rt = rt .. " CONFLICT " .. table.concat( conflict, ",") end
+		return rt
+	end
+	local nofTypes = 14
+	local function buildTypeDb( freeze)
+		seed = 12345
+		local db = mewa.typedb()
+		for ti=1,nofTypes do db:def_type( 0, "t" .. ti) end
+		for ri=1,60 do
+			local from,to = random( nofTypes)+1,random( nofTypes)+1
+			if from ~= to then
+				if ri == 40 and freeze then db:freeze_reductions() end
+				local start = random( 4)*10
+				local scope = random( 4) == 0 and {start, start + 5 + random( 3)*10} or {0,-1}
+				db:scope( scope)
+				local tag,weight = random( 2)+1, (random( 4)+1) * 0.25
+				pcall( db.def_reduction, db, to, from, string.format( "r%d", ri), tag, weight) -- duplicate definitions are skipped
+			end
+		end
+		return db
+	end
+	local result = ""
+	local expected = ""
+	for _,freeze in ipairs{ false, true} do
+		local db = buildTypeDb( freeze)
+		for _,step in ipairs{ 1, 12, 27, 44, 60} do
+			db:step( step)
+			for from=1,nofTypes do
+				for to=1,nofTypes do
+					for _,args in ipairs{ {db.reduction_tagmask( 1, 2), db.reduction_tagmask( 2), 1}, {db.reduction_tagmask( 1, 2), db.reduction_tagmask(), -1}, {db.reduction_tagmask( 1), db.reduction_tagmask( 1), 2}} do
+						local res = deriveResultString( db:derive_type( to, from, args[1], args[2], args[3]))
+						local exp = deriveResultString( referenceDeriveType( db, to, from, args[1], args[2], args[3]))
+						if res ~= exp then
+							result = result .. string.format( "%d %d <- %d : %s\n", step, to, from, res)
+							expected = expected .. string.format( "%d %d <- %d : %s\n", step, to, from, exp)
+						end
+					end
+				end
+			end
+		end
+	end
+	checkTestResult( "testDeriveTypeReference", result, expected)
+end
+
+function testSearchLongPath()
+	typedb = mewa.typedb()
+	local nofTypes = 3000
+	local types = {}
+	for ti=1,nofTypes do types[ ti] = typedb:def_type( 0, "t" .. ti) end
+	for ti=2,nofTypes do
+		typedb:def_reduction( types[ ti], types[ ti-1], "c" .. ti, 1, 0.5)
+		-- ... side paths growing the queue and the stack of the search without leading to the target
+		typedb:def_reduction( typedb:def_type( types[ ti-1], "side"), types[ ti], "s" .. ti, 1, 0.25)
+	end
+	typedb:def_type( types[ nofTypes], "member")
+	local function pathString( reductions, weight, conflict)
+		if not reductions then return "NONE" end
+		return string.format( "%d %s ... %s [%.1f]%s", #reductions, reductions[1].constructor, reductions[ #reductions].constructor, weight,
+					conflict and (" conflict " .. #conflict) or "")
+	end
+	local result = pathString( typedb:derive_type( types[ nofTypes], types[1]))
+	local _,redus,items = typedb:resolve_type( types[1], "member")
+	result = result .. "\n" .. #redus .. " " .. #items
+	typedb:def_reduction( types[ nofTypes], types[ 1000], "shortcut", 1, 1000.0)
+	result = result .. "\n" .. pathString( typedb:derive_type( types[ nofTypes], types[1]))
+	local expected = [[
+2999 c2 ... c3000 [1499.5]
+2999 1
+1000 c2 ... shortcut [1499.5] conflict 2999]]
+	checkTestResult( "testSearchLongPath", result, expected)
+end
+
+-- Define the numeric types with conversions of the tests of derive_types and derive_type with a list of target types in the global typedb
+local function defineNumericTypes( tag_conv)
+	local types = {}
+	for _,name in ipairs{ "short", "int", "long", "float", "double", "bool"} do
+		types[ name] = typedb:def_type( 0, name)
+	end
+	typedb:def_reduction( types.int, types.short, "int(short)", tag_conv, 1.0)
+	typedb:def_reduction( types.long, types.int, "long(int)", tag_conv, 1.0)
+	typedb:def_reduction( types.float, types.int, "float(int)", tag_conv, 1.5)
+	typedb:def_reduction( types.float, types.short, "float(short)", tag_conv, 2.0)
+	typedb:def_reduction( types.double, types.int, "double(int)", tag_conv, 1.0)
+	typedb:def_reduction( types.double, types.short, "double(short)", tag_conv, 2.0)
+	return types
+end
+
+-- String of a result of derive_type (reductions, weight, conflict) for comparing results
+local function deriveResultString( reductions, weight, conflict)
+	if not reductions then return "NONE" end
+	local rt = ""
+	for _,redu in ipairs( reductions) do rt = rt .. redu.constructor .. " " end
+	if conflict then rt = rt .. "CONFLICT " .. #conflict .. " " end
+	return rt .. weight
+end
+
+function testDeriveTypes()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local types = defineNumericTypes( tag_conv)
+
+	local typepairs = {{types.long, types.short}, {types.short, types.long}, {types.float, types.short}, {types.double, types.short},
+				{types.int, types.int}, {types.long, types.int}}
+	local result = ""
+	local expected = ""
+	for _,res in ipairs( typedb:derive_types( typepairs, mask_conv, nil, -1)) do
+		result = result .. (res and deriveResultString( res, res.weight, res.conflict) or "NONE") .. "\n"
+	end
+	for _,pair in ipairs( typepairs) do
+		expected = expected .. deriveResultString( typedb:derive_type( pair[1], pair[2], mask_conv, nil, -1)) .. "\n"
+	end
+	local ok,err = pcall( typedb.derive_types, typedb, {{types.long, "short"}})
+	result = result .. (ok and "OK" or "ERROR")
+	expected = expected .. "ERROR"
+	checkTestResult( "testDeriveTypes", result, expected)
+end
+
+function testResolveCallable()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local short_type = typedb:def_type( 0, "short")
+	local int_type = typedb:def_type( 0, "int")
+	local long_type = typedb:def_type( 0, "long")
+	local float_type = typedb:def_type( 0, "float")
+	local byte_type = typedb:def_type( 0, "byte")
+	typedb:def_reduction( int_type, short_type, "int(short)", tag_conv, 0.25)
+	typedb:def_reduction( long_type, short_type, "long(short)", tag_conv, 0.5)
+	typedb:def_reduction( long_type, int_type, "long(int)", tag_conv, 0.25)
+	typedb:def_reduction( float_type, int_type, "float(int)", tag_conv, 0.75)
+	typedb:def_reduction( short_type, byte_type, "short(byte)", tag_conv, 0.25)
+	typedb:def_reduction( int_type, byte_type, "int(byte)", tag_conv, 0.5)
+	local items = {
+		typedb:def_type( 0, "f", nil, {int_type}),
+		typedb:def_type( 0, "f", nil, {long_type}),
+		typedb:def_type( 0, "f", nil, {float_type}),
+		typedb:def_type( 0, "f", nil, {int_type, long_type}),
+		typedb:def_type( 0, "f", nil, {long_type, int_type}),
+		typedb:def_type( 0, "f", nil, {long_type, long_type})
+	}
+	local function resultString( weight, candidates)
+		if not weight then return "NONE" end
+		local rt = string.format( "%.2f", weight)
+		for _,candidate in ipairs( candidates) do
+			rt = rt .. " " .. typedb:type_string( candidate.type) .. " ["
+			for ai,redulist in ipairs( candidate.reductions) do
+				if ai > 1 then rt = rt .. "," end
+				for ri,redu in ipairs( redulist) do rt = rt .. (ri > 1 and " " or "") .. redu.constructor end
+				if candidate.conflicts and candidate.conflicts[ ai] then rt = rt .. " CONFLICT" end
+			end
+			rt = rt .. "]"
+		end
+		return rt
+	end
+	local result = ""
+	for _,args in ipairs{ {int_type}, {short_type}, {{type=short_type,constructor="x"}, int_type}, {short_type, short_type}, {float_type, int_type}, {byte_type}} do
+		for _,accumulation in ipairs{ "sum", "max"} do
+			local minweight = nil
+			local groups = {}
+			repeat
+				local weight,candidates = typedb:resolve_callable( items, args, mask_conv, nil, -1, minweight, accumulation)
+				table.insert( groups, resultString( weight, candidates))
+				minweight = weight
+			until not weight
+			result = result .. accumulation .. ": " .. table.concat( groups, " | ") .. "\n"
+		end
+	end
+	local expected = [[
+sum: 0.00 f(int) [] | 0.25 f(long) [long(int)] | 0.75 f(float) [float(int)] | NONE
+max: 0.00 f(int) [] | 0.25 f(long) [long(int)] | 0.75 f(float) [float(int)] | NONE
+sum: 0.25 f(int) [int(short)] | 0.50 f(long) [long(short) CONFLICT] | 1.00 f(float) [int(short) float(int)] | NONE
+max: 0.25 f(int) [int(short)] | 0.50 f(long) [long(short) CONFLICT] | 1.00 f(float) [int(short) float(int)] | NONE
+sum: 0.50 f(int,long) [int(short),long(int)] f(long,int) [long(short) CONFLICT,] | 0.75 f(long,long) [long(short) CONFLICT,long(int)] | NONE
+max: 0.25 f(int,long) [int(short),long(int)] | 0.50 f(long,int) [long(short) CONFLICT,] f(long,long) [long(short) CONFLICT,long(int)] | NONE
+sum: 0.75 f(int,long) [int(short),long(short) CONFLICT] f(long,int) [long(short) CONFLICT,int(short)] | 1.00 f(long,long) [long(short) CONFLICT,long(short) CONFLICT] | NONE
+max: 0.50 f(int,long) [int(short),long(short) CONFLICT] f(long,int) [long(short) CONFLICT,int(short)] f(long,long) [long(short) CONFLICT,long(short) CONFLICT] | NONE
+sum: NONE
+max: NONE
+sum: 0.50 f(int) [int(byte) CONFLICT] | 0.75 f(long) [short(byte) long(short) CONFLICT] | 1.25 f(float) [int(byte) float(int) CONFLICT] | NONE
+max: 0.50 f(int) [int(byte) CONFLICT] | 0.75 f(long) [short(byte) long(short) CONFLICT] | 1.25 f(float) [int(byte) float(int) CONFLICT] | NONE
+]]
+	checkTestResult( "testResolveCallable", result, expected)
+end
+
+function testDeriveTypeTargets()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local types = defineNumericTypes( tag_conv)
+
+	local targets = {types.float, types.bool, types.double, types.long, types.int}
+	local result = ""
+	local expected = ""
+	for pass=1,2 do
+		if pass == 2 then typedb:freeze_reductions() end
+		local results,nearest = typedb:derive_type( targets, types.short, mask_conv, nil, -1)
+		for ti,res in ipairs( results) do
+			result = result .. (res and deriveResultString( res, res.weight, res.conflict) or "NONE") .. "\n"
+			expected = expected .. deriveResultString( typedb:derive_type( targets[ ti], types.short, mask_conv, nil, -1)) .. "\n"
+		end
+		result = result .. "NEAREST " .. nearest .. "\n"
+		expected = expected .. "NEAREST 5\n"
+	end
+	local results,nearest = typedb:derive_type( {types.bool}, types.short, mask_conv, nil, -1)
+	result = result .. (results[1] and "FOUND" or "NONE") .. " " .. tostring( nearest)
+	expected = expected .. "NONE nil"
+	checkTestResult( "testDeriveTypeTargets", result, expected)
+end
+
+function testDeriveTypeTargetsUnreachable()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local types = defineNumericTypes( tag_conv)
+	local unreachable = typedb:def_type( 0, "unreachable")
+	typedb:def_reduction( unreachable, types.bool, "unreachable(bool)", tag_conv, 1.0)
+	-- ... a chain of conversions from short not leading to any target, skipped by the search with the lower bounds of the targets
+	local prev = types.short
+	for ci=1,50 do
+		local chain = typedb:def_type( 0, "chain" .. ci)
+		typedb:def_reduction( chain, prev, "chain" .. ci, tag_conv, 0.125)
+		prev = chain
+	end
+	local targets = {unreachable, types.int, types.bool}
+	local nodesExpanded = typedb:stats().queries.nodes_expanded
+	local results,nearest = typedb:derive_type( targets, types.short, mask_conv, nil, -1)
+	nodesExpanded = typedb:stats().queries.nodes_expanded - nodesExpanded
+	local result = ""
+	local expected = ""
+	for ti,res in ipairs( results) do
+		result = result .. (res and deriveResultString( res, res.weight, res.conflict) or "NONE") .. "\n"
+		expected = expected .. deriveResultString( typedb:derive_type( targets[ ti], types.short, mask_conv, nil, -1)) .. "\n"
+	end
+	result = result .. "NEAREST " .. nearest .. (nodesExpanded <= 2 and "" or (" EXPANDED " .. nodesExpanded))
+	expected = expected .. "NEAREST 2"
+	checkTestResult( "testDeriveTypeTargetsUnreachable", result, expected)
+end
+
+-- Function that tests that the reductions retrieved from the compacted adjacency lists are the same as the ones from the reduction table
+function testReductionAdjacency()
+	typedb = mewa.typedb()
+	local tag1 = 1
+	local tag2 = 2
+	local types = {}
+	for ti=1,12 do types[ ti] = typedb:def_type( 0, "t" .. ti) end
+	local scopes = {{0,1000},{20,100},{10,500},{30,40},{200,300}}
+	for si,scope in ipairs( scopes) do
+		typedb:scope( scope)
+		for ti=2,12 do
+			if (ti + si) % 3 ~= 0 then
+				typedb:def_reduction( types[ ti], types[ 1], "c" .. ti .. "_" .. si, (ti + si) % 2 == 0 and tag1 or tag2, si * 0.5 + ti * 0.125)
+			end
+		end
+	end
+	local masks = {typedb.reduction_tagmask( tag1), typedb.reduction_tagmask( tag2), typedb.reduction_tagmask( tag1, tag2)}
+	local function reductionsString()
+		local rt = ""
+		for _,step in ipairs( {5,15,25,35,60,150,250,600,2000}) do
+			typedb:step( step)
+			for _,mask in ipairs( masks) do
+				rt = rt .. step .. ":"
+				for _,redu in ipairs( typedb:get_reductions( types[ 1], mask)) do
+					rt = rt .. " " .. redu.constructor .. "/" .. redu.weight
+				end
+				rt = rt .. "\n"
+			end
+		end
+		return rt
+	end
+	local expected = reductionsString()
+	typedb:freeze_reductions()
+	local result = reductionsString()
+	typedb:scope( {35,38})
+	typedb:def_reduction( types[ 3], types[ 1], "c3_6", tag1, 0.25)
+	expected = expected .. reductionsString()
+	for ti=1,300 do
+		typedb:def_reduction( typedb:def_type( 0, "u" .. ti), types[ 2], "u" .. ti, tag1, 1.0)
+	end
+	result = result .. reductionsString()
+	checkTestResult( "testReductionAdjacency", result, expected)
+end
+
+-- Function that tests the lookup of types with many overloaded definitions differing in the parameters
+function testTypeSignatureLookup()
+	typedb = mewa.typedb()
+	local args = {}
+	for ai=1,8 do args[ ai] = typedb:def_type( 0, "a" .. ai) end
+	local signatures = {}
+	for a1=1,8 do
+		table.insert( signatures, {args[ a1]})
+		for a2=1,8 do table.insert( signatures, {args[ a1], args[ a2]}) end
+	end
+	table.insert( signatures, {})
+	typedb:scope( {0,1000})
+	local types = {}
+	for si,sig in ipairs( signatures) do types[ si] = typedb:def_type( 0, "f", "c" .. si, sig) end
+	typedb:scope( {10,100})
+	local innerType = typedb:def_type( 0, "f", "inner", {args[1]})
+	local alias = typedb:def_type_as( 0, "g", types[ 5])
+	local aliasAppended = typedb:def_type( 0, "g", "appended", {args[1], args[1], args[1]})
+
+	local result = ""
+	local expected = ""
+	typedb:scope( {0,1000})
+	local found = 0
+	for si,sig in ipairs( signatures) do
+		if typedb:this_type( 0, "f", sig) == types[ si] then found = found + 1 end
+		if typedb:def_type( 0, "f", "dup", sig) == -1 then found = found + 1 end
+	end
+	result = result .. found .. " " .. typedb:this_type( 0, "f", {args[1], args[1], args[1]}) .. " " .. typedb:this_type( 0, "f", {args[1], args[1], args[1]})
+	typedb:scope( {10,100})
+	result = result .. " " .. typedb:this_type( 0, "f", {args[1]}) .. " " .. typedb:this_type( 0, "g", {args[1], args[1], args[1]})
+		.. " " .. (typedb:this_type( 0, "g", {args[1]}) or "NONE") .. " " .. typedb:this_type( 0, "g", {args[1], args[5]})
+	expected = (2 * #signatures) .. " " .. aliasAppended .. " " .. aliasAppended
+		.. " " .. innerType .. " " .. aliasAppended .. " NONE " .. types[ 6]
+	checkTestResult( "testTypeSignatureLookup", result, expected)
+end
+
+-- Function that tests resolve_type with names defined only in some of the context types visited by the search
+function testResolveTypeNameFilter()
+	typedb = mewa.typedb()
+	local tag_resolve = 1
+	local mask_resolve = typedb.reduction_tagmask( tag_resolve)
+	local chain = {}
+	for ci=1,20 do
+		chain[ ci] = typedb:def_type( 0, "c" .. ci)
+		if ci > 1 then typedb:def_reduction( chain[ ci], chain[ ci-1], "r" .. ci, tag_resolve, 1.0) end
+	end
+	local other = typedb:def_type( 0, "other")
+	typedb:def_type( other, "member")
+	local member = typedb:def_type( chain[ 15], "member")
+	local function resultString( ctx, reductions, items)
+		if not ctx then return "NONE" end
+		local rt = ctx .. " " .. #reductions
+		for _,item in ipairs( items or {}) do rt = rt .. " " .. item end
+		return rt
+	end
+	local result = resultString( typedb:resolve_type( chain[ 1], "member", mask_resolve))
+			.. ", " .. resultString( typedb:resolve_type( chain[ 16], "member", mask_resolve))
+			.. ", " .. resultString( typedb:resolve_type( chain[ 1], "undefined", mask_resolve))
+	typedb:def_type( chain[ 3], "member")
+	result = result .. ", " .. resultString( typedb:resolve_type( chain[ 1], "member", mask_resolve))
+	local expected = chain[ 15] .. " 14 " .. member .. ", NONE, NONE, " .. chain[ 3] .. " 2 " .. (member+1)
+	checkTestResult( "testResolveTypeNameFilter", result, expected)
+end
+
+function testStatistics()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local a = typedb:def_type( 0, "a")
+	local b = typedb:def_type( 0, "b")
+	local c = typedb:def_type( 0, "c")
+	local d = typedb:def_type( 0, "d")
+	typedb:def_type( a, "member")
+	typedb:def_reduction( b, a, "b(a)", tag_conv, 1.0)
+	typedb:def_reduction( c, a, "c(a)", tag_conv, 1.0)
+	typedb:def_reduction( d, b, "d(b)", tag_conv, 1.0)
+	typedb:def_reduction( d, c, "d(c)", tag_conv, 1.0)
+	typedb:set_instance( "x", 1)
+	typedb:derive_type( d, a, mask_conv, nil, -1)
+	typedb:derive_type( {b, c}, a, mask_conv, nil, -1)
+	typedb:resolve_type( a, "member", mask_conv)
+	local stats = typedb:stats()
+	local result = string.format( "types %d reductions %d identifiers %d instances %d spilled %s derive %d resolve %d conflicts %d",
+			stats.types, stats.reductions, stats.identifiers, stats.instances, tostring( stats.spilled),
+			stats.queries.derive_type, stats.queries.resolve_type, stats.queries.conflicts)
+	local expected = "types 5 reductions 4 identifiers 6 instances 1 spilled false derive 3 resolve 1 conflicts 1"
+	if stats.queries.nodes_expanded <= 0 or stats.queries.queue_pushes < stats.queries.nodes_expanded then
+		result = result .. " BAD SEARCH COUNTERS"
+	end
+	for _,tab in ipairs( {"identmap","identstr","typetab","redutab","objtab"}) do
+		local mem = stats.memory[ tab]
+		if mem.used <= 0 or mem.used > mem.size or mem.upstream ~= 0 then result = result .. " BAD MEMORY " .. tab end
+	end
+	checkTestResult( "testStatistics", result, expected)
+end
+
+function testRecord()
+	local filename = os.tmpname()
+	local recdb = mewa.typedb( filename)
+	local a = recdb:def_type( 0, "a")
+	local b = recdb:def_type( 0, "b")
+	recdb:def_reduction( b, a, "b(a)", 1, 1.0)
+	recdb:derive_type( b, a)
+	recdb = nil
+	collectgarbage()
+	local file = io.open( filename, "rb")
+	local content = file:read( "a")
+	file:close()
+	os.remove( filename)
+	local result = string.format( "magic %s names %s calls %s", content:sub( 1, 8), tostring( content:find( "a", 9, true) ~= nil), tostring( #content > 8))
+	local expected = "magic MEWATDB1 names true calls true"
+	checkTestResult( "testRecord", result, expected)
+end
+
+function testFreeze()
+	typedb = mewa.typedb()
+	local a = typedb:def_type( 0, "a")
+	local b = typedb:def_type( 0, "b")
+	typedb:def_type( b, "member")
+	typedb:def_reduction( b, a, "b(a)", 1, 1.0)
+	typedb:freeze()
+	local result = ""
+	local ok,err = pcall( typedb.def_type, typedb, 0, "c")
+	if ok then result = result .. " def_type not rejected" elseif not tostring( err):find( "465", 1, true) then result = result .. " " .. tostring( err) end
+	ok,err = pcall( typedb.def_reduction, typedb, a, b, "a(b)", 1, 1.0)
+	if ok then result = result .. " def_reduction not rejected" end
+	ok,err = pcall( typedb.set_instance, typedb, "x", 1)
+	if ok then result = result .. " set_instance not rejected" end
+	local redulist = typedb:derive_type( b, a)
+	local _,items = typedb:resolve_type( a, "member")
+	result = result .. string.format( "derive %s resolve %d", mewa.tostring( redulist, 0, false), #items)
+	local expected = "derive {{constructor = \"b(a)\",type = 2}} resolve 1"
+	checkTestResult( "testFreeze", result, expected)
+end
+
+function testTypeString()
+	typedb = mewa.typedb()
+	local ns = typedb:def_type( 0, "ns")
+	local int = typedb:def_type( ns, "int")
+	local class = typedb:def_type( ns, "class")
+	local method = typedb:def_type( class, "method", "m", {int, class})
+	local result = ""
+	for _,sep in ipairs( {" ", "::", " ", "::"}) do
+		result = result .. "[" .. typedb:type_string( method, sep) .. "]"
+	end
+	local sepbuf = "." .. "."
+	result = result .. "[" .. typedb:type_string( class, sepbuf) .. "][" .. typedb:type_string( method) .. "]"
+	local expected = "[ns class method(ns int,ns class)][ns::class::method(ns::int,ns::class)]"
+			.. "[ns class method(ns int,ns class)][ns::class::method(ns::int,ns::class)][ns..class][ns class method(ns int,ns class)]"
+	checkTestResult( "testTypeString", result, expected)
+end
+
+function testDeriveTypeCachePrunedType()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local a_type = typedb:def_type( 0, "A")
+	local t_type = typedb:def_type( 0, "T")
+	local z_type = typedb:def_type( 0, "Z")
+	typedb:def_reduction( t_type, a_type, nil, tag_conv, 1.0)
+	local function deriveString()
+		local reductions,weight = typedb:derive_type( z_type, a_type, mask_conv)
+		if not reductions then return "NONE" end
+		return string.format( "%d %.1f", #reductions, weight)
+	end
+	-- ... the search skips T as it has no path to Z, the reduction defined from T afterwards has to invalidate the cached result
+	local result = deriveString()
+	typedb:def_reduction( z_type, t_type, nil, tag_conv, 1.0)
+	result = result .. "\n" .. deriveString()
+	local expected = "NONE\n2 2.0"
+	checkTestResult( "testDeriveTypeCachePrunedType", result, expected)
+end
+
+function testDeriveTypeCachePrunedPath()
+	typedb = mewa.typedb()
+	local tag_conv = 1
+	local mask_conv = typedb.reduction_tagmask( tag_conv)
+	local s_type = typedb:def_type( 0, "S")
+	local a_type = typedb:def_type( 0, "A")
+	local b_type = typedb:def_type( 0, "B")
+	local t_type = typedb:def_type( 0, "T")
+	typedb:def_reduction( a_type, s_type, nil, tag_conv, 1.0)
+	typedb:def_reduction( b_type, a_type, nil, tag_conv, 1.0)
+	local function deriveString()
+		local reductions,weight = typedb:derive_type( t_type, s_type, mask_conv)
+		local targetResults = typedb:derive_type( {t_type}, s_type, mask_conv)
+		local rt = reductions and string.format( "%d %.1f", #reductions, weight) or "NONE"
+		return rt .. (targetResults[1] and string.format( " %d", #targetResults[1]) or " NONE")
+	end
+	-- ... the search skips A as it has no path to T and does not visit B, the reduction defined from B afterwards has to invalidate the cached results
+	local result = deriveString()
+	typedb:def_reduction( t_type, b_type, nil, tag_conv, 1.0)
+	result = result .. "\n" .. deriveString()
+	local expected = "NONE NONE\n3 3.0 3"
+	checkTestResult( "testDeriveTypeCachePrunedPath", result, expected)
+end
+
 testRegisterAllocator()
 testDefineResolveType()
 testResolveTypeContext()
 testDefineTypeAs()
 testLlvmFloatAndDoubleToHex()
 testResolveType_typeConstructorPairs()
+testTraverse()
+testDeriveTypeCache()
+testResolveTypeCache()
+testFreezeReductions()
+testDeriveTypeReference()
+testSearchLongPath()
+testDeriveTypes()
+testResolveCallable()
+testDeriveTypeTargets()
+testDeriveTypeTargetsUnreachable()
+testReductionAdjacency()
+testTypeSignatureLookup()
+testResolveTypeNameFilter()
+testStatistics()
+testRecord()
+testFreeze()
+testTypeString()
+testDeriveTypeCachePrunedType()
+testDeriveTypeCachePrunedPath()
 
 if errorCount > 0 then
 	error( "result of " .. errorCount .. " tests not as expected!")